@@ -33,21 +33,25 @@ constexpr vect2_t PFD_SZ = {1337, 1337};
 constexpr int CAPT_BRT_IDX = 0;
 constexpr int FO_BRT_IDX = 4;
 const char *PLUGIN_SIGN = "stratosphere.systems.fmsplugin";
+// Databus traffic is recorded if a file with this name is in the plugin data folder
+const char *TRAFFIC_LOG_TRIGGER = "record_traffic";
+const char *TRAFFIC_LOG_NAME = "databus_traffic.bin";
+const char *DATABUS_STATS_NAME = "databus_stats.txt";
+const char *MAG_MODEL_NAME = "WMM.COF";
+constexpr double DATABUS_STATS_DUMP_INTERVAL_SEC = 60;
 
 
-fmc_dr::dr_init d_init = { &int_datarefs, &double_datarefs, 
-						   &int_arr_datarefs, &float_arr_datarefs, 
-						   &str_datarefs };
+custom_dr_registry_t custom_drs;
 
-StratosphereAvionics::PFDdrs pfd_drs = {"Strato/777/mcp/ap_on", 
-	"Strato/777/pfd/flt_dir_pilot", "Strato/777/pfd/flt_dir_copilot", 
-	"Strato/777/fma/at_mode", "Strato/777/fma/active_roll_mode", 
-	"Strato/777/fma/active_vert_mode", "sim/cockpit2/switches/instrument_brightness_ratio",
+StratosphereAvionics::PFDdrs pfd_drs = {custom_dr::MCP_AP_ON.name, 
+	custom_dr::PFD_FLT_DIR_PILOT.name, custom_dr::PFD_FLT_DIR_COPILOT.name, 
+	custom_dr::FMA_AT_MODE.name, custom_dr::FMA_ACTIVE_ROLL_MODE.name, 
+	custom_dr::FMA_ACTIVE_VERT_MODE.name, "sim/cockpit2/switches/instrument_brightness_ratio",
 	CAPT_BRT_IDX, FO_BRT_IDX};
 
-cairo_utils::test_drs tmp_drs = {"Strato/777/GUI/test_x", "Strato/777/GUI/test_y",
-	"Strato/777/GUI/test_w", "Strato/777/GUI/test_h", "Strato/777/GUI/test_r", 
-	"Strato/777/GUI/test_thick"};
+cairo_utils::test_drs tmp_drs = {custom_dr::GUI_TEST_X.name, custom_dr::GUI_TEST_Y.name,
+	custom_dr::GUI_TEST_W.name, custom_dr::GUI_TEST_H.name, custom_dr::GUI_TEST_R.name, 
+	custom_dr::GUI_TEST_THCK.name};
 
 std::vector<XPDataBus::cmd_entry> cmd_entries;
 std::vector<XPDataBus::custom_data_ref_entry> data_refs;
@@ -82,9 +86,37 @@ float FMS_init_FLCB(float elapsedMe, float elapsedSim, int counter, void* refcon
 
 	float dead_zone = StratosphereAvionics::InputFiltering::DEAD_ZONE_DEFAULT;
 	input_filter = std::make_shared<StratosphereAvionics::InputFiltering::InputFilter>(
-			dead_zone, dead_zone, dead_zone);
-	sim_databus = std::make_shared<XPDataBus::DataBus>(&cmd_entries, &data_refs, N_MAX_DATABUS_QUEUE_PROC, 
+			dead_zone, dead_zone, dead_zone, &custom_drs.get<&custom_dr::MCP_AP_ON>(), 
+			&custom_drs.get<&custom_dr::FMA_ACTIVE_ROLL_MODE>(), 
+			&custom_drs.get<&custom_dr::FMA_ACTIVE_VERT_MODE>(), 
+			&custom_drs.get<&custom_dr::AUTOPILOT_YOKE_CMD>());
+	sim_databus = std::make_shared<XPDataBus::DataBus>(&cmd_entries, &data_refs, DATABUS_FRAME_BUDGET_US, 
 		PLUGIN_SIGN);
+
+	// Every dataref the systems register from here on goes into one report
+	sim_databus->begin_dr_report();
+	// Custom datarefs are resolved here, so the systems below get their existing handles
+	custom_drs.bind(sim_databus.get());
+	if(libnav::does_file_exist(sim_databus->plugin_data_path_sep+TRAFFIC_LOG_TRIGGER))
+	{
+		sim_databus->start_recording(sim_databus->plugin_data_path_sep+TRAFFIC_LOG_NAME);
+	}
+	else if(libnav::does_file_exist(sim_databus->plugin_data_path_sep+MAG_MODEL_NAME))
+	{
+		// Not loaded while recording, so that the log has X-plane's values to check the model against
+		sim_databus->load_mag_model(sim_databus->plugin_data_path_sep+MAG_MODEL_NAME);
+	}
+	XPDataBus::databus_stats_hdls databus_stats = {
+		custom_drs.get_hdl<&custom_dr::DATABUS_DRAIN_US>(), 
+		custom_drs.get_hdl<&custom_dr::DATABUS_MAX_DRAIN_US>(), 
+		custom_drs.get_hdl<&custom_dr::DATABUS_N_SERVED>(), 
+		custom_drs.get_hdl<&custom_dr::DATABUS_QUEUE_DEPTH>(), 
+		custom_drs.get_hdl<&custom_dr::DATABUS_GET_LATENCY_HIST>(), 
+		custom_drs.get_hdl<&custom_dr::DATABUS_SET_LATENCY_HIST>(), 
+		custom_drs.get_hdl<&custom_dr::DATABUS_DRAIN_HIST>()};
+	sim_databus->publish_stats(&databus_stats, sim_databus->plugin_data_path_sep+DATABUS_STATS_NAME, 
+		DATABUS_STATS_DUMP_INTERVAL_SEC);
+
 	avionics = std::make_shared<StratosphereAvionics::AvionicsSys>(sim_databus, av_in, 
 		av_out, POI_CACHE_TILE_SIZE_RAD, N_FMC_REFRESH_HZ);
 
@@ -95,14 +127,17 @@ float FMS_init_FLCB(float elapsedMe, float elapsedSim, int counter, void* refcon
 
 	avionics_thread = std::make_shared<std::thread>([]()
 		{
+			sim_databus->reg_producer("Avionics");
 			avionics->main_loop();
 		});
 	fmc_l_thread = std::make_shared<std::thread>([]()
 		{
+			sim_databus->reg_producer("FMC L");
 			fmc_l->main_loop();
 		});
 	fmc_r_thread = std::make_shared<std::thread>([]()
 		{
+			sim_databus->reg_producer("FMC R");
 			fmc_r->main_loop();
 		});
 
@@ -130,6 +165,7 @@ float FMS_init_FLCB(float elapsedMe, float elapsedSim, int counter, void* refcon
 		pfd_data = std::make_shared<StratosphereAvionics::PFDData>(sim_databus, pfd_drs, &tmp_drs);
 		pfd_thread = std::make_shared<std::thread>([]()
 		{
+			sim_databus->reg_producer("PFD");
 			pfd_data->update();
 		});
 
@@ -154,6 +190,7 @@ float FMS_init_FLCB(float elapsedMe, float elapsedSim, int counter, void* refcon
 			XPLMDebugString("777_FMS: Font file not found\n");
 		}
 	}
+	sim_databus->end_dr_report();
 
 	return 0;
 }
@@ -167,7 +204,7 @@ PLUGIN_API int XPluginStart(char* outName, char* outSig, char* outDesc)
 	XPLMEnableFeature("XPLM_USE_NATIVE_PATHS", 1);
 
 	data_refs_created = fmc_dr::register_data_refs(&cmd_entries, &data_refs, 
-		&custom_cmds, d_init);
+		&custom_cmds, &custom_drs);
 
 	if (data_refs_created)
 	{
@@ -224,7 +261,7 @@ PLUGIN_API void	XPluginStop(void)
 			displays_created = false;
 		}
 
-		fmc_dr::unregister_data_refs(d_init);
+		fmc_dr::unregister_data_refs(&custom_drs);
 		data_refs.clear();
 
 		fmc_l->disable();
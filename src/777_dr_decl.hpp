@@ -9,13 +9,12 @@
 */
 
 
-#include "dataref_structs.hpp"
+#include "dr_registry.hpp"
 #include <vector>
 
 
 enum FMS_constants
 {
-	N_MAX_DATABUS_QUEUE_PROC = 64,
 	N_CUSTOM_STR_DR_LENGTH = 2048,
 	REF_NAV_ICAO_BUF_LENGTH = 5,
 	FMC_SCREEN_LINE_LENGTH = 24,
@@ -27,6 +26,7 @@ enum FMS_constants
 	DEBUG_DR_LENGTH = 32
 };
 
+constexpr double DATABUS_FRAME_BUDGET_US = 500;
 constexpr int DEFAULT_WPT_IDX = -1;
 constexpr int DEFAULT_WPT_SUBPAGE = 1;
 
@@ -40,168 +40,351 @@ std::vector<DRUtil::cmd_t> custom_cmds = {
 		"Called if FMC command from left CDU has been processed", nullptr},
 };
 
-std::vector<DRUtil::dref_i> int_datarefs = {
+/*
+	Every custom dataref is declared here once. Other code refers to it
+	through its declaration, e.g. custom_dr::MCP_AP_ON.name, never by a string.
+	DRRegistry creates the datarefs and their accessors from CUSTOM_DRS.
+*/
+
+namespace custom_dr
+{
+	// Integers:
 	// Autopilot control data refs:
 	// A/P/FLT DIR annunciation:
-	{{"Strato/777/mcp/ap_on", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/pfd/flt_dir_pilot", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/pfd/flt_dir_copilot", DR_WRITABLE, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl MCP_AP_ON = {"Strato/777/mcp/ap_on", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl PFD_FLT_DIR_PILOT = {"Strato/777/pfd/flt_dir_pilot", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl PFD_FLT_DIR_COPILOT = {"Strato/777/pfd/flt_dir_copilot", xplmType_Int, DR_WRITABLE, 1, 0};
 	// FMA modes:
-	{{"Strato/777/fma/active_vert_mode", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/fma/active_roll_mode", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/fma/alt_acq", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/fma/at_mode", DR_WRITABLE, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMA_ACTIVE_VERT_MODE = {"Strato/777/fma/active_vert_mode", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMA_ACTIVE_ROLL_MODE = {"Strato/777/fma/active_roll_mode", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMA_ALT_ACQ = {"Strato/777/fma/alt_acq", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMA_AT_MODE = {"Strato/777/fma/at_mode", xplmType_Int, DR_WRITABLE, 1, 0};
 
-	{{"Strato/777/UI/messages/creating_databases", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/REF_NAV/rad_nav_inh", DR_WRITABLE, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl UI_MESSAGES_CREATING_DATABASES = {"Strato/777/UI/messages/creating_databases", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_REF_NAV_RAD_NAV_INH = {"Strato/777/FMC/REF_NAV/rad_nav_inh", xplmType_Int, DR_WRITABLE, 1, 0};
 
 	// FMC L data refs:
 
-	{{"Strato/777/FMC/FMC_L/clear_msg", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/page", DR_WRITABLE, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_L_CLEAR_MSG = {"Strato/777/FMC/FMC_L/clear_msg", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_PAGE = {"Strato/777/FMC/FMC_L/page", xplmType_Int, DR_WRITABLE, 1, 0};
 
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_elev", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_length_ft", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_length_m", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_ELEV = {"Strato/777/FMC/FMC_L/REF_NAV/poi_elev", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_LENGTH_FT = {"Strato/777/FMC/FMC_L/REF_NAV/poi_length_ft", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_LENGTH_M = {"Strato/777/FMC/FMC_L/REF_NAV/poi_length_m", xplmType_Int, DR_READONLY, 1, 0};
 
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/wpt_idx", DR_WRITABLE, false, nullptr}, DEFAULT_WPT_IDX},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_type", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/subpage", DR_WRITABLE, false, nullptr}, DEFAULT_WPT_SUBPAGE},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/n_subpages", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/is_active", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/n_pois_disp", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_WPT_IDX = {"Strato/777/FMC/FMC_L/SEL_WPT/wpt_idx", xplmType_Int, DR_WRITABLE, 1, DEFAULT_WPT_IDX};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_TYPE = {"Strato/777/FMC/FMC_L/REF_NAV/poi_type", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_SUBPAGE = {"Strato/777/FMC/FMC_L/SEL_WPT/subpage", xplmType_Int, DR_WRITABLE, 1, DEFAULT_WPT_SUBPAGE};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_N_SUBPAGES = {"Strato/777/FMC/FMC_L/SEL_WPT/n_subpages", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_IS_ACTIVE = {"Strato/777/FMC/FMC_L/SEL_WPT/is_active", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_N_POIS_DISP = {"Strato/777/FMC/FMC_L/SEL_WPT/n_pois_disp", xplmType_Int, DR_READONLY, 1, 0};
 
-	{{"Strato/777/FMC/FMC_L/scratchpad/not_in_database", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_L_SCRATCHPAD_NOT_IN_DATABASE = {"Strato/777/FMC/FMC_L/scratchpad/not_in_database", xplmType_Int, DR_READONLY, 1, 0};
 
 	// FMC R data refs:
 
-	{{"Strato/777/FMC/FMC_R/clear_msg", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/page", DR_WRITABLE, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_R_CLEAR_MSG = {"Strato/777/FMC/FMC_R/clear_msg", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_PAGE = {"Strato/777/FMC/FMC_R/page", xplmType_Int, DR_WRITABLE, 1, 0};
 
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_elev", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_length_ft", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_length_m", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_ELEV = {"Strato/777/FMC/FMC_R/REF_NAV/poi_elev", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_LENGTH_FT = {"Strato/777/FMC/FMC_R/REF_NAV/poi_length_ft", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_LENGTH_M = {"Strato/777/FMC/FMC_R/REF_NAV/poi_length_m", xplmType_Int, DR_READONLY, 1, 0};
 
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/wpt_idx", DR_WRITABLE, false, nullptr}, DEFAULT_WPT_IDX},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_type", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/subpage", DR_WRITABLE, false, nullptr}, DEFAULT_WPT_SUBPAGE},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/n_subpages", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/is_active", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/n_pois_disp", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_WPT_IDX = {"Strato/777/FMC/FMC_R/SEL_WPT/wpt_idx", xplmType_Int, DR_WRITABLE, 1, DEFAULT_WPT_IDX};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_TYPE = {"Strato/777/FMC/FMC_R/REF_NAV/poi_type", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_SUBPAGE = {"Strato/777/FMC/FMC_R/SEL_WPT/subpage", xplmType_Int, DR_WRITABLE, 1, DEFAULT_WPT_SUBPAGE};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_N_SUBPAGES = {"Strato/777/FMC/FMC_R/SEL_WPT/n_subpages", xplmType_Int, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_IS_ACTIVE = {"Strato/777/FMC/FMC_R/SEL_WPT/is_active", xplmType_Int, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_N_POIS_DISP = {"Strato/777/FMC/FMC_R/SEL_WPT/n_pois_disp", xplmType_Int, DR_READONLY, 1, 0};
 
-	{{"Strato/777/FMC/FMC_R/scratchpad/not_in_database", DR_READONLY, false, nullptr}, 0}
-};
+	inline constexpr DRUtil::dr_decl FMC_R_SCRATCHPAD_NOT_IN_DATABASE = {"Strato/777/FMC/FMC_R/scratchpad/not_in_database", xplmType_Int, DR_READONLY, 1, 0};
 
-std::vector<DRUtil::dref_d> double_datarefs = {
+	// Doubles:
 	// GUI test data refs
-	{{"Strato/777/GUI/test_x", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/GUI/test_y", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/GUI/test_w", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/GUI/test_h", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/GUI/test_r", DR_WRITABLE, false, nullptr}, 0},
-	{{"Strato/777/GUI/test_thck", DR_WRITABLE, false, nullptr}, 0},
-
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/pos_lat", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/pos_lon", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/pos_fom", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/pos_lat", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/pos_lon", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/pos_fom", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl GUI_TEST_X = {"Strato/777/GUI/test_x", xplmType_Double, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl GUI_TEST_Y = {"Strato/777/GUI/test_y", xplmType_Double, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl GUI_TEST_W = {"Strato/777/GUI/test_w", xplmType_Double, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl GUI_TEST_H = {"Strato/777/GUI/test_h", xplmType_Double, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl GUI_TEST_R = {"Strato/777/GUI/test_r", xplmType_Double, DR_WRITABLE, 1, 0};
+	inline constexpr DRUtil::dr_decl GUI_TEST_THCK = {"Strato/777/GUI/test_thck", xplmType_Double, DR_WRITABLE, 1, 0};
+
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_POS_LAT = {"Strato/777/FMC/RAD_NAV/VOR_DME/pos_lat", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_POS_LON = {"Strato/777/FMC/RAD_NAV/VOR_DME/pos_lon", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_POS_FOM = {"Strato/777/FMC/RAD_NAV/VOR_DME/pos_fom", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_POS_LAT = {"Strato/777/FMC/RAD_NAV/DME_DME/pos_lat", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_POS_LON = {"Strato/777/FMC/RAD_NAV/DME_DME/pos_lon", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_POS_FOM = {"Strato/777/FMC/RAD_NAV/DME_DME/pos_fom", xplmType_Double, DR_READONLY, 1, 0};
 
 	// FMC L data refs:
 
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_lat", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_lon", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_freq", DR_READONLY, false, nullptr}, 0},
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_LAT = {"Strato/777/FMC/FMC_L/REF_NAV/poi_lat", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_LON = {"Strato/777/FMC/FMC_L/REF_NAV/poi_lon", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_FREQ = {"Strato/777/FMC/FMC_L/REF_NAV/poi_freq", xplmType_Double, DR_READONLY, 1, 0};
 
 	// FMC R data refs:
 
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_lat", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_lon", DR_READONLY, false, nullptr}, 0},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_freq", DR_READONLY, false, nullptr}, 0}
-};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_LAT = {"Strato/777/FMC/FMC_R/REF_NAV/poi_lat", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_LON = {"Strato/777/FMC/FMC_R/REF_NAV/poi_lon", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_FREQ = {"Strato/777/FMC/FMC_R/REF_NAV/poi_freq", xplmType_Double, DR_READONLY, 1, 0};
 
-std::vector<DRUtil::dref_ia> int_arr_datarefs = {
+	// Databus statistics:
 
-};
+	inline constexpr DRUtil::dr_decl DATABUS_DRAIN_US = {"Strato/777/databus/drain_us", xplmType_Double, DR_READONLY, 1, 0};
+	inline constexpr DRUtil::dr_decl DATABUS_MAX_DRAIN_US = {"Strato/777/databus/max_drain_us", xplmType_Double, DR_READONLY, 1, 0};
 
-std::vector<DRUtil::dref_fa> float_arr_datarefs = {
-	{{"Strato/777/autopilot/yoke_cmd", DR_WRITABLE, false, nullptr}, 
-		nullptr, 2},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi_list", DR_READONLY, false, nullptr}, 
-		nullptr, 3 * StratosphereAvionics::N_CDU_OUT_LINES},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi_list", DR_READONLY, false, nullptr}, 
-		nullptr, 3 * StratosphereAvionics::N_CDU_OUT_LINES}
-};
+	// Integer arrays:
+	// Databus statistics:
+
+	inline constexpr DRUtil::dr_decl DATABUS_N_SERVED = {"Strato/777/databus/n_served", xplmType_IntArray, DR_READONLY, XPDataBus::N_DRAIN_QUEUES, 0};
+	inline constexpr DRUtil::dr_decl DATABUS_QUEUE_DEPTH = {"Strato/777/databus/queue_depth", xplmType_IntArray, DR_READONLY, XPDataBus::N_DRAIN_QUEUES, 0};
+	inline constexpr DRUtil::dr_decl DATABUS_GET_LATENCY_HIST = {"Strato/777/databus/get_latency_hist", xplmType_IntArray, DR_READONLY, XPDataBus::N_LATENCY_BUCKETS, 0};
+	inline constexpr DRUtil::dr_decl DATABUS_SET_LATENCY_HIST = {"Strato/777/databus/set_latency_hist", xplmType_IntArray, DR_READONLY, XPDataBus::N_LATENCY_BUCKETS, 0};
+	inline constexpr DRUtil::dr_decl DATABUS_DRAIN_HIST = {"Strato/777/databus/drain_hist", xplmType_IntArray, DR_READONLY, XPDataBus::N_LATENCY_BUCKETS, 0};
 
-std::vector<DRUtil::dref_s> str_datarefs = {
-	{{"Strato/777/FMC/REF_NAV/navaid_1_out", DR_READONLY, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/REF_NAV/navaid_2_out", DR_READONLY, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/REF_NAV/vor_1_out", DR_READONLY, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/REF_NAV/vor_2_out", DR_READONLY, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
+	// Float arrays:
+	inline constexpr DRUtil::dr_decl AUTOPILOT_YOKE_CMD = {"Strato/777/autopilot/yoke_cmd", xplmType_FloatArray, DR_WRITABLE, 2, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI_LIST = {"Strato/777/FMC/FMC_L/SEL_WPT/poi_list", xplmType_FloatArray, DR_READONLY, 3 * StratosphereAvionics::N_CDU_OUT_LINES, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI_LIST = {"Strato/777/FMC/FMC_R/SEL_WPT/poi_list", xplmType_FloatArray, DR_READONLY, 3 * StratosphereAvionics::N_CDU_OUT_LINES, 0};
 
-	{{"Strato/777/FMC/RTE1/dep_icao_out", DR_READONLY, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/RTE1/arr_icao_out", DR_READONLY, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/RTE1/dep_rnw_out", DR_READONLY, false, nullptr}, nullptr, N_RTE_RWY_BUF_LENGTH},
+	// Strings:
+	inline constexpr DRUtil::dr_decl FMC_REF_NAV_NAVAID_1_OUT = {"Strato/777/FMC/REF_NAV/navaid_1_out", xplmType_Data, DR_READONLY, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_REF_NAV_NAVAID_2_OUT = {"Strato/777/FMC/REF_NAV/navaid_2_out", xplmType_Data, DR_READONLY, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_REF_NAV_VOR_1_OUT = {"Strato/777/FMC/REF_NAV/vor_1_out", xplmType_Data, DR_READONLY, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_REF_NAV_VOR_2_OUT = {"Strato/777/FMC/REF_NAV/vor_2_out", xplmType_Data, DR_READONLY, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+
+	inline constexpr DRUtil::dr_decl FMC_RTE1_DEP_ICAO_OUT = {"Strato/777/FMC/RTE1/dep_icao_out", xplmType_Data, DR_READONLY, N_RTE_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RTE1_ARR_ICAO_OUT = {"Strato/777/FMC/RTE1/arr_icao_out", xplmType_Data, DR_READONLY, N_RTE_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RTE1_DEP_RNW_OUT = {"Strato/777/FMC/RTE1/dep_rnw_out", xplmType_Data, DR_READONLY, N_RTE_RWY_BUF_LENGTH, 0};
 
 	// Some debug datarefs up in here
 
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/c1", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/c2", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/c3", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/VOR_DME/c4", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_C1 = {"Strato/777/FMC/RAD_NAV/VOR_DME/c1", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_C2 = {"Strato/777/FMC/RAD_NAV/VOR_DME/c2", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_C3 = {"Strato/777/FMC/RAD_NAV/VOR_DME/c3", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_VOR_DME_C4 = {"Strato/777/FMC/RAD_NAV/VOR_DME/c4", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
 
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/c1", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/c2", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/c3", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/c4", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
-	{{"Strato/777/FMC/RAD_NAV/DME_DME/tuned_pair", DR_READONLY, false, nullptr}, nullptr, DEBUG_DR_LENGTH},
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_C1 = {"Strato/777/FMC/RAD_NAV/DME_DME/c1", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_C2 = {"Strato/777/FMC/RAD_NAV/DME_DME/c2", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_C3 = {"Strato/777/FMC/RAD_NAV/DME_DME/c3", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_C4 = {"Strato/777/FMC/RAD_NAV/DME_DME/c4", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_RAD_NAV_DME_DME_TUNED_PAIR = {"Strato/777/FMC/RAD_NAV/DME_DME/tuned_pair", xplmType_Data, DR_READONLY, DEBUG_DR_LENGTH, 0};
 
 	// FMC L data refs:
 
-	{{"Strato/777/FMC/FMC_L/REF_NAV/input_icao", DR_WRITABLE, false, nullptr}, nullptr, REF_NAV_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/out_icao", DR_READONLY, false, nullptr}, nullptr, REF_NAV_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/poi_mag_var", DR_READONLY, false, nullptr}, nullptr, N_REF_NAV_MAG_VAR_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/navaid_1_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/navaid_2_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/vor_1_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/REF_NAV/vor_2_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-
-	{{"Strato/777/FMC/FMC_L/RTE1/dep_icao_in", DR_WRITABLE, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/RTE1/arr_icao_in", DR_WRITABLE, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_L/RTE1/dep_rnw_in", DR_WRITABLE, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi1_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi2_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi3_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi4_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi5_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_L/SEL_WPT/poi6_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_L/scratchpad_msg", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_INPUT_ICAO = {"Strato/777/FMC/FMC_L/REF_NAV/input_icao", xplmType_Data, DR_WRITABLE, REF_NAV_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_OUT_ICAO = {"Strato/777/FMC/FMC_L/REF_NAV/out_icao", xplmType_Data, DR_READONLY, REF_NAV_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_POI_MAG_VAR = {"Strato/777/FMC/FMC_L/REF_NAV/poi_mag_var", xplmType_Data, DR_READONLY, N_REF_NAV_MAG_VAR_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_NAVAID_1_IN = {"Strato/777/FMC/FMC_L/REF_NAV/navaid_1_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_NAVAID_2_IN = {"Strato/777/FMC/FMC_L/REF_NAV/navaid_2_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_VOR_1_IN = {"Strato/777/FMC/FMC_L/REF_NAV/vor_1_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_REF_NAV_VOR_2_IN = {"Strato/777/FMC/FMC_L/REF_NAV/vor_2_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+
+	inline constexpr DRUtil::dr_decl FMC_L_RTE1_DEP_ICAO_IN = {"Strato/777/FMC/FMC_L/RTE1/dep_icao_in", xplmType_Data, DR_WRITABLE, N_RTE_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_RTE1_ARR_ICAO_IN = {"Strato/777/FMC/FMC_L/RTE1/arr_icao_in", xplmType_Data, DR_WRITABLE, N_RTE_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_RTE1_DEP_RNW_IN = {"Strato/777/FMC/FMC_L/RTE1/dep_rnw_in", xplmType_Data, DR_WRITABLE, N_RTE_ICAO_BUF_LENGTH, 0};
+
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI1_TYPE = {"Strato/777/FMC/FMC_L/SEL_WPT/poi1_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI2_TYPE = {"Strato/777/FMC/FMC_L/SEL_WPT/poi2_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI3_TYPE = {"Strato/777/FMC/FMC_L/SEL_WPT/poi3_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI4_TYPE = {"Strato/777/FMC/FMC_L/SEL_WPT/poi4_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI5_TYPE = {"Strato/777/FMC/FMC_L/SEL_WPT/poi5_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SEL_WPT_POI6_TYPE = {"Strato/777/FMC/FMC_L/SEL_WPT/poi6_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_L_SCRATCHPAD_MSG = {"Strato/777/FMC/FMC_L/scratchpad_msg", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
 
 	// FMC R data refs:
 
-	{{"Strato/777/FMC/FMC_R/REF_NAV/input_icao", DR_WRITABLE, false, nullptr}, nullptr, REF_NAV_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/out_icao", DR_READONLY, false, nullptr}, nullptr, REF_NAV_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/poi_mag_var", DR_READONLY, false, nullptr}, nullptr, N_REF_NAV_MAG_VAR_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/navaid_1_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/navaid_2_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/vor_1_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/REF_NAV/vor_2_in", DR_WRITABLE, false, nullptr}, nullptr, N_REF_NAV_NAVAID_BUF_LENGTH},
-
-	{{"Strato/777/FMC/FMC_R/RTE1/dep_icao_in", DR_WRITABLE, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/RTE1/arr_icao_in", DR_WRITABLE, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-	{{"Strato/777/FMC/FMC_R/RTE1/dep_rnw_in", DR_WRITABLE, false, nullptr}, nullptr, N_RTE_ICAO_BUF_LENGTH},
-
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi1_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi2_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi3_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi4_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi5_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_R/SEL_WPT/poi6_type", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH},
-	{{"Strato/777/FMC/FMC_R/scratchpad_msg", DR_READONLY, false, nullptr}, nullptr, FMC_SCREEN_LINE_LENGTH}
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_INPUT_ICAO = {"Strato/777/FMC/FMC_R/REF_NAV/input_icao", xplmType_Data, DR_WRITABLE, REF_NAV_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_OUT_ICAO = {"Strato/777/FMC/FMC_R/REF_NAV/out_icao", xplmType_Data, DR_READONLY, REF_NAV_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_POI_MAG_VAR = {"Strato/777/FMC/FMC_R/REF_NAV/poi_mag_var", xplmType_Data, DR_READONLY, N_REF_NAV_MAG_VAR_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_NAVAID_1_IN = {"Strato/777/FMC/FMC_R/REF_NAV/navaid_1_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_NAVAID_2_IN = {"Strato/777/FMC/FMC_R/REF_NAV/navaid_2_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_VOR_1_IN = {"Strato/777/FMC/FMC_R/REF_NAV/vor_1_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_REF_NAV_VOR_2_IN = {"Strato/777/FMC/FMC_R/REF_NAV/vor_2_in", xplmType_Data, DR_WRITABLE, N_REF_NAV_NAVAID_BUF_LENGTH, 0};
+
+	inline constexpr DRUtil::dr_decl FMC_R_RTE1_DEP_ICAO_IN = {"Strato/777/FMC/FMC_R/RTE1/dep_icao_in", xplmType_Data, DR_WRITABLE, N_RTE_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_RTE1_ARR_ICAO_IN = {"Strato/777/FMC/FMC_R/RTE1/arr_icao_in", xplmType_Data, DR_WRITABLE, N_RTE_ICAO_BUF_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_RTE1_DEP_RNW_IN = {"Strato/777/FMC/FMC_R/RTE1/dep_rnw_in", xplmType_Data, DR_WRITABLE, N_RTE_ICAO_BUF_LENGTH, 0};
+
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI1_TYPE = {"Strato/777/FMC/FMC_R/SEL_WPT/poi1_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI2_TYPE = {"Strato/777/FMC/FMC_R/SEL_WPT/poi2_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI3_TYPE = {"Strato/777/FMC/FMC_R/SEL_WPT/poi3_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI4_TYPE = {"Strato/777/FMC/FMC_R/SEL_WPT/poi4_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI5_TYPE = {"Strato/777/FMC/FMC_R/SEL_WPT/poi5_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SEL_WPT_POI6_TYPE = {"Strato/777/FMC/FMC_R/SEL_WPT/poi6_type", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+	inline constexpr DRUtil::dr_decl FMC_R_SCRATCHPAD_MSG = {"Strato/777/FMC/FMC_R/scratchpad_msg", xplmType_Data, DR_READONLY, FMC_SCREEN_LINE_LENGTH, 0};
+}
+
+inline constexpr DRUtil::dr_decl CUSTOM_DRS[] = {
+	// Integers:
+	// Autopilot control data refs:
+	// A/P/FLT DIR annunciation:
+	custom_dr::MCP_AP_ON,
+	custom_dr::PFD_FLT_DIR_PILOT,
+	custom_dr::PFD_FLT_DIR_COPILOT,
+	// FMA modes:
+	custom_dr::FMA_ACTIVE_VERT_MODE,
+	custom_dr::FMA_ACTIVE_ROLL_MODE,
+	custom_dr::FMA_ALT_ACQ,
+	custom_dr::FMA_AT_MODE,
+
+	custom_dr::UI_MESSAGES_CREATING_DATABASES,
+	custom_dr::FMC_REF_NAV_RAD_NAV_INH,
+
+	// FMC L data refs:
+
+	custom_dr::FMC_L_CLEAR_MSG,
+	custom_dr::FMC_L_PAGE,
+
+	custom_dr::FMC_L_REF_NAV_POI_ELEV,
+	custom_dr::FMC_L_REF_NAV_POI_LENGTH_FT,
+	custom_dr::FMC_L_REF_NAV_POI_LENGTH_M,
+
+	custom_dr::FMC_L_SEL_WPT_WPT_IDX,
+	custom_dr::FMC_L_REF_NAV_POI_TYPE,
+	custom_dr::FMC_L_SEL_WPT_SUBPAGE,
+	custom_dr::FMC_L_SEL_WPT_N_SUBPAGES,
+	custom_dr::FMC_L_SEL_WPT_IS_ACTIVE,
+	custom_dr::FMC_L_SEL_WPT_N_POIS_DISP,
+
+	custom_dr::FMC_L_SCRATCHPAD_NOT_IN_DATABASE,
+
+	// FMC R data refs:
+
+	custom_dr::FMC_R_CLEAR_MSG,
+	custom_dr::FMC_R_PAGE,
+
+	custom_dr::FMC_R_REF_NAV_POI_ELEV,
+	custom_dr::FMC_R_REF_NAV_POI_LENGTH_FT,
+	custom_dr::FMC_R_REF_NAV_POI_LENGTH_M,
+
+	custom_dr::FMC_R_SEL_WPT_WPT_IDX,
+	custom_dr::FMC_R_REF_NAV_POI_TYPE,
+	custom_dr::FMC_R_SEL_WPT_SUBPAGE,
+	custom_dr::FMC_R_SEL_WPT_N_SUBPAGES,
+	custom_dr::FMC_R_SEL_WPT_IS_ACTIVE,
+	custom_dr::FMC_R_SEL_WPT_N_POIS_DISP,
+
+	custom_dr::FMC_R_SCRATCHPAD_NOT_IN_DATABASE,
+
+	// Doubles:
+	// GUI test data refs
+	custom_dr::GUI_TEST_X,
+	custom_dr::GUI_TEST_Y,
+	custom_dr::GUI_TEST_W,
+	custom_dr::GUI_TEST_H,
+	custom_dr::GUI_TEST_R,
+	custom_dr::GUI_TEST_THCK,
+
+	custom_dr::FMC_RAD_NAV_VOR_DME_POS_LAT,
+	custom_dr::FMC_RAD_NAV_VOR_DME_POS_LON,
+	custom_dr::FMC_RAD_NAV_VOR_DME_POS_FOM,
+	custom_dr::FMC_RAD_NAV_DME_DME_POS_LAT,
+	custom_dr::FMC_RAD_NAV_DME_DME_POS_LON,
+	custom_dr::FMC_RAD_NAV_DME_DME_POS_FOM,
+
+	// FMC L data refs:
+
+	custom_dr::FMC_L_REF_NAV_POI_LAT,
+	custom_dr::FMC_L_REF_NAV_POI_LON,
+	custom_dr::FMC_L_REF_NAV_POI_FREQ,
+
+	// FMC R data refs:
+
+	custom_dr::FMC_R_REF_NAV_POI_LAT,
+	custom_dr::FMC_R_REF_NAV_POI_LON,
+	custom_dr::FMC_R_REF_NAV_POI_FREQ,
+
+	// Databus statistics:
+
+	custom_dr::DATABUS_DRAIN_US,
+	custom_dr::DATABUS_MAX_DRAIN_US,
+
+	// Integer arrays:
+	// Databus statistics:
+
+	custom_dr::DATABUS_N_SERVED,
+	custom_dr::DATABUS_QUEUE_DEPTH,
+	custom_dr::DATABUS_GET_LATENCY_HIST,
+	custom_dr::DATABUS_SET_LATENCY_HIST,
+	custom_dr::DATABUS_DRAIN_HIST,
+
+	// Float arrays:
+	custom_dr::AUTOPILOT_YOKE_CMD,
+	custom_dr::FMC_L_SEL_WPT_POI_LIST,
+	custom_dr::FMC_R_SEL_WPT_POI_LIST,
+
+	// Strings:
+	custom_dr::FMC_REF_NAV_NAVAID_1_OUT,
+	custom_dr::FMC_REF_NAV_NAVAID_2_OUT,
+	custom_dr::FMC_REF_NAV_VOR_1_OUT,
+	custom_dr::FMC_REF_NAV_VOR_2_OUT,
+
+	custom_dr::FMC_RTE1_DEP_ICAO_OUT,
+	custom_dr::FMC_RTE1_ARR_ICAO_OUT,
+	custom_dr::FMC_RTE1_DEP_RNW_OUT,
+
+	// Some debug datarefs up in here
+
+	custom_dr::FMC_RAD_NAV_VOR_DME_C1,
+	custom_dr::FMC_RAD_NAV_VOR_DME_C2,
+	custom_dr::FMC_RAD_NAV_VOR_DME_C3,
+	custom_dr::FMC_RAD_NAV_VOR_DME_C4,
+
+	custom_dr::FMC_RAD_NAV_DME_DME_C1,
+	custom_dr::FMC_RAD_NAV_DME_DME_C2,
+	custom_dr::FMC_RAD_NAV_DME_DME_C3,
+	custom_dr::FMC_RAD_NAV_DME_DME_C4,
+	custom_dr::FMC_RAD_NAV_DME_DME_TUNED_PAIR,
+
+	// FMC L data refs:
+
+	custom_dr::FMC_L_REF_NAV_INPUT_ICAO,
+	custom_dr::FMC_L_REF_NAV_OUT_ICAO,
+	custom_dr::FMC_L_REF_NAV_POI_MAG_VAR,
+	custom_dr::FMC_L_REF_NAV_NAVAID_1_IN,
+	custom_dr::FMC_L_REF_NAV_NAVAID_2_IN,
+	custom_dr::FMC_L_REF_NAV_VOR_1_IN,
+	custom_dr::FMC_L_REF_NAV_VOR_2_IN,
+
+	custom_dr::FMC_L_RTE1_DEP_ICAO_IN,
+	custom_dr::FMC_L_RTE1_ARR_ICAO_IN,
+	custom_dr::FMC_L_RTE1_DEP_RNW_IN,
+
+	custom_dr::FMC_L_SEL_WPT_POI1_TYPE,
+	custom_dr::FMC_L_SEL_WPT_POI2_TYPE,
+	custom_dr::FMC_L_SEL_WPT_POI3_TYPE,
+	custom_dr::FMC_L_SEL_WPT_POI4_TYPE,
+	custom_dr::FMC_L_SEL_WPT_POI5_TYPE,
+	custom_dr::FMC_L_SEL_WPT_POI6_TYPE,
+	custom_dr::FMC_L_SCRATCHPAD_MSG,
+
+	// FMC R data refs:
+
+	custom_dr::FMC_R_REF_NAV_INPUT_ICAO,
+	custom_dr::FMC_R_REF_NAV_OUT_ICAO,
+	custom_dr::FMC_R_REF_NAV_POI_MAG_VAR,
+	custom_dr::FMC_R_REF_NAV_NAVAID_1_IN,
+	custom_dr::FMC_R_REF_NAV_NAVAID_2_IN,
+	custom_dr::FMC_R_REF_NAV_VOR_1_IN,
+	custom_dr::FMC_R_REF_NAV_VOR_2_IN,
+
+	custom_dr::FMC_R_RTE1_DEP_ICAO_IN,
+	custom_dr::FMC_R_RTE1_ARR_ICAO_IN,
+	custom_dr::FMC_R_RTE1_DEP_RNW_IN,
+
+	custom_dr::FMC_R_SEL_WPT_POI1_TYPE,
+	custom_dr::FMC_R_SEL_WPT_POI2_TYPE,
+	custom_dr::FMC_R_SEL_WPT_POI3_TYPE,
+	custom_dr::FMC_R_SEL_WPT_POI4_TYPE,
+	custom_dr::FMC_R_SEL_WPT_POI5_TYPE,
+	custom_dr::FMC_R_SEL_WPT_POI6_TYPE,
+	custom_dr::FMC_R_SCRATCHPAD_MSG
 };
 
+constexpr size_t N_CUSTOM_DRS = sizeof(CUSTOM_DRS) / sizeof(CUSTOM_DRS[0]);
+
+typedef DRUtil::DRRegistry<CUSTOM_DRS, N_CUSTOM_DRS> custom_dr_registry_t;
+
 StratosphereAvionics::avionics_in_drs av_in = {
 											"sim/cockpit2/gauges/indicators/altitude_ft_pilot",
 											"sim/cockpit2/gauges/indicators/altitude_ft_copilot",
@@ -251,120 +434,121 @@ StratosphereAvionics::avionics_in_drs av_in = {
 };
 
 StratosphereAvionics::avionics_out_drs av_out = {
-											"Strato/777/FMC/RTE1/dep_icao_out",
-											"Strato/777/FMC/RTE1/arr_icao_out",
-											"Strato/777/FMC/RTE1/dep_rnw_out",
-											{"Strato/777/FMC/REF_NAV/navaid_1_out",
-											 "Strato/777/FMC/REF_NAV/navaid_2_out"},
-											{"Strato/777/FMC/REF_NAV/vor_1_out",
-											 "Strato/777/FMC/REF_NAV/vor_2_out"},
-
-											{"Strato/777/FMC/RAD_NAV/VOR_DME/pos_lat",
-											 "Strato/777/FMC/RAD_NAV/VOR_DME/pos_lon",
-											 "Strato/777/FMC/RAD_NAV/VOR_DME/pos_fom",
-											 "Strato/777/FMC/RAD_NAV/DME_DME/pos_lat",
-											 "Strato/777/FMC/RAD_NAV/DME_DME/pos_lon",
-											 "Strato/777/FMC/RAD_NAV/DME_DME/pos_fom",
-											 "Strato/777/FMC/RAD_NAV/DME_DME/tuned_pair"},
-
-											{{"Strato/777/FMC/RAD_NAV/VOR_DME/c1", 
-											  "Strato/777/FMC/RAD_NAV/VOR_DME/c2",
-											  "Strato/777/FMC/RAD_NAV/VOR_DME/c3",
-											  "Strato/777/FMC/RAD_NAV/VOR_DME/c4"},
-
-											 {"Strato/777/FMC/RAD_NAV/DME_DME/c1",
-											  "Strato/777/FMC/RAD_NAV/DME_DME/c2",
-											  "Strato/777/FMC/RAD_NAV/DME_DME/c3",
-											  "Strato/777/FMC/RAD_NAV/DME_DME/c4"}}
-											
+											custom_dr::FMC_RTE1_DEP_ICAO_OUT.name,
+											custom_dr::FMC_RTE1_ARR_ICAO_OUT.name,
+											custom_dr::FMC_RTE1_DEP_RNW_OUT.name,
+											{custom_dr::FMC_REF_NAV_NAVAID_1_OUT.name,
+											 custom_dr::FMC_REF_NAV_NAVAID_2_OUT.name},
+											{custom_dr::FMC_REF_NAV_VOR_1_OUT.name,
+											 custom_dr::FMC_REF_NAV_VOR_2_OUT.name},
+
+											{custom_dr::FMC_RAD_NAV_VOR_DME_POS_LAT.name,
+											 custom_dr::FMC_RAD_NAV_VOR_DME_POS_LON.name,
+											 custom_dr::FMC_RAD_NAV_VOR_DME_POS_FOM.name,
+											 custom_dr::FMC_RAD_NAV_DME_DME_POS_LAT.name,
+											 custom_dr::FMC_RAD_NAV_DME_DME_POS_LON.name,
+											 custom_dr::FMC_RAD_NAV_DME_DME_POS_FOM.name,
+											 custom_dr::FMC_RAD_NAV_DME_DME_TUNED_PAIR.name},
+
+											{{custom_dr::FMC_RAD_NAV_VOR_DME_C1.name, 
+											  custom_dr::FMC_RAD_NAV_VOR_DME_C2.name,
+											  custom_dr::FMC_RAD_NAV_VOR_DME_C3.name,
+											  custom_dr::FMC_RAD_NAV_VOR_DME_C4.name},
+
+											 {custom_dr::FMC_RAD_NAV_DME_DME_C1.name,
+											  custom_dr::FMC_RAD_NAV_DME_DME_C2.name,
+											  custom_dr::FMC_RAD_NAV_DME_DME_C3.name,
+											  custom_dr::FMC_RAD_NAV_DME_DME_C4.name}},
+
+											custom_dr::UI_MESSAGES_CREATING_DATABASES.name
 };
 
 StratosphereAvionics::fmc_in_drs fmc_l_in = {
 											"sim/flightmodel/position/latitude",
 											"sim/flightmodel/position/longitude",
 
-										   {"Strato/777/FMC/FMC_L/REF_NAV/input_icao",
-											"Strato/777/FMC/REF_NAV/rad_nav_inh",
-											{"Strato/777/FMC/FMC_L/REF_NAV/navaid_1_in",
-											 "Strato/777/FMC/FMC_L/REF_NAV/navaid_2_in"},
-											{"Strato/777/FMC/FMC_L/REF_NAV/vor_1_in",
-											 "Strato/777/FMC/FMC_L/REF_NAV/vor_2_in"}},
-										   {"Strato/777/FMC/FMC_L/RTE1/dep_icao_in",
-											"Strato/777/FMC/FMC_L/RTE1/arr_icao_in",
-											"Strato/777/FMC/FMC_L/RTE1/dep_rnw_in"},
-										   {"Strato/777/FMC/FMC_L/SEL_WPT/subpage",
-											"Strato/777/FMC/FMC_L/SEL_WPT/wpt_idx"},
-
-											"Strato/777/FMC/FMC_L/clear_msg",
-											"Strato/777/FMC/FMC_L/page"
+										   {custom_dr::FMC_L_REF_NAV_INPUT_ICAO.name,
+											custom_dr::FMC_REF_NAV_RAD_NAV_INH.name,
+											{custom_dr::FMC_L_REF_NAV_NAVAID_1_IN.name,
+											 custom_dr::FMC_L_REF_NAV_NAVAID_2_IN.name},
+											{custom_dr::FMC_L_REF_NAV_VOR_1_IN.name,
+											 custom_dr::FMC_L_REF_NAV_VOR_2_IN.name}},
+										   {custom_dr::FMC_L_RTE1_DEP_ICAO_IN.name,
+											custom_dr::FMC_L_RTE1_ARR_ICAO_IN.name,
+											custom_dr::FMC_L_RTE1_DEP_RNW_IN.name},
+										   {custom_dr::FMC_L_SEL_WPT_SUBPAGE.name,
+											custom_dr::FMC_L_SEL_WPT_WPT_IDX.name},
+
+											custom_dr::FMC_L_CLEAR_MSG.name,
+											custom_dr::FMC_L_PAGE.name
 };
 
 StratosphereAvionics::fmc_out_drs fmc_l_out = {
-											 {"Strato/777/FMC/FMC_L/REF_NAV/out_icao",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_type",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_lat",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_lon",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_elev",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_freq",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_mag_var",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_length_ft",
-											  "Strato/777/FMC/FMC_L/REF_NAV/poi_length_m"},
-
-											 {"Strato/777/FMC/FMC_L/SEL_WPT/is_active",
-											  "Strato/777/FMC/FMC_L/SEL_WPT/n_subpages",
-											  "Strato/777/FMC/FMC_L/SEL_WPT/n_pois_disp",
-											  "Strato/777/FMC/FMC_L/SEL_WPT/poi_list",
-											  {"Strato/777/FMC/FMC_L/SEL_WPT/poi1_type",
-											   "Strato/777/FMC/FMC_L/SEL_WPT/poi2_type",
-											   "Strato/777/FMC/FMC_L/SEL_WPT/poi3_type",
-											   "Strato/777/FMC/FMC_L/SEL_WPT/poi4_type",
-											   "Strato/777/FMC/FMC_L/SEL_WPT/poi5_type",
-											   "Strato/777/FMC/FMC_L/SEL_WPT/poi6_type"}},
-
-											 {0, {"Strato/777/FMC/FMC_L/scratchpad/not_in_database"}}
+											 {custom_dr::FMC_L_REF_NAV_OUT_ICAO.name,
+											  custom_dr::FMC_L_REF_NAV_POI_TYPE.name,
+											  custom_dr::FMC_L_REF_NAV_POI_LAT.name,
+											  custom_dr::FMC_L_REF_NAV_POI_LON.name,
+											  custom_dr::FMC_L_REF_NAV_POI_ELEV.name,
+											  custom_dr::FMC_L_REF_NAV_POI_FREQ.name,
+											  custom_dr::FMC_L_REF_NAV_POI_MAG_VAR.name,
+											  custom_dr::FMC_L_REF_NAV_POI_LENGTH_FT.name,
+											  custom_dr::FMC_L_REF_NAV_POI_LENGTH_M.name},
+
+											 {custom_dr::FMC_L_SEL_WPT_IS_ACTIVE.name,
+											  custom_dr::FMC_L_SEL_WPT_N_SUBPAGES.name,
+											  custom_dr::FMC_L_SEL_WPT_N_POIS_DISP.name,
+											  custom_dr::FMC_L_SEL_WPT_POI_LIST.name,
+											  {custom_dr::FMC_L_SEL_WPT_POI1_TYPE.name,
+											   custom_dr::FMC_L_SEL_WPT_POI2_TYPE.name,
+											   custom_dr::FMC_L_SEL_WPT_POI3_TYPE.name,
+											   custom_dr::FMC_L_SEL_WPT_POI4_TYPE.name,
+											   custom_dr::FMC_L_SEL_WPT_POI5_TYPE.name,
+											   custom_dr::FMC_L_SEL_WPT_POI6_TYPE.name}},
+
+											 {0, {custom_dr::FMC_L_SCRATCHPAD_NOT_IN_DATABASE.name}}
 };
 
 StratosphereAvionics::fmc_in_drs fmc_r_in = {
 											"sim/flightmodel/position/latitude",
 											"sim/flightmodel/position/longitude",
 
-										   {"Strato/777/FMC/FMC_R/REF_NAV/input_icao",
-											"Strato/777/FMC/REF_NAV/rad_nav_inh",
-											{"Strato/777/FMC/FMC_R/REF_NAV/navaid_1_in",
-											 "Strato/777/FMC/FMC_R/REF_NAV/navaid_2_in"},
-											{"Strato/777/FMC/FMC_R/REF_NAV/vor_1_in",
-											 "Strato/777/FMC/FMC_R/REF_NAV/vor_2_in"}},
-										   {"Strato/777/FMC/FMC_R/RTE1/dep_icao_in",
-											"Strato/777/FMC/FMC_R/RTE1/arr_icao_in",
-											"Strato/777/FMC/FMC_R/RTE1/dep_rnw_in"},
-										   {"Strato/777/FMC/FMC_R/SEL_WPT/subpage",
-											"Strato/777/FMC/FMC_R/SEL_WPT/wpt_idx"},
-
-											"Strato/777/FMC/FMC_R/clear_msg",
-											"Strato/777/FMC/FMC_R/page"
+										   {custom_dr::FMC_R_REF_NAV_INPUT_ICAO.name,
+											custom_dr::FMC_REF_NAV_RAD_NAV_INH.name,
+											{custom_dr::FMC_R_REF_NAV_NAVAID_1_IN.name,
+											 custom_dr::FMC_R_REF_NAV_NAVAID_2_IN.name},
+											{custom_dr::FMC_R_REF_NAV_VOR_1_IN.name,
+											 custom_dr::FMC_R_REF_NAV_VOR_2_IN.name}},
+										   {custom_dr::FMC_R_RTE1_DEP_ICAO_IN.name,
+											custom_dr::FMC_R_RTE1_ARR_ICAO_IN.name,
+											custom_dr::FMC_R_RTE1_DEP_RNW_IN.name},
+										   {custom_dr::FMC_R_SEL_WPT_SUBPAGE.name,
+											custom_dr::FMC_R_SEL_WPT_WPT_IDX.name},
+
+											custom_dr::FMC_R_CLEAR_MSG.name,
+											custom_dr::FMC_R_PAGE.name
 };
 
 StratosphereAvionics::fmc_out_drs fmc_r_out = {
-											 {"Strato/777/FMC/FMC_R/REF_NAV/out_icao",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_type",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_lat",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_lon",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_elev",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_freq",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_mag_var",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_length_ft",
-											  "Strato/777/FMC/FMC_R/REF_NAV/poi_length_m"},
-
-											 {"Strato/777/FMC/FMC_R/SEL_WPT/is_active",
-											  "Strato/777/FMC/FMC_R/SEL_WPT/n_subpages",
-											  "Strato/777/FMC/FMC_R/SEL_WPT/n_pois_disp",
-											  "Strato/777/FMC/FMC_R/SEL_WPT/poi_list",
-											  {"Strato/777/FMC/FMC_R/SEL_WPT/poi1_type",
-											   "Strato/777/FMC/FMC_R/SEL_WPT/poi2_type",
-											   "Strato/777/FMC/FMC_R/SEL_WPT/poi3_type",
-											   "Strato/777/FMC/FMC_R/SEL_WPT/poi4_type",
-											   "Strato/777/FMC/FMC_R/SEL_WPT/poi5_type",
-											   "Strato/777/FMC/FMC_R/SEL_WPT/poi6_type"}},
-
-											 {0, {"Strato/777/FMC/FMC_L/scratchpad/not_in_database"}}
+											 {custom_dr::FMC_R_REF_NAV_OUT_ICAO.name,
+											  custom_dr::FMC_R_REF_NAV_POI_TYPE.name,
+											  custom_dr::FMC_R_REF_NAV_POI_LAT.name,
+											  custom_dr::FMC_R_REF_NAV_POI_LON.name,
+											  custom_dr::FMC_R_REF_NAV_POI_ELEV.name,
+											  custom_dr::FMC_R_REF_NAV_POI_FREQ.name,
+											  custom_dr::FMC_R_REF_NAV_POI_MAG_VAR.name,
+											  custom_dr::FMC_R_REF_NAV_POI_LENGTH_FT.name,
+											  custom_dr::FMC_R_REF_NAV_POI_LENGTH_M.name},
+
+											 {custom_dr::FMC_R_SEL_WPT_IS_ACTIVE.name,
+											  custom_dr::FMC_R_SEL_WPT_N_SUBPAGES.name,
+											  custom_dr::FMC_R_SEL_WPT_N_POIS_DISP.name,
+											  custom_dr::FMC_R_SEL_WPT_POI_LIST.name,
+											  {custom_dr::FMC_R_SEL_WPT_POI1_TYPE.name,
+											   custom_dr::FMC_R_SEL_WPT_POI2_TYPE.name,
+											   custom_dr::FMC_R_SEL_WPT_POI3_TYPE.name,
+											   custom_dr::FMC_R_SEL_WPT_POI4_TYPE.name,
+											   custom_dr::FMC_R_SEL_WPT_POI5_TYPE.name,
+											   custom_dr::FMC_R_SEL_WPT_POI6_TYPE.name}},
+
+											 {0, {custom_dr::FMC_R_SCRATCHPAD_NOT_IN_DATABASE.name}}
 };
@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include "dataref_structs.hpp"
+#include "dr_registry.hpp"
 #include <fmc_sys.hpp>
 #include <vector>
 
@@ -20,27 +20,18 @@
 typedef std::vector<XPDataBus::cmd_entry>* db_cmd_ptr_t;
 typedef std::vector<XPDataBus::custom_data_ref_entry>* custom_dr_ptr;
 typedef std::vector<DRUtil::cmd_t>* cmd_ptr_t;
-typedef std::vector<DRUtil::dref_i>* dr_i_ptr;
-typedef std::vector<DRUtil::dref_d>* dr_d_ptr;
-typedef std::vector<DRUtil::dref_ia>* dr_ia_ptr;
-typedef std::vector<DRUtil::dref_fa>* dr_fa_ptr;
-typedef std::vector<DRUtil::dref_s>* dr_s_ptr;
 
 
 namespace fmc_dr
 {
-	struct dr_init
-	{
-		dr_i_ptr int_drs;
-		dr_d_ptr double_drs;
-		dr_ia_ptr int_arr_drs;
-		dr_fa_ptr float_arr_drs;
-		dr_s_ptr str_drs;
-	};
+	/*
+		R is a DRUtil::DRRegistry. All of the custom datarefs are declared
+		in its table, so they are created in a single pass over it.
+	*/
 
-	
+	template <class R>
 	int register_data_refs(db_cmd_ptr_t db_cmds, custom_dr_ptr data_refs, 
-		cmd_ptr_t cmds, dr_init drs)
+		cmd_ptr_t cmds, R* drs)
 	{
 		// Register custom commands
 		for(size_t i = 0; i < cmds->size(); i++)
@@ -56,104 +47,13 @@ namespace fmc_dr
 			db_cmds->push_back(e);
 		}
 		// Register custom data refs
-		for (size_t i = 0; i < drs.int_drs->size(); i++)
-		{
-			int ret = drs.int_drs->at(i).init();
-
-			if (!ret)
-			{
-				return 0;
-			}
-
-			XPDataBus::custom_data_ref_entry e = { drs.int_drs->at(i).dr.name, 
-					{(void*)&drs.int_drs->at(i).val, xplmType_Int, 1} };
-			data_refs->push_back(e);
-		}
-
-		for (size_t i = 0; i < drs.double_drs->size(); i++)
-		{
-			int ret = drs.double_drs->at(i).init();
-
-			if (!ret)
-			{
-				return 0;
-			}
-
-			XPDataBus::custom_data_ref_entry e = { drs.double_drs->at(i).dr.name, {(void*)&drs.double_drs->at(i).val,
-													xplmType_Double, 1} };
-			data_refs->push_back(e);
-		}
-
-		for (size_t i = 0; i < drs.int_arr_drs->size(); i++)
-		{
-			int ret = drs.int_arr_drs->at(i).init();
-
-			if (!ret)
-			{
-				return 0;
-			}
-
-			XPDataBus::custom_data_ref_entry e = { drs.int_arr_drs->at(i).dr.name, {(void*)drs.int_arr_drs->at(i).array,
-													xplmType_IntArray, drs.int_arr_drs->at(i).n_length} };
-			data_refs->push_back(e);
-		}
-
-		for (size_t i = 0; i < drs.float_arr_drs->size(); i++)
-		{
-			int ret = drs.float_arr_drs->at(i).init();
-
-			if (!ret)
-			{
-				return 0;
-			}
-
-			XPDataBus::custom_data_ref_entry e = { drs.float_arr_drs->at(i).dr.name, {(void*)drs.float_arr_drs->at(i).array,
-													xplmType_FloatArray, drs.float_arr_drs->at(i).n_length} };
-			data_refs->push_back(e);
-		}
-
-		for (size_t i = 0; i < drs.str_drs->size(); i++)
-		{
-			int ret = drs.str_drs->at(i).init();
-
-			if (!ret)
-			{
-				return 0;
-			}
-
-			XPDataBus::custom_data_ref_entry e = { drs.str_drs->at(i).dr.name, {(void*)drs.str_drs->at(i).str,
-													xplmType_Data, drs.str_drs->at(i).n_length} };
-			data_refs->push_back(e);
-		}
-
-		return 1;
+		return drs->reg(data_refs);
 	}
 
-	void unregister_data_refs(dr_init drs)
+	template <class R>
+	void unregister_data_refs(R* drs)
 	{
-		for (size_t i = 0; i < drs.int_drs->size(); i++)
-		{
-			drs.int_drs->at(i).unReg();
-		}
-
-		for (size_t i = 0; i < drs.double_drs->size(); i++)
-		{
-			drs.double_drs->at(i).unReg();
-		}
-
-		for (size_t i = 0; i < drs.int_arr_drs->size(); i++)
-		{
-			drs.int_arr_drs->at(i).unReg();
-		}
-
-		for (size_t i = 0; i < drs.float_arr_drs->size(); i++)
-		{
-			drs.float_arr_drs->at(i).unReg();
-		}
-
-		for (size_t i = 0; i < drs.str_drs->size(); i++)
-		{
-			drs.str_drs->at(i).unReg();
-		}
+		drs->unreg();
+		DRUtil::DREManager::cleanup();
 	}
 }
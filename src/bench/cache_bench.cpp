@@ -0,0 +1,218 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a contention benchmark for DataRefCache.
+	It compares the sequence locked cache against the mutex protected
+	unordered_map that it replaced. Two threads play the FMCs: every tick they
+	compare their string and int inputs against the cache and store the ones
+	that changed. A third thread plays the avionics and writes numbers. The
+	threads share one cache, which is the worst case.
+	Usage: cache_bench [n_ticks]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "dr_cache.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+constexpr int N_TICKS_DEFAULT = 200000;
+constexpr int N_FMC_STR_INPUTS = 8;
+constexpr int N_FMC_INT_INPUTS = 4;
+constexpr int N_AV_VALS = 16;
+constexpr int N_FMCS = 2;
+// An input changes once every this many ticks
+constexpr int INPUT_CHANGE_PERIOD = 50;
+const char* TEST_ICAOS[] = {"KSFO", "EGLL"};
+
+
+// Same locking and copying as the old cache
+class MutexCache
+{
+public:
+	XPDataBus::generic_val get_val(XPDataBus::dr_handle_t dr)
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		XPDataBus::generic_val tmp = { {0}, "", xplmType_Unknown, 0 };
+		if (cache.find(dr) != cache.end())
+		{
+			tmp = cache.at(dr);
+		}
+		return tmp;
+	}
+
+	void set_val(XPDataBus::dr_handle_t dr, XPDataBus::generic_val val)
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		cache[dr] = val;
+	}
+
+	bool update_s(XPDataBus::dr_handle_t dr, const std::string& in)
+	{
+		if (get_val(dr).str.to_string() == in)
+		{
+			return false;
+		}
+		set_val(dr, XPDataBus::generic_val{ {0}, in, xplmType_Data, 0 });
+		return true;
+	}
+
+	bool update_i(XPDataBus::dr_handle_t dr, int in)
+	{
+		XPDataBus::generic_val tmp = get_val(dr);
+		if (tmp.val_type == xplmType_Int && tmp.int_val == in)
+		{
+			return false;
+		}
+		tmp = { {0}, "", xplmType_Int, 0 };
+		tmp.int_val = in;
+		set_val(dr, tmp);
+		return true;
+	}
+
+	void set_val_d(XPDataBus::dr_handle_t dr, double in)
+	{
+		XPDataBus::generic_val tmp = { {0}, "", xplmType_Double, 0 };
+		tmp.double_val = in;
+		set_val(dr, tmp);
+	}
+
+	double get_val_d(XPDataBus::dr_handle_t dr)
+	{
+		XPDataBus::generic_val tmp = get_val(dr);
+		return XPDataBus::get_gen_val_d(&tmp);
+	}
+
+private:
+	std::unordered_map<XPDataBus::dr_handle_t, XPDataBus::generic_val> cache;
+	std::mutex cache_mutex;
+};
+
+struct bench_res
+{
+	double ticks_per_sec; // Of a single FMC thread
+	std::vector<int64_t> tick_lat; // ns
+};
+
+
+inline int64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <class C>
+bench_res run_bench(int n_ticks)
+{
+	C cache;
+	bench_res res;
+	res.tick_lat.assign(size_t(N_FMCS) * size_t(n_ticks), 0);
+	std::vector<std::thread> threads;
+	int64_t t_start = now_ns();
+
+	for (int i = 0; i < N_FMCS; i++)
+	{
+		threads.push_back(std::thread([&cache, &res, i, n_ticks]()
+			{
+				XPDataBus::dr_handle_t base = XPDataBus::dr_handle_t(i *
+					(N_FMC_STR_INPUTS + N_FMC_INT_INPUTS));
+				int64_t* lat = &res.tick_lat[size_t(i) * size_t(n_ticks)];
+				int n_changed = 0;
+				for (int j = 0; j < n_ticks; j++)
+				{
+					std::string icao = TEST_ICAOS[(j / INPUT_CHANGE_PERIOD) % 2];
+					int64_t t1 = now_ns();
+					for (int k = 0; k < N_FMC_STR_INPUTS; k++)
+					{
+						n_changed += cache.update_s(base + k, icao);
+					}
+					for (int k = 0; k < N_FMC_INT_INPUTS; k++)
+					{
+						n_changed += cache.update_i(base + N_FMC_STR_INPUTS + k,
+							j / INPUT_CHANGE_PERIOD);
+					}
+					lat[j] = now_ns() - t1;
+				}
+				if (n_changed == 0)
+				{
+					printf("No inputs changed\n");
+				}
+			}));
+	}
+
+	threads.push_back(std::thread([&cache, n_ticks]()
+		{
+			XPDataBus::dr_handle_t base = XPDataBus::dr_handle_t(N_FMCS *
+				(N_FMC_STR_INPUTS + N_FMC_INT_INPUTS));
+			double sum = 0;
+			for (int j = 0; j < n_ticks; j++)
+			{
+				for (int k = 0; k < N_AV_VALS; k++)
+				{
+					cache.set_val_d(base + k, double(j + k));
+					sum += cache.get_val_d(base + k);
+				}
+			}
+			if (sum < 0)
+			{
+				printf("Impossible sum\n");
+			}
+		}));
+
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+	int64_t t_end = now_ns();
+
+	res.ticks_per_sec = double(n_ticks) / (double(t_end - t_start) * 1e-9);
+	return res;
+}
+
+int64_t get_pct(std::vector<int64_t>* sorted, double pct)
+{
+	size_t idx = size_t(pct / 100.0 * double(sorted->size() - 1));
+	return sorted->at(idx);
+}
+
+void print_res(const char* name, bench_res* res)
+{
+	std::sort(res->tick_lat.begin(), res->tick_lat.end());
+	printf("%-12s %12.0f %9lld %9lld %9lld %11lld\n", name, res->ticks_per_sec,
+		(long long)get_pct(&res->tick_lat, 50),
+		(long long)get_pct(&res->tick_lat, 99),
+		(long long)get_pct(&res->tick_lat, 99.9),
+		(long long)res->tick_lat.back());
+}
+
+
+int main(int argc, char** argv)
+{
+	int n_ticks = N_TICKS_DEFAULT;
+	if (argc > 1)
+	{
+		n_ticks = std::max(1, atoi(argv[1]));
+	}
+
+	printf("%d ticks, %d FMC threads with %d inputs each, 1 avionics thread\n", n_ticks,
+		N_FMCS, N_FMC_STR_INPUTS + N_FMC_INT_INPUTS);
+	printf("%-12s %12s %9s %9s %9s %11s\n", "cache", "ticks/s", "tick p50", "tick p99",
+		"tick p999", "tick max");
+	printf("(latencies in ns)\n");
+
+	bench_res res_mtx = run_bench<MutexCache>(n_ticks);
+	print_res("mutex_map", &res_mtx);
+	bench_res res_seq = run_bench<XPDataBus::DataRefCache>(n_ticks);
+	print_res("seqlock", &res_seq);
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a benchmark of the startup and shutdown of the
+	plugin's custom datarefs and commands. Every run registers all of them
+	against the fake XPLM library with DataRefEditor present, the same way
+	the plugin does, runs flight loops until the datarefs have been announced
+	to DataRefEditor, then unregisters everything. Startup is the time spent
+	registering, frame cost is the time spent in flight loops per frame, the
+	costliest frame being the one in which the datarefs are announced.
+	Usage: dre_bench [n_runs]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "sim_utils.hpp"
+#include "777_dr_init.hpp"
+#include "777_dr_decl.hpp"
+#include <cstdlib>
+
+
+constexpr int N_RUNS_DEFAULT = 200;
+constexpr double FRAME_HZ = 60;
+// Flight loops are run for this long after startup
+constexpr double ANNOUNCE_WINDOW_SEC = 3;
+const char* DRE_PLUGIN_SIGN = "xplanesdk.examples.DataRefEditor";
+
+
+struct run_res
+{
+	double startup_us, max_frame_us, shutdown_us;
+	size_t n_flt_loops; // Registered by startup
+	size_t n_flt_loops_left; // Still registered after shutdown
+	int n_msgs; // Sent to DataRefEditor
+};
+
+
+run_res run_once()
+{
+	FakeXPLM::reset();
+	XPLMPluginID dre_id = FakeXPLM::add_plugin(DRE_PLUGIN_SIGN);
+	run_res res;
+
+	// The registry keeps all of the datarefs, so a new one is used for every run
+	custom_dr_registry_t* drs = new custom_dr_registry_t();
+	std::vector<XPDataBus::cmd_entry> db_cmds;
+	std::vector<XPDataBus::custom_data_ref_entry> data_refs;
+	auto t1 = std::chrono::steady_clock::now();
+	if (!fmc_dr::register_data_refs(&db_cmds, &data_refs, &custom_cmds, drs))
+	{
+		printf("Failed to register datarefs\n");
+		exit(1);
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	res.startup_us = std::chrono::duration<double, std::micro>(t2 - t1).count();
+	res.n_flt_loops = FakeXPLM::get_n_flt_loops();
+
+	res.max_frame_us = 0;
+	int n_frames = int(ANNOUNCE_WINDOW_SEC * FRAME_HZ);
+	for (int i = 0; i < n_frames; i++)
+	{
+		auto t3 = std::chrono::steady_clock::now();
+		FakeXPLM::run_frame(1.0 / FRAME_HZ);
+		auto t4 = std::chrono::steady_clock::now();
+		res.max_frame_us = std::max(res.max_frame_us,
+			std::chrono::duration<double, std::micro>(t4 - t3).count());
+	}
+	res.n_msgs = FakeXPLM::get_n_msgs(dre_id);
+
+	auto t5 = std::chrono::steady_clock::now();
+	fmc_dr::unregister_data_refs(drs);
+	auto t6 = std::chrono::steady_clock::now();
+	res.shutdown_us = std::chrono::duration<double, std::micro>(t6 - t5).count();
+	res.n_flt_loops_left = FakeXPLM::get_n_flt_loops();
+
+	delete drs;
+	return res;
+}
+
+
+int main(int argc, char** argv)
+{
+	int n_runs = N_RUNS_DEFAULT;
+	if (argc > 1)
+	{
+		n_runs = std::max(1, atoi(argv[1]));
+	}
+
+	std::vector<double> startup_us, frame_us, shutdown_us;
+	run_res res = { 0, 0, 0, 0, 0, 0 };
+	for (int i = 0; i < n_runs; i++)
+	{
+		res = run_once();
+		startup_us.push_back(res.startup_us);
+		frame_us.push_back(res.max_frame_us);
+		shutdown_us.push_back(res.shutdown_us);
+	}
+
+	printf("%d runs, %zu datarefs\n", n_runs, N_CUSTOM_DRS);
+	printf("%zu flight loops after startup, %zu after shutdown, %d messages to DataRefEditor\n",
+		res.n_flt_loops, res.n_flt_loops_left, res.n_msgs);
+	printf("%-24s %10s %10s %10s %10s\n", "us", "mean", "p50", "p99", "max");
+	print_stats("startup", get_stats(&startup_us));
+	print_stats("max frame cost", get_stats(&frame_us));
+	print_stats("shutdown", get_stats(&shutdown_us));
+	return 0;
+}
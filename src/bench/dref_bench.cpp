@@ -0,0 +1,213 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains checks and a benchmark of the array and string
+	dataref structures, run against the fake XPLM library. First, array and
+	string datarefs that are owned by the sim are checked: their length is
+	read once in init() and every access is clamped to it. Then the time per
+	call is measured for reads and writes of a 24 character string dataref
+	owned by this plugin, which go through its SeqBuf one character at a time,
+	next to a memcpy of the same length. Exits with 1 if any check fails.
+	Usage: dref_bench [n_iterations]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "fake_xplm.hpp"
+#include "dataref_structs.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+constexpr int N_ITER_DEFAULT = 1000000;
+const char* ARR_CHECK_DR = "dref_bench/arr_check";
+const char* STR_CHECK_DR = "dref_bench/str_check";
+const char* STR_BENCH_DR = "dref_bench/str";
+constexpr int ARR_CHECK_LENGTH = 6;
+constexpr int STR_CHECK_LENGTH = 8;
+// Length of an FMC screen line
+const char* TEST_STR_24 = "<INDEX          ROUTE>  ";
+constexpr int TEST_STR_LENGTH = 24;
+
+
+struct arr_check_state
+{
+	std::vector<int> vals;
+	int n_length_reads; // Calls that only ask for the length
+};
+
+
+int arr_check_get_cb(void* ref, int* out_values, int in_offset, int in_max)
+{
+	arr_check_state* state = reinterpret_cast<arr_check_state*>(ref);
+	int arr_length = int(state->vals.size());
+	if (out_values == nullptr)
+	{
+		state->n_length_reads++;
+		return arr_length;
+	}
+	int n = std::max(0, std::min(in_max, arr_length - in_offset));
+	std::copy(state->vals.begin() + in_offset, state->vals.begin() + in_offset + n, out_values);
+	return n;
+}
+
+void arr_check_set_cb(void* ref, int* in_values, int in_offset, int in_count)
+{
+	arr_check_state* state = reinterpret_cast<arr_check_state*>(ref);
+	int n = std::max(0, std::min(in_count, int(state->vals.size()) - in_offset));
+	std::copy(in_values, in_values + n, state->vals.begin() + in_offset);
+}
+
+bool check_arr(const char* what, bool is_ok)
+{
+	if (!is_ok)
+	{
+		printf("Array dataref check failed: %s\n", what);
+	}
+	return is_ok;
+}
+
+bool check_array_data_refs()
+{
+	/*
+		Checks that array and string datarefs that are owned by the sim only
+		have their length read in init() and that reads and writes past the
+		end of the dataref are clamped to it.
+	*/
+
+	FakeXPLM::reset();
+	arr_check_state state = { std::vector<int>(size_t(ARR_CHECK_LENGTH), 0), 0 };
+	XPLMRegisterDataAccessor(ARR_CHECK_DR, xplmType_IntArray, 1, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, arr_check_get_cb, arr_check_set_cb, nullptr, nullptr,
+		nullptr, nullptr, &state, &state);
+
+	XPDataBus::SeqBuf<int> arr_buf(size_t(ARR_CHECK_LENGTH), 0);
+	DRUtil::dref_ia arr(DRUtil::dref_base{ARR_CHECK_DR, true, false}, &arr_buf,
+		ARR_CHECK_LENGTH);
+	if (!check_arr("init", arr.init() == 1) ||
+		!check_arr("cached length", arr.n_dr_length == ARR_CHECK_LENGTH))
+	{
+		return false;
+	}
+
+	int in[ARR_CHECK_LENGTH + 2] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	int out[ARR_CHECK_LENGTH + 2] = { 0 };
+	bool is_ok = check_arr("set_range past the end", arr.set_range(in, 2, 8) == 4) &&
+		check_arr("values written", state.vals == std::vector<int>({ 0, 0, 1, 2, 3, 4 })) &&
+		check_arr("get_range past the end", arr.get_range(out, 4, 8) == 2) &&
+		check_arr("values read", out[0] == 3 && out[1] == 4 && out[2] == 0) &&
+		check_arr("get_range at n_dr_length", arr.get_range(out, ARR_CHECK_LENGTH, 1) == 0) &&
+		check_arr("set_range beyond n_dr_length",
+			arr.set_range(in, ARR_CHECK_LENGTH + 1, 1) == 0) &&
+		check_arr("negative offset", arr.get_range(out, -1, 2) == 0) &&
+		check_arr("get beyond n_dr_length", arr.get(ARR_CHECK_LENGTH) == -1) &&
+		check_arr("values after out of range writes",
+			state.vals == std::vector<int>({ 0, 0, 1, 2, 3, 4 })) &&
+		check_arr("length reads after init", state.n_length_reads == 1);
+	if (!is_ok)
+	{
+		return false;
+	}
+
+	FakeXPLM::add_data_ref(STR_CHECK_DR, xplmType_Data, STR_CHECK_LENGTH);
+	XPDataBus::SeqBuf<char> str_buf(size_t(STR_CHECK_LENGTH), DRUtil::DEFAULT_STR_FILL_CHAR);
+	DRUtil::dref_s str(DRUtil::dref_base{STR_CHECK_DR, true, false}, &str_buf,
+		STR_CHECK_LENGTH);
+	if (!check_arr("string init", str.init() == 1) ||
+		!check_arr("cached string length", str.n_dr_length == STR_CHECK_LENGTH))
+	{
+		return false;
+	}
+
+	std::string val;
+	DRUtil::set_str(&str, "0123456789AB");
+	DRUtil::get_str(&str, &val);
+	is_ok = check_arr("overlong string", val == "01234567");
+	DRUtil::set_str(&str, "AB");
+	DRUtil::get_str(&str, &val);
+	char c_out = 0;
+	is_ok = is_ok && check_arr("short string", val == "AB      ") &&
+		check_arr("string read beyond n_dr_length",
+			str.get_range(&c_out, STR_CHECK_LENGTH, 1) == 0 && c_out == 0);
+
+	FakeXPLM::reset();
+	return is_ok;
+}
+
+
+template <class F>
+double time_ns_per_op(int n_iter, F fn)
+{
+	auto t_start = std::chrono::steady_clock::now();
+	for (int i = 0; i < n_iter; i++)
+	{
+		fn(i);
+	}
+	auto t_end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(t_end - t_start).count() / n_iter;
+}
+
+void print_res(const char* name, double ns_per_op)
+{
+	printf("%-40s %10.1f\n", name, ns_per_op);
+}
+
+
+int main(int argc, char** argv)
+{
+	int n_iter = N_ITER_DEFAULT;
+	if (argc > 1)
+	{
+		n_iter = std::max(1, atoi(argv[1]));
+	}
+
+	if (!check_array_data_refs())
+	{
+		return 1;
+	}
+
+	FakeXPLM::reset();
+	DRUtil::dref_s str(DRUtil::dref_base{STR_BENCH_DR, true, false}, nullptr,
+		TEST_STR_LENGTH);
+	if (str.init() != 1)
+	{
+		printf("Failed to create %s\n", STR_BENCH_DR);
+		return 1;
+	}
+
+	char in[TEST_STR_LENGTH];
+	char out[TEST_STR_LENGTH];
+	std::memcpy(in, TEST_STR_24, size_t(TEST_STR_LENGTH));
+	volatile char sink = 0;
+
+	printf("%d iterations\n", n_iter);
+	printf("%-40s %10s\n", "case", "ns/op");
+	print_res("XPLMSetDatab 24 char, plugin owned", time_ns_per_op(n_iter, [&](int i)
+		{
+			in[0] = char('0' + i % 10);
+			XPLMSetDatab(str.dr.xpdr, in, 0, TEST_STR_LENGTH);
+		}));
+	print_res("XPLMGetDatab 24 char, plugin owned", time_ns_per_op(n_iter, [&](int i)
+		{
+			(void)i;
+			XPLMGetDatab(str.dr.xpdr, out, 0, TEST_STR_LENGTH);
+			sink = out[0];
+		}));
+	print_res("memcpy 24 char", time_ns_per_op(n_iter, [&](int i)
+		{
+			in[0] = char('0' + i % 10);
+			std::memcpy(out, in, size_t(TEST_STR_LENGTH));
+			sink = out[0];
+		}));
+	(void)sink;
+
+	str.unReg();
+	DRUtil::DREManager::cleanup();
+	FakeXPLM::reset();
+	return 0;
+}
@@ -0,0 +1,792 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains definitions of a headless stand-in for the XPLM
+	library. Only the functions that are used by libxp and avionics_sys
+	are provided.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "fake_xplm.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+
+namespace FakeXPLM
+{
+	constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+	const char* PLUGIN_FILE_NAME = "Resources/plugins/777_systems/lin_x64/777_systems.xpl";
+
+
+	struct fake_data_ref
+	{
+		std::string name;
+		XPLMDataTypeID type;
+		bool is_writable;
+
+		// Storage of datarefs that are owned by the sim
+		int val_i;
+		float val_f;
+		double val_d;
+		std::vector<int> arr_i;
+		std::vector<float> arr_f;
+		std::vector<char> bytes;
+
+		// Accessors of datarefs that are registered by plugins
+		bool has_accessors;
+		XPLMGetDatai_f get_i;
+		XPLMSetDatai_f set_i;
+		XPLMGetDataf_f get_f;
+		XPLMSetDataf_f set_f;
+		XPLMGetDatad_f get_d;
+		XPLMSetDatad_f set_d;
+		XPLMGetDatavi_f get_vi;
+		XPLMSetDatavi_f set_vi;
+		XPLMGetDatavf_f get_vf;
+		XPLMSetDatavf_f set_vf;
+		XPLMGetDatab_f get_b;
+		XPLMSetDatab_f set_b;
+		void* read_ref;
+		void* write_ref;
+	};
+
+	struct fake_cmd
+	{
+		std::string name;
+		int n_calls;
+	};
+
+	struct fake_flt_loop
+	{
+		XPLMFlightLoop_f callback;
+		void* refcon;
+		bool is_legacy; // Registered via XPLMRegisterFlightLoopCallback
+		bool is_destroyed;
+		bool is_scheduled;
+		bool in_frames;
+		double next_time;
+		uint64_t next_frame;
+		double last_call_time;
+	};
+
+
+	std::map<std::string, fake_data_ref*> data_refs;
+	std::map<std::string, fake_cmd*> cmds;
+	std::vector<fake_flt_loop*> flt_loops;
+	std::map<std::string, XPLMPluginID> plugins;
+	std::map<XPLMPluginID, int> plugin_msgs;
+
+	std::string system_path = "./";
+	std::string plugin_sign = "";
+	bool is_verbose = false;
+	mag_var_fn_t mag_var_fn = nullptr;
+	double mag_var_cost_us = 0;
+	double sim_time = 0;
+	uint64_t n_frames = 0;
+
+
+	/*
+		Synthetic declination: smooth in both coordinates and within +-25 degrees,
+		so that interpolation and caching can be exercised.
+	*/
+
+	float default_mag_var(double lat_deg, double lon_deg)
+	{
+		double lat = lat_deg * DEG_TO_RAD;
+		double lon = lon_deg * DEG_TO_RAD;
+		return float(20.0 * sin(lon) * cos(lat) + 5.0 * sin(2.0 * lat));
+	}
+
+	void spin_us(double us)
+	{
+		auto start = std::chrono::steady_clock::now();
+		while (std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - start).count() < us);
+	}
+
+	void schedule(fake_flt_loop* loop, double interval, bool relative)
+	{
+		/*
+			Positive intervals are in seconds, negative intervals are in frames.
+			Zero stops the loop.
+		*/
+
+		if (interval == 0)
+		{
+			loop->is_scheduled = false;
+			return;
+		}
+
+		loop->is_scheduled = true;
+		if (interval > 0)
+		{
+			loop->in_frames = false;
+			loop->next_time = (relative ? sim_time : loop->last_call_time) + interval;
+		}
+		else
+		{
+			loop->in_frames = true;
+			loop->next_frame = n_frames + uint64_t(-interval);
+		}
+	}
+
+	fake_flt_loop* add_flt_loop(XPLMFlightLoop_f callback, void* refcon, bool is_legacy)
+	{
+		fake_flt_loop* loop = new fake_flt_loop();
+		loop->callback = callback;
+		loop->refcon = refcon;
+		loop->is_legacy = is_legacy;
+		loop->is_destroyed = false;
+		loop->is_scheduled = false;
+		loop->in_frames = false;
+		loop->next_time = 0;
+		loop->next_frame = 0;
+		loop->last_call_time = sim_time;
+		flt_loops.push_back(loop);
+		return loop;
+	}
+
+	fake_data_ref* new_data_ref(std::string name, XPLMDataTypeID type, bool is_writable)
+	{
+		fake_data_ref* dr = new fake_data_ref();
+		dr->name = name;
+		dr->type = type;
+		dr->is_writable = is_writable;
+		dr->val_i = 0;
+		dr->val_f = 0;
+		dr->val_d = 0;
+		dr->has_accessors = false;
+		data_refs[name] = dr;
+		return dr;
+	}
+
+	template <class T>
+	int read_arr(std::vector<T>& src, T* out, int offset, int max)
+	{
+		int n_total = int(src.size());
+		if (out == nullptr)
+		{
+			return n_total;
+		}
+		int n = std::max(0, std::min(max, n_total - offset));
+		if (n > 0)
+		{
+			memcpy(out, src.data() + offset, size_t(n) * sizeof(T));
+		}
+		return n;
+	}
+
+	template <class T>
+	void write_arr(std::vector<T>& dst, T* in, int offset, int count)
+	{
+		int n = std::max(0, std::min(count, int(dst.size()) - offset));
+		if (n > 0)
+		{
+			memcpy(dst.data() + offset, in, size_t(n) * sizeof(T));
+		}
+	}
+
+
+	void set_system_path(std::string path)
+	{
+		system_path = path;
+	}
+
+	void set_plugin_sign(std::string sign)
+	{
+		plugin_sign = sign;
+	}
+
+	void set_verbose(bool verbose)
+	{
+		is_verbose = verbose;
+	}
+
+	XPLMDataRef add_data_ref(std::string name, XPLMDataTypeID type, int n_length)
+	{
+		fake_data_ref* dr = new_data_ref(name, type, true);
+		if (type & xplmType_IntArray)
+		{
+			dr->arr_i.assign(size_t(n_length), 0);
+		}
+		if (type & xplmType_FloatArray)
+		{
+			dr->arr_f.assign(size_t(n_length), 0);
+		}
+		if (type & xplmType_Data)
+		{
+			dr->bytes.assign(size_t(n_length), 0);
+		}
+		return dr;
+	}
+
+	XPLMPluginID add_plugin(std::string sign)
+	{
+		auto it = plugins.find(sign);
+		if (it != plugins.end())
+		{
+			return it->second;
+		}
+		// IDs of added plugins start right after the plugin under test
+		XPLMPluginID id = FAKE_PLUGIN_ID + XPLMPluginID(plugins.size()) + 1;
+		plugins[sign] = id;
+		plugin_msgs[id] = 0;
+		return id;
+	}
+
+	int get_n_msgs(XPLMPluginID plugin)
+	{
+		auto it = plugin_msgs.find(plugin);
+		if (it == plugin_msgs.end())
+		{
+			return 0;
+		}
+		return it->second;
+	}
+
+	size_t get_n_flt_loops()
+	{
+		size_t out = 0;
+		for (size_t i = 0; i < flt_loops.size(); i++)
+		{
+			if (!flt_loops[i]->is_destroyed)
+			{
+				out++;
+			}
+		}
+		return out;
+	}
+
+	void set_mag_var_model(mag_var_fn_t fn, double cost_us)
+	{
+		mag_var_fn = fn;
+		mag_var_cost_us = cost_us;
+	}
+
+	int run_frame(double dt_sec)
+	{
+		sim_time += dt_sec;
+		n_frames++;
+
+		int n_called = 0;
+		/*
+			Callbacks may create or destroy flight loops, so the vector
+			is walked by index. Loops created in this frame run next frame.
+		*/
+		size_t n_loops = flt_loops.size();
+		for (size_t i = 0; i < n_loops; i++)
+		{
+			fake_flt_loop* loop = flt_loops[i];
+			if (loop->is_destroyed || !loop->is_scheduled)
+			{
+				continue;
+			}
+			bool is_due = loop->in_frames ? n_frames >= loop->next_frame :
+				sim_time >= loop->next_time;
+			if (!is_due)
+			{
+				continue;
+			}
+
+			float since_last = float(sim_time - loop->last_call_time);
+			loop->last_call_time = sim_time;
+			float ret = loop->callback(since_last, float(dt_sec), int(n_frames), loop->refcon);
+			n_called++;
+			if (!loop->is_destroyed)
+			{
+				schedule(loop, double(ret), false);
+			}
+		}
+
+		size_t j = 0;
+		for (size_t i = 0; i < flt_loops.size(); i++)
+		{
+			if (flt_loops[i]->is_destroyed)
+			{
+				delete flt_loops[i];
+			}
+			else
+			{
+				flt_loops[j++] = flt_loops[i];
+			}
+		}
+		flt_loops.resize(j);
+
+		return n_called;
+	}
+
+	double get_sim_time()
+	{
+		return sim_time;
+	}
+
+	uint64_t get_n_frames()
+	{
+		return n_frames;
+	}
+
+	int get_n_cmd_calls(std::string name)
+	{
+		auto it = cmds.find(name);
+		if (it == cmds.end())
+		{
+			return 0;
+		}
+		return it->second->n_calls;
+	}
+
+	void reset()
+	{
+		for (auto it: data_refs)
+		{
+			delete it.second;
+		}
+		data_refs.clear();
+		for (auto it: cmds)
+		{
+			delete it.second;
+		}
+		cmds.clear();
+		for (size_t i = 0; i < flt_loops.size(); i++)
+		{
+			delete flt_loops[i];
+		}
+		flt_loops.clear();
+		plugins.clear();
+		plugin_msgs.clear();
+		sim_time = 0;
+		n_frames = 0;
+	}
+}
+
+
+using namespace FakeXPLM;
+
+
+// Data access:
+
+XPLMDataRef XPLMFindDataRef(const char* inDataRefName)
+{
+	auto it = data_refs.find(inDataRefName);
+	if (it == data_refs.end())
+	{
+		return nullptr;
+	}
+	return it->second;
+}
+
+int XPLMCanWriteDataRef(XPLMDataRef inDataRef)
+{
+	return reinterpret_cast<fake_data_ref*>(inDataRef)->is_writable;
+}
+
+XPLMDataTypeID XPLMGetDataRefTypes(XPLMDataRef inDataRef)
+{
+	return reinterpret_cast<fake_data_ref*>(inDataRef)->type;
+}
+
+XPLMDataRef XPLMRegisterDataAccessor(const char* inDataName, XPLMDataTypeID inDataType,
+	int inIsWritable, XPLMGetDatai_f inReadInt, XPLMSetDatai_f inWriteInt,
+	XPLMGetDataf_f inReadFloat, XPLMSetDataf_f inWriteFloat,
+	XPLMGetDatad_f inReadDouble, XPLMSetDatad_f inWriteDouble,
+	XPLMGetDatavi_f inReadIntArray, XPLMSetDatavi_f inWriteIntArray,
+	XPLMGetDatavf_f inReadFloatArray, XPLMSetDatavf_f inWriteFloatArray,
+	XPLMGetDatab_f inReadData, XPLMSetDatab_f inWriteData,
+	void* inReadRefcon, void* inWriteRefcon)
+{
+	if (data_refs.find(inDataName) != data_refs.end())
+	{
+		return nullptr;
+	}
+
+	fake_data_ref* dr = new_data_ref(inDataName, inDataType, inIsWritable != 0);
+	dr->has_accessors = true;
+	dr->get_i = inReadInt;
+	dr->set_i = inWriteInt;
+	dr->get_f = inReadFloat;
+	dr->set_f = inWriteFloat;
+	dr->get_d = inReadDouble;
+	dr->set_d = inWriteDouble;
+	dr->get_vi = inReadIntArray;
+	dr->set_vi = inWriteIntArray;
+	dr->get_vf = inReadFloatArray;
+	dr->set_vf = inWriteFloatArray;
+	dr->get_b = inReadData;
+	dr->set_b = inWriteData;
+	dr->read_ref = inReadRefcon;
+	dr->write_ref = inWriteRefcon;
+	return dr;
+}
+
+void XPLMUnregisterDataAccessor(XPLMDataRef inDataRef)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	data_refs.erase(dr->name);
+	delete dr;
+}
+
+int XPLMGetDatai(XPLMDataRef inDataRef)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		return dr->get_i != nullptr ? dr->get_i(dr->read_ref) : 0;
+	}
+	return dr->val_i;
+}
+
+void XPLMSetDatai(XPLMDataRef inDataRef, int inValue)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		if (dr->set_i != nullptr)
+		{
+			dr->set_i(dr->write_ref, inValue);
+		}
+		return;
+	}
+	dr->val_i = inValue;
+}
+
+float XPLMGetDataf(XPLMDataRef inDataRef)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		return dr->get_f != nullptr ? dr->get_f(dr->read_ref) : 0;
+	}
+	return dr->val_f;
+}
+
+void XPLMSetDataf(XPLMDataRef inDataRef, float inValue)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		if (dr->set_f != nullptr)
+		{
+			dr->set_f(dr->write_ref, inValue);
+		}
+		return;
+	}
+	dr->val_f = inValue;
+}
+
+double XPLMGetDatad(XPLMDataRef inDataRef)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		return dr->get_d != nullptr ? dr->get_d(dr->read_ref) : 0;
+	}
+	return dr->val_d;
+}
+
+void XPLMSetDatad(XPLMDataRef inDataRef, double inValue)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		if (dr->set_d != nullptr)
+		{
+			dr->set_d(dr->write_ref, inValue);
+		}
+		return;
+	}
+	dr->val_d = inValue;
+}
+
+int XPLMGetDatavi(XPLMDataRef inDataRef, int* outValues, int inOffset, int inMax)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		return dr->get_vi != nullptr ? dr->get_vi(dr->read_ref, outValues, inOffset, inMax) : 0;
+	}
+	return read_arr(dr->arr_i, outValues, inOffset, inMax);
+}
+
+void XPLMSetDatavi(XPLMDataRef inDataRef, int* inValues, int inoffset, int inCount)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		if (dr->set_vi != nullptr)
+		{
+			dr->set_vi(dr->write_ref, inValues, inoffset, inCount);
+		}
+		return;
+	}
+	write_arr(dr->arr_i, inValues, inoffset, inCount);
+}
+
+int XPLMGetDatavf(XPLMDataRef inDataRef, float* outValues, int inOffset, int inMax)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		return dr->get_vf != nullptr ? dr->get_vf(dr->read_ref, outValues, inOffset, inMax) : 0;
+	}
+	return read_arr(dr->arr_f, outValues, inOffset, inMax);
+}
+
+void XPLMSetDatavf(XPLMDataRef inDataRef, float* inValues, int inoffset, int inCount)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		if (dr->set_vf != nullptr)
+		{
+			dr->set_vf(dr->write_ref, inValues, inoffset, inCount);
+		}
+		return;
+	}
+	write_arr(dr->arr_f, inValues, inoffset, inCount);
+}
+
+int XPLMGetDatab(XPLMDataRef inDataRef, void* outValue, int inOffset, int inMaxBytes)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		return dr->get_b != nullptr ? dr->get_b(dr->read_ref, outValue, inOffset, inMaxBytes) : 0;
+	}
+	return read_arr(dr->bytes, reinterpret_cast<char*>(outValue), inOffset, inMaxBytes);
+}
+
+void XPLMSetDatab(XPLMDataRef inDataRef, void* inValue, int inOffset, int inLength)
+{
+	fake_data_ref* dr = reinterpret_cast<fake_data_ref*>(inDataRef);
+	if (dr->has_accessors)
+	{
+		if (dr->set_b != nullptr)
+		{
+			dr->set_b(dr->write_ref, inValue, inOffset, inLength);
+		}
+		return;
+	}
+	write_arr(dr->bytes, reinterpret_cast<char*>(inValue), inOffset, inLength);
+}
+
+// Commands:
+
+XPLMCommandRef XPLMFindCommand(const char* inName)
+{
+	auto it = cmds.find(inName);
+	if (it == cmds.end())
+	{
+		return nullptr;
+	}
+	return it->second;
+}
+
+XPLMCommandRef XPLMCreateCommand(const char* inName, const char* inDescription)
+{
+	(void)inDescription;
+
+	XPLMCommandRef ref = XPLMFindCommand(inName);
+	if (ref != nullptr)
+	{
+		return ref;
+	}
+	fake_cmd* cmd = new fake_cmd{inName, 0};
+	cmds[inName] = cmd;
+	return cmd;
+}
+
+void XPLMCommandOnce(XPLMCommandRef inCommand)
+{
+	reinterpret_cast<fake_cmd*>(inCommand)->n_calls++;
+}
+
+// Flight loops:
+
+float XPLMGetElapsedTime(void)
+{
+	return float(sim_time);
+}
+
+int XPLMGetCycleNumber(void)
+{
+	return int(n_frames);
+}
+
+void XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, float inInterval,
+	void* inRefcon)
+{
+	fake_flt_loop* loop = add_flt_loop(inFlightLoop, inRefcon, true);
+	schedule(loop, double(inInterval), true);
+}
+
+void XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, void* inRefcon)
+{
+	for (size_t i = 0; i < flt_loops.size(); i++)
+	{
+		fake_flt_loop* loop = flt_loops[i];
+		if (loop->is_legacy && loop->callback == inFlightLoop && loop->refcon == inRefcon)
+		{
+			loop->is_destroyed = true;
+		}
+	}
+}
+
+void XPLMSetFlightLoopCallbackInterval(XPLMFlightLoop_f inFlightLoop, float inInterval,
+	int inRelativeToNow, void* inRefcon)
+{
+	for (size_t i = 0; i < flt_loops.size(); i++)
+	{
+		fake_flt_loop* loop = flt_loops[i];
+		if (loop->is_legacy && loop->callback == inFlightLoop && loop->refcon == inRefcon)
+		{
+			schedule(loop, double(inInterval), inRelativeToNow != 0);
+		}
+	}
+}
+
+XPLMFlightLoopID XPLMCreateFlightLoop(XPLMCreateFlightLoop_t* inParams)
+{
+	return add_flt_loop(inParams->callbackFunc, inParams->refcon, false);
+}
+
+void XPLMDestroyFlightLoop(XPLMFlightLoopID inFlightLoopID)
+{
+	reinterpret_cast<fake_flt_loop*>(inFlightLoopID)->is_destroyed = true;
+}
+
+void XPLMScheduleFlightLoop(XPLMFlightLoopID inFlightLoopID, float inInterval,
+	int inRelativeToNow)
+{
+	schedule(reinterpret_cast<fake_flt_loop*>(inFlightLoopID), double(inInterval),
+		inRelativeToNow != 0);
+}
+
+// Utilities:
+
+void XPLMDebugString(const char* inString)
+{
+	if (is_verbose)
+	{
+		fputs(inString, stderr);
+	}
+}
+
+void XPLMGetVersions(int* outXPlaneVersion, int* outXPLMVersion,
+	XPLMHostApplicationID* outHostID)
+{
+	*outXPlaneVersion = FAKE_XPLANE_VERSION;
+	*outXPLMVersion = FAKE_SDK_VERSION;
+	*outHostID = 1;
+}
+
+const char* XPLMGetDirectorySeparator(void)
+{
+	return "/";
+}
+
+void XPLMGetSystemPath(char* outSystemPath)
+{
+	strcpy(outSystemPath, system_path.c_str());
+}
+
+void XPLMGetPrefsPath(char* outPrefsPath)
+{
+	strcpy(outPrefsPath, (system_path + "Output/preferences/X-Plane.prf").c_str());
+}
+
+char* XPLMExtractFileAndPath(char* inFullPath)
+{
+	char* sep = strrchr(inFullPath, '/');
+	if (sep == nullptr)
+	{
+		return inFullPath;
+	}
+	*sep = 0;
+	return sep + 1;
+}
+
+int XPLMEnableFeature(const char* inFeature, int inEnable)
+{
+	(void)inFeature;
+	(void)inEnable;
+	return 1;
+}
+
+float XPLMGetMagneticVariation(double latitude, double longitude)
+{
+	if (mag_var_cost_us > 0)
+	{
+		spin_us(mag_var_cost_us);
+	}
+	if (mag_var_fn != nullptr)
+	{
+		return mag_var_fn(latitude, longitude);
+	}
+	return default_mag_var(latitude, longitude);
+}
+
+// Plugins:
+
+XPLMPluginID XPLMGetMyID(void)
+{
+	return FAKE_PLUGIN_ID;
+}
+
+XPLMPluginID XPLMFindPluginBySignature(const char* inSignature)
+{
+	// Only the plugin under test and the ones added by add_plugin exist
+	if (plugin_sign == inSignature)
+	{
+		return FAKE_PLUGIN_ID;
+	}
+	auto it = plugins.find(inSignature);
+	if (it != plugins.end())
+	{
+		return it->second;
+	}
+	return XPLM_NO_PLUGIN_ID;
+}
+
+void XPLMGetPluginInfo(XPLMPluginID inPlugin, char* outName, char* outFilePath,
+	char* outSignature, char* outDescription)
+{
+	(void)inPlugin;
+
+	if (outName != nullptr)
+	{
+		strcpy(outName, "777 FMS");
+	}
+	if (outFilePath != nullptr)
+	{
+		strcpy(outFilePath, (system_path + PLUGIN_FILE_NAME).c_str());
+	}
+	if (outSignature != nullptr)
+	{
+		strcpy(outSignature, plugin_sign.c_str());
+	}
+	if (outDescription != nullptr)
+	{
+		strcpy(outDescription, "");
+	}
+}
+
+void XPLMSendMessageToPlugin(XPLMPluginID inPlugin, int inMessage, void* inParam)
+{
+	(void)inMessage;
+	(void)inParam;
+
+	auto it = plugin_msgs.find(inPlugin);
+	if (it != plugin_msgs.end())
+	{
+		it->second++;
+	}
+}
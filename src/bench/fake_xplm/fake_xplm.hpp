@@ -0,0 +1,93 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains declarations of the control interface of a
+	headless stand-in for the XPLM library. It provides the XPLM functions
+	that are used by libxp and avionics_sys, so they can be run outside of
+	X-Plane. Datarefs live in an in-memory table, flight loops are called
+	from run_frame, which advances a test clock.
+	None of this is thread safe: all of the functions, including the XPLM ones,
+	must be called from the thread that plays the role of X-Plane's main thread.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include <XPLMDataAccess.h>
+#include <XPLMProcessing.h>
+#include <XPLMUtilities.h>
+#include <XPLMPlugin.h>
+#include <XPLMScenery.h>
+#include <string>
+#include <cstdint>
+
+
+namespace FakeXPLM
+{
+	constexpr int FAKE_XPLANE_VERSION = 12000;
+	constexpr int FAKE_SDK_VERSION = 400;
+	constexpr XPLMPluginID FAKE_PLUGIN_ID = 1;
+
+	typedef float (*mag_var_fn_t)(double lat_deg, double lon_deg);
+
+
+	/*
+		Sets the path that is returned by XPLMGetSystemPath. It should end with
+		a separator. Navigation data is loaded from there, just like in X-Plane.
+	*/
+
+	void set_system_path(std::string path);
+
+	// XPLMFindPluginBySignature only finds the plugin with this signature
+	void set_plugin_sign(std::string sign);
+
+	// Prints everything passed to XPLMDebugString to stderr if true
+	void set_verbose(bool verbose);
+
+	/*
+		Adds a dataref that is owned by the sim. n_length is the number of
+		array elements or bytes for array and data types.
+	*/
+
+	XPLMDataRef add_data_ref(std::string name, XPLMDataTypeID type, int n_length=1);
+
+	/*
+		Adds a plugin that can be found by XPLMFindPluginBySignature.
+		It does nothing but count the messages that are sent to it.
+	*/
+
+	XPLMPluginID add_plugin(std::string sign);
+
+	int get_n_msgs(XPLMPluginID plugin);
+
+	// Returns the number of flight loops that haven't been unregistered or destroyed
+	size_t get_n_flt_loops();
+
+	/*
+		Replaces the model used by XPLMGetMagneticVariation. The default
+		model is a smooth synthetic field, not the real one. cost_us is
+		spent busy waiting in every call to imitate the real function.
+	*/
+
+	void set_mag_var_model(mag_var_fn_t fn, double cost_us=0);
+
+	/*
+		Advances the test clock by dt_sec and runs all flight loops that are due.
+		Returns the number of flight loop callbacks that were called.
+	*/
+
+	int run_frame(double dt_sec);
+
+	double get_sim_time();
+
+	uint64_t get_n_frames();
+
+	int get_n_cmd_calls(std::string name);
+
+	// Removes all datarefs, commands, flight loops and added plugins
+	void reset();
+}
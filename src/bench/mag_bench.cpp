@@ -0,0 +1,300 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a benchmark of the World Magnetic Model evaluator.
+	It measures points per second on a single core, one point at a time and
+	in batches. The model is checked against the test values that NOAA
+	published with it. Values of WMM2015 and WMM2020 are built in. For newer
+	models, such as WMM2025, pass the test values file from the same archive
+	as WMM.COF. If a data bus traffic log is
+	passed, magnetic variation recorded from XPLMGetMagneticVariation is
+	compared against the model. The log has
+	to be recorded without WMM.COF in the plugin data folder, so that the data
+	bus asks X-plane. Exits with 1 if there are no test values, if any test 
+	value is off by more than WMM_TEST_TOLERANCE_DEG or any recorded point 
+	by more than MAG_MODEL_TOLERANCE_DEG. A model that the data bus would 
+	reject as out of date is still measured, but for its own epoch.
+	Usage: mag_bench cof_path [log_path] [n_points] [test_values_path]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "mag_model.hpp"
+#include "traffic_log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+constexpr int N_POINTS_DEFAULT = 1000000;
+constexpr int N_BENCH_RUNS = 3;
+// Batches may round differently if the compiler fuses multiply-adds
+constexpr double BATCH_DIFF_TOLERANCE_DEG = 1e-4;
+// Test values are published with 2 decimals
+constexpr double WMM_TEST_TOLERANCE_DEG = 0.01;
+/*
+	Columns of the test values file: date, height km, lat, lon, X, Y, Z, H, F, 
+	I, D and then the secular variation. Only the first 11 are used.
+*/
+constexpr int WMM_TEST_FILE_N_COLS = 11;
+constexpr int WMM_TEST_LINE_BUF_SIZE = 512;
+
+
+struct wmm_test_point
+{
+	const char* model_name; // As in the header of WMM.COF
+	double year, alt_km, lat, lon;
+	double mag_var_deg;
+};
+
+// Declination from the test values in the NOAA technical reports of WMM2015 and WMM2020
+const wmm_test_point WMM_TEST_POINTS[] = {
+	{"WMM-2015", 2015.0, 0, 80, 0, -3.85},
+	{"WMM-2015", 2015.0, 0, 0, 120, 0.57},
+	{"WMM-2015", 2015.0, 0, -80, 240, 69.81},
+	{"WMM-2015", 2015.0, 100, 80, 0, -4.27},
+	{"WMM-2015", 2015.0, 100, 0, 120, 0.56},
+	{"WMM-2015", 2015.0, 100, -80, 240, 69.22},
+	{"WMM-2015", 2017.5, 0, 80, 0, -2.75},
+	{"WMM-2015", 2017.5, 0, 0, 120, 0.32},
+	{"WMM-2015", 2017.5, 0, -80, 240, 69.58},
+	{"WMM-2015", 2017.5, 100, 80, 0, -3.17},
+	{"WMM-2015", 2017.5, 100, 0, 120, 0.32},
+	{"WMM-2015", 2017.5, 100, -80, 240, 69.00},
+	{"WMM-2020", 2020.0, 0, 80, 0, 1.28},
+	{"WMM-2020", 2020.0, 0, 0, 120, 0.16},
+	{"WMM-2020", 2020.0, 0, -80, 240, 69.36},
+	{"WMM-2020", 2020.0, 100, 80, 0, 1.70},
+	{"WMM-2020", 2020.0, 100, 0, 120, 0.16},
+	{"WMM-2020", 2020.0, 100, -80, 240, 68.78},
+	{"WMM-2020", 2022.5, 0, 80, 0, 10.30},
+	{"WMM-2020", 2022.5, 0, 0, 120, -0.06},
+	{"WMM-2020", 2022.5, 0, -80, 240, 69.13},
+	{"WMM-2020", 2022.5, 100, 80, 0, 10.92},
+	{"WMM-2020", 2022.5, 100, 0, 120, -0.05},
+	{"WMM-2020", 2022.5, 100, -80, 240, 68.55}
+};
+constexpr size_t N_WMM_TEST_POINTS = sizeof(WMM_TEST_POINTS) / sizeof(WMM_TEST_POINTS[0]);
+
+
+double get_points_per_sec(XPDataBus::MagModel* model, std::vector<XPDataBus::geo_point>* points,
+	std::vector<float>* out, bool is_batch, double year)
+{
+	double best_sec = 0;
+	for (int i = 0; i < N_BENCH_RUNS; i++)
+	{
+		auto t_start = std::chrono::steady_clock::now();
+		if (is_batch)
+		{
+			model->get_mag_var_batch(points->data(), out->data(), points->size(), 0, year);
+		}
+		else
+		{
+			for (size_t j = 0; j < points->size(); j++)
+			{
+				out->at(j) = model->get_mag_var(points->at(j).lat, points->at(j).lon, 0, year);
+			}
+		}
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+			t_start).count();
+		if (i == 0 || sec < best_sec)
+		{
+			best_sec = sec;
+		}
+	}
+	return double(points->size()) / best_sec;
+}
+
+// Reads the test values file published with the model. Returns false if it couldn't be read.
+bool read_test_points(const char* path, std::vector<wmm_test_point>* out)
+{
+	std::FILE* file = std::fopen(path, "r");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	char line[WMM_TEST_LINE_BUF_SIZE];
+	while (std::fgets(line, WMM_TEST_LINE_BUF_SIZE, file) != nullptr)
+	{
+		double v[WMM_TEST_FILE_N_COLS];
+		// Comments start with #
+		if (std::sscanf(line, "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf", &v[0], &v[1], 
+			&v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10]) != WMM_TEST_FILE_N_COLS)
+		{
+			continue;
+		}
+		out->push_back({ "", v[0], v[1], v[2], v[3], v[10] });
+	}
+	std::fclose(file);
+	return true;
+}
+
+// Returns false if there are no test points or the model is off by more than WMM_TEST_TOLERANCE_DEG
+bool check_test_points(XPDataBus::MagModel* model, const char* test_path)
+{
+	std::string name = model->get_name();
+	std::vector<wmm_test_point> pts;
+	if (test_path != nullptr && !read_test_points(test_path, &pts))
+	{
+		printf("Failed to open %s\n", test_path);
+		return false;
+	}
+	for (size_t i = 0; i < N_WMM_TEST_POINTS && test_path == nullptr; i++)
+	{
+		if (std::strcmp(WMM_TEST_POINTS[i].model_name, name.c_str()) == 0)
+		{
+			pts.push_back(WMM_TEST_POINTS[i]);
+		}
+	}
+
+	size_t n_checked = 0;
+	double max_err = 0;
+	bool is_ok = true;
+	for (size_t i = 0; i < pts.size(); i++)
+	{
+		const wmm_test_point* pt = &pts[i];
+		double mag_var = double(model->get_mag_var(pt->lat, pt->lon, pt->alt_km, pt->year));
+		double err = std::fabs(mag_var - pt->mag_var_deg);
+		if (err > WMM_TEST_TOLERANCE_DEG)
+		{
+			printf("Test point %.1f %.0f km %.0f %.0f: expected %.2f, got %.3f\n", pt->year, 
+				pt->alt_km, pt->lat, pt->lon, pt->mag_var_deg, mag_var);
+			is_ok = false;
+		}
+		max_err = std::max(max_err, err);
+		n_checked++;
+	}
+	if (n_checked == 0)
+	{
+		printf("No test values for %s. Pass the test values file published with it.\n", 
+			name.c_str());
+		return false;
+	}
+	printf("%zu test points, max error deg %.4f, tolerance %.2f\n", n_checked, max_err, 
+		WMM_TEST_TOLERANCE_DEG);
+	return is_ok;
+}
+
+// Returns false if the log couldn't be read or the model is out of tolerance
+bool check_log(XPDataBus::MagModel* model, const char* log_path, double year)
+{
+	XPDataBus::TrafficReader reader(log_path);
+	if (!reader.is_open())
+	{
+		printf("Failed to open %s\n", log_path);
+		return false;
+	}
+
+	std::vector<double> errs;
+	XPDataBus::traffic_rec rec;
+	while (reader.next(&rec))
+	{
+		if (rec.kind != XPDataBus::REC_MAG_VAR ||
+			std::fabs(rec.lat) > XPDataBus::MAG_MODEL_MAX_LAT_DEG)
+		{
+			continue;
+		}
+		double err = std::fabs(double(model->get_mag_var(rec.lat, rec.lon, 0, year)) -
+			double(rec.val.float_val));
+		errs.push_back(std::min(err, 360 - err));
+	}
+	if (errs.empty())
+	{
+		printf("No magnetic variation in %s\n", log_path);
+		return false;
+	}
+
+	double sum = 0;
+	for (size_t i = 0; i < errs.size(); i++)
+	{
+		sum += errs[i];
+	}
+	std::sort(errs.begin(), errs.end());
+	printf("%zu recorded points, error deg: mean %.3f p99 %.3f max %.3f, tolerance %.3f\n",
+		errs.size(), sum / double(errs.size()), errs[size_t(double(errs.size() - 1) * 0.99)],
+		errs.back(), XPDataBus::MAG_MODEL_TOLERANCE_DEG);
+	return errs.back() <= XPDataBus::MAG_MODEL_TOLERANCE_DEG;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: mag_bench cof_path [log_path] [n_points] [test_values_path]\n");
+		return 1;
+	}
+	int n_points = N_POINTS_DEFAULT;
+	if (argc > 3)
+	{
+		n_points = std::max(1, atoi(argv[3]));
+	}
+
+	const char* test_path = nullptr;
+	if (argc > 4)
+	{
+		test_path = argv[4];
+	}
+
+	XPDataBus::MagModel model;
+	double year = XPDataBus::get_decimal_year();
+	if (!model.load(argv[1], year))
+	{
+		if (model.get_epoch() == 0)
+		{
+			printf("Failed to load %s\n", argv[1]);
+			return 1;
+		}
+		printf("%s is more than %.0f years past its epoch, so the data bus won't use it\n",
+			model.get_name().c_str(), XPDataBus::MAG_MODEL_MAX_AGE_YEARS);
+		year = model.get_epoch();
+		model.load(argv[1], year);
+	}
+	printf("%s, epoch %.1f, evaluated for %.2f\n", model.get_name().c_str(), model.get_epoch(),
+		year);
+	if (!check_test_points(&model, test_path))
+	{
+		return 1;
+	}
+
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> lat_dist(-XPDataBus::MAG_MODEL_MAX_LAT_DEG,
+		XPDataBus::MAG_MODEL_MAX_LAT_DEG);
+	std::uniform_real_distribution<double> lon_dist(-180, 180);
+	std::vector<XPDataBus::geo_point> points(static_cast<size_t>(n_points));
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		points[i] = { lat_dist(gen), lon_dist(gen) };
+	}
+
+	std::vector<float> out_single(points.size());
+	std::vector<float> out_batch(points.size());
+	double pps_single = get_points_per_sec(&model, &points, &out_single, false, year);
+	double pps_batch = get_points_per_sec(&model, &points, &out_batch, true, year);
+	printf("%-10s %14s\n", "mode", "points/s");
+	printf("%-10s %14.0f\n", "single", pps_single);
+	printf("%-10s %14.0f\n", "batch", pps_batch);
+
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		if (std::fabs(out_single[i] - out_batch[i]) > BATCH_DIFF_TOLERANCE_DEG)
+		{
+			printf("Batch and single results differ at %f %f\n", points[i].lat, points[i].lon);
+			return 1;
+		}
+	}
+
+	if (argc > 2 && argv[2][0] != '\0' && !check_log(&model, argv[2], year))
+	{
+		return 1;
+	}
+	return 0;
+}
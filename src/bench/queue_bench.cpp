@@ -0,0 +1,183 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a stress benchmark for the data bus request queues.
+	It compares MPSCRing against the mutex protected std::queue that the data bus
+	used before. Several producer threads push requests while a single consumer
+	thread drains them, the same way worker threads and the flight loop do.
+	Usage: queue_bench [n_requests_per_producer]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "mpsc_ring.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+constexpr int N_REQ_DEFAULT = 200000;
+constexpr size_t RING_SIZE = 1024;
+constexpr int N_PRODUCERS[] = {4, 8, 12, 16};
+
+
+struct bench_req
+{
+	int64_t t_enq;
+	int producer;
+};
+
+struct bench_res
+{
+	double throughput; // Requests per second
+	std::vector<int64_t> push_lat; // Time spent inside push, ns
+	std::vector<int64_t> e2e_lat; // Time from push to pop, ns
+};
+
+
+/*
+	Same locking as the old data bus queues: one lock per push and
+	one lock per popped element.
+*/
+
+template <class T>
+class MutexQueue
+{
+public:
+	MutexQueue(size_t cap)
+	{
+		(void)cap;
+	}
+
+	void push(T val)
+	{
+		std::lock_guard<std::mutex> lock(q_mutex);
+		q.push(val);
+	}
+
+	bool pop(T* out)
+	{
+		std::lock_guard<std::mutex> lock(q_mutex);
+		if (q.empty())
+		{
+			return false;
+		}
+		*out = q.front();
+		q.pop();
+		return true;
+	}
+
+private:
+	std::queue<T> q;
+	std::mutex q_mutex;
+};
+
+
+inline int64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <class Q>
+bench_res run_bench(int n_prod, int n_req)
+{
+	Q queue(RING_SIZE);
+	size_t n_total = size_t(n_prod) * size_t(n_req);
+	bench_res res;
+	res.push_lat.assign(n_total, 0);
+	res.e2e_lat.assign(n_total, 0);
+
+	std::vector<std::thread> producers;
+	int64_t t_start = now_ns();
+
+	for (int i = 0; i < n_prod; i++)
+	{
+		producers.push_back(std::thread([&queue, &res, i, n_req]()
+			{
+				int64_t* lat = &res.push_lat[size_t(i) * size_t(n_req)];
+				for (int j = 0; j < n_req; j++)
+				{
+					int64_t t1 = now_ns();
+					queue.push(bench_req{ t1, i });
+					lat[j] = now_ns() - t1;
+				}
+			}));
+	}
+
+	size_t n_popped = 0;
+	bench_req req;
+	while (n_popped < n_total)
+	{
+		if (queue.pop(&req))
+		{
+			res.e2e_lat[n_popped] = now_ns() - req.t_enq;
+			n_popped++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	int64_t t_end = now_ns();
+	for (size_t i = 0; i < producers.size(); i++)
+	{
+		producers[i].join();
+	}
+
+	res.throughput = double(n_total) / (double(t_end - t_start) * 1e-9);
+	return res;
+}
+
+int64_t get_pct(std::vector<int64_t>* sorted, double pct)
+{
+	size_t idx = size_t(pct / 100.0 * double(sorted->size() - 1));
+	return sorted->at(idx);
+}
+
+void print_res(const char* name, int n_prod, bench_res* res)
+{
+	std::sort(res->push_lat.begin(), res->push_lat.end());
+	std::sort(res->e2e_lat.begin(), res->e2e_lat.end());
+	printf("%-12s %3d %12.0f %9lld %9lld %9lld %11lld %11lld\n", name, n_prod,
+		res->throughput,
+		(long long)get_pct(&res->push_lat, 50),
+		(long long)get_pct(&res->push_lat, 99),
+		(long long)get_pct(&res->push_lat, 99.9),
+		(long long)res->push_lat.back(),
+		(long long)get_pct(&res->e2e_lat, 99));
+}
+
+
+int main(int argc, char** argv)
+{
+	int n_req = N_REQ_DEFAULT;
+	if (argc > 1)
+	{
+		n_req = std::max(1, atoi(argv[1]));
+	}
+
+	printf("%d requests per producer, ring size %zu\n", n_req, RING_SIZE);
+	printf("%-12s %3s %12s %9s %9s %9s %11s %11s\n", "queue", "thr", "req/s",
+		"push p50", "push p99", "push p999", "push max", "e2e p99");
+	printf("(latencies in ns)\n");
+
+	for (int n_prod : N_PRODUCERS)
+	{
+		bench_res res_mtx = run_bench<MutexQueue<bench_req>>(n_prod, n_req);
+		print_res("mutex_queue", n_prod, &res_mtx);
+		bench_res res_ring = run_bench<XPDataBus::MPSCRing<bench_req>>(n_prod, n_req);
+		print_res("mpsc_ring", n_prod, &res_ring);
+	}
+
+	return 0;
+}
@@ -0,0 +1,375 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a tool that replays a data bus traffic log, which
+	is recorded by the plugin if the plugin data folder has a file called record_traffic.
+	It runs DataBus, AvionicsSys and both FMCs against the fake XPLM library, just
+	like sim_bench. Sim datarefs get created with the types and lengths from the log.
+	Before every frame, the values that were read from the sim during that frame
+	are written back to the fake datarefs. So are reads of plugin datarefs that
+	returned something other than what the plugin last wrote to them, which is
+	how CDU inputs and other writes from outside of the plugin show up.
+	Magnetic variation is answered from the recorded results. Frames are run at speed times the recorded
+	rate, as fast as possible if speed is 0. Frame cost and data bus statistics
+	are reported at the end, so that flights can be used as regression benchmarks.
+	Navigation data is loaded from the X-Plane installation at xplane_path.
+	Usage: replay xplane_path log_path [speed]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "sim_utils.hpp"
+#include "traffic_log.hpp"
+#include "777_dr_init.hpp"
+#include "777_dr_decl.hpp"
+#include <libnav/geo_utils.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+
+constexpr double SPEED_DEFAULT = 4;
+constexpr double LOAD_FRAME_HZ = 60;
+constexpr double POI_CACHE_TILE_SIZE_RAD = 5.0 * geo::DEG_TO_RAD;
+constexpr int N_FMC_REFRESH_HZ = 20;
+const char* PLUGIN_SIGN = "stratosphere.systems.fmsplugin";
+
+
+custom_dr_registry_t custom_drs;
+
+std::vector<XPDataBus::cmd_entry> cmd_entries;
+std::vector<XPDataBus::custom_data_ref_entry> data_refs;
+
+
+struct log_dr_t
+{
+	std::string name;
+	int dr_type, n_length;
+	bool is_custom;
+	XPLMDataRef ref; // Dataref with the same name in the fake XPLM
+};
+
+struct log_info_t
+{
+	std::unordered_map<XPDataBus::dr_handle_t, log_dr_t> drs;
+	std::map<std::pair<double, double>, float> mag_vars;
+	uint64_t n_frames, n_recs;
+	int64_t t_total_ns;
+};
+
+
+log_info_t log_info;
+uint64_t n_mag_var_misses = 0;
+// Last known values of plugin datarefs, keyed by log handle and offset
+std::map<std::pair<XPDataBus::dr_handle_t, int>, XPDataBus::generic_val> custom_vals;
+
+
+float replay_mag_var(double lat_deg, double lon_deg)
+{
+	auto it = log_info.mag_vars.find(std::make_pair(lat_deg, lon_deg));
+	if (it != log_info.mag_vars.end())
+	{
+		return it->second;
+	}
+	n_mag_var_misses++;
+	return 0;
+}
+
+// Reads the whole log once to find out which datarefs it uses
+bool scan_log(std::string path)
+{
+	XPDataBus::TrafficReader reader(path);
+	if (!reader.is_open())
+	{
+		return false;
+	}
+
+	log_info.n_frames = 0;
+	log_info.n_recs = 0;
+	log_info.t_total_ns = 0;
+	XPDataBus::traffic_rec rec;
+	while (reader.next(&rec))
+	{
+		log_info.n_recs++;
+		log_info.t_total_ns = std::max(log_info.t_total_ns, rec.t_ns);
+		if (rec.kind == XPDataBus::REC_DR_NAME)
+		{
+			log_info.drs[rec.dref] = { rec.val.str.to_string(), rec.val.val_type, rec.n_length,
+				rec.is_custom, nullptr };
+		}
+		else if (rec.kind == XPDataBus::REC_MAG_VAR)
+		{
+			log_info.mag_vars[std::make_pair(rec.lat, rec.lon)] = rec.val.float_val;
+		}
+		else if (rec.kind == XPDataBus::REC_FRAME)
+		{
+			log_info.n_frames++;
+		}
+	}
+	return true;
+}
+
+void add_sim_data_refs()
+{
+	for (auto& it : log_info.drs)
+	{
+		log_dr_t* dr = &it.second;
+		// Datarefs that weren't found during the recording have no type
+		if (!dr->is_custom && dr->dr_type != xplmType_Unknown)
+		{
+			FakeXPLM::add_data_ref(dr->name, dr->dr_type, std::max(dr->n_length, 1));
+		}
+	}
+}
+
+void find_data_refs()
+{
+	for (auto& it : log_info.drs)
+	{
+		it.second.ref = XPLMFindDataRef(it.second.name.c_str());
+	}
+}
+
+bool is_same_val(XPDataBus::generic_val* v1, XPDataBus::generic_val* v2)
+{
+	return v1->val_type == v2->val_type && 
+		XPDataBus::get_gen_val_d(v1) == XPDataBus::get_gen_val_d(v2) &&
+		v1->str.length() == v2->str.length() && 
+		memcmp(v1->str.c_str(), v2->str.c_str(), v1->str.length()) == 0;
+}
+
+// Returns true if the value was written to the fake XPLM
+bool apply_rec(XPDataBus::traffic_rec* rec)
+{
+	if ((rec->kind != XPDataBus::REC_GET && rec->kind != XPDataBus::REC_SET) || 
+		(rec->kind == XPDataBus::REC_GET && rec->val.offset < 0))
+	{
+		return false;
+	}
+	auto it = log_info.drs.find(rec->dref);
+	if (it == log_info.drs.end() || it->second.ref == nullptr)
+	{
+		return false;
+	}
+
+	/*
+		Values of plugin datarefs are only written if they differ from the
+		last known one. Sets to scalars use offset -1, reads use 0.
+	*/
+
+	if (it->second.is_custom)
+	{
+		std::pair<XPDataBus::dr_handle_t, int> key(rec->dref, std::max(rec->val.offset, 0));
+		auto last = custom_vals.find(key);
+		bool is_known = last != custom_vals.end() && is_same_val(&last->second, &rec->val);
+		custom_vals[key] = rec->val;
+		if (rec->kind == XPDataBus::REC_SET || is_known)
+		{
+			return false;
+		}
+	}
+	else if (rec->kind == XPDataBus::REC_SET)
+	{
+		return false;
+	}
+
+	XPLMDataRef ref = it->second.ref;
+	XPLMDataTypeID dr_type = XPLMGetDataRefTypes(ref);
+	XPDataBus::generic_val* val = &rec->val;
+	if (xplmType_IntArray & dr_type)
+	{
+		int tmp = XPDataBus::get_gen_val_i(val);
+		XPLMSetDatavi(ref, &tmp, val->offset, 1);
+	}
+	else if (xplmType_FloatArray & dr_type)
+	{
+		float tmp = XPDataBus::get_gen_val_f(val);
+		XPLMSetDatavf(ref, &tmp, val->offset, 1);
+	}
+	else if (xplmType_Data & dr_type)
+	{
+		// The terminating null clears the rest of a longer previous value
+		XPLMSetDatab(ref, (void*)val->str.c_str(), val->offset, int(val->str.length()) + 1);
+	}
+
+	if (xplmType_Int & dr_type)
+	{
+		XPLMSetDatai(ref, XPDataBus::get_gen_val_i(val));
+	}
+	if (xplmType_Float & dr_type)
+	{
+		XPLMSetDataf(ref, XPDataBus::get_gen_val_f(val));
+	}
+	if (xplmType_Double & dr_type)
+	{
+		XPLMSetDatad(ref, XPDataBus::get_gen_val_d(val));
+	}
+	return true;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printf("Usage: %s xplane_path log_path [speed]\n", argv[0]);
+		return 1;
+	}
+
+	std::string xplane_path = argv[1];
+	if (xplane_path.back() != '/')
+	{
+		xplane_path.push_back('/');
+	}
+	std::string log_path = argv[2];
+	double speed = SPEED_DEFAULT;
+	if (argc > 3)
+	{
+		speed = std::max(0.0, atof(argv[3]));
+	}
+
+	if (!scan_log(log_path))
+	{
+		printf("Failed to open traffic log %s\n", log_path.c_str());
+		return 1;
+	}
+	if (log_info.n_frames == 0)
+	{
+		printf("No frames in %s\n", log_path.c_str());
+		return 1;
+	}
+	printf("%llu records, %llu frames, %.1f s recorded\n", (unsigned long long)log_info.n_recs,
+		(unsigned long long)log_info.n_frames, double(log_info.t_total_ns) * 1e-9);
+
+	FakeXPLM::set_system_path(xplane_path);
+	FakeXPLM::set_plugin_sign(PLUGIN_SIGN);
+	if (log_info.mag_vars.size())
+	{
+		FakeXPLM::set_mag_var_model(replay_mag_var);
+	}
+	add_sim_data_refs();
+
+	if (!fmc_dr::register_data_refs(&cmd_entries, &data_refs, &custom_cmds, &custom_drs))
+	{
+		printf("Failed to register datarefs\n");
+		return 1;
+	}
+	find_data_refs();
+
+	/*
+		Same order as FMS_init_FLCB, but without publish_stats, the input filter
+		and the PFD.
+	*/
+	std::shared_ptr<XPDataBus::DataBus> databus = std::make_shared<XPDataBus::DataBus>(
+		&cmd_entries, &data_refs, DATABUS_FRAME_BUDGET_US, PLUGIN_SIGN);
+	databus->begin_dr_report();
+	custom_drs.bind(databus.get());
+	std::shared_ptr<StratosphereAvionics::AvionicsSys> avionics =
+		std::make_shared<StratosphereAvionics::AvionicsSys>(databus, av_in, av_out,
+			POI_CACHE_TILE_SIZE_RAD, N_FMC_REFRESH_HZ);
+	std::shared_ptr<StratosphereAvionics::FMC> fmc_l =
+		std::make_shared<StratosphereAvionics::FMC>(avionics, fmc_l_in, fmc_l_out,
+			N_FMC_REFRESH_HZ);
+	std::shared_ptr<StratosphereAvionics::FMC> fmc_r =
+		std::make_shared<StratosphereAvionics::FMC>(avionics, fmc_r_in, fmc_r_out,
+			N_FMC_REFRESH_HZ);
+	databus->end_dr_report();
+
+	// Same channels as in FMS_init_FLCB
+	std::thread avionics_thread([databus, avionics]()
+		{
+			databus->reg_producer("Avionics");
+			avionics->main_loop();
+		});
+	std::thread fmc_l_thread([databus, fmc_l]()
+		{
+			databus->reg_producer("FMC L");
+			fmc_l->main_loop();
+		});
+	std::thread fmc_r_thread([databus, fmc_r]()
+		{
+			databus->reg_producer("FMC R");
+			fmc_r->main_loop();
+		});
+
+	XPDataBus::TrafficReader reader(log_path);
+	XPDataBus::traffic_rec rec;
+	uint64_t n_applied = 0;
+	bool has_rec = reader.next(&rec);
+	// Values that were read before the first frame
+	while (has_rec && rec.kind != XPDataBus::REC_FRAME)
+	{
+		n_applied += uint64_t(apply_rec(&rec));
+		has_rec = reader.next(&rec);
+	}
+
+	wait_for_nav_data(1.0 / LOAD_FRAME_HZ, xplane_path, 
+		&custom_drs.get<&custom_dr::UI_MESSAGES_CREATING_DATABASES>());
+
+	std::vector<double> frame_us;
+	frame_us.reserve(size_t(log_info.n_frames));
+	int64_t t_first_ns = rec.t_ns;
+	int64_t t_prev_ns = rec.t_ns;
+	auto replay_start = std::chrono::steady_clock::now();
+	while (has_rec)
+	{
+		/*
+			rec is a frame record. Everything up to the next one was
+			read while that frame was running.
+		*/
+
+		int64_t t_frame_ns = rec.t_ns;
+		has_rec = reader.next(&rec);
+		while (has_rec && rec.kind != XPDataBus::REC_FRAME)
+		{
+			n_applied += uint64_t(apply_rec(&rec));
+			has_rec = reader.next(&rec);
+		}
+
+		if (speed > 0)
+		{
+			std::this_thread::sleep_until(replay_start +
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(double(t_frame_ns - t_first_ns) * 1e-9 / speed)));
+		}
+
+		auto t1 = std::chrono::steady_clock::now();
+		FakeXPLM::run_frame(double(t_frame_ns - t_prev_ns) * 1e-9);
+		auto t2 = std::chrono::steady_clock::now();
+		frame_us.push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+		t_prev_ns = t_frame_ns;
+	}
+	double replay_sec = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - replay_start).count();
+
+	// Same order as XPluginStop
+	fmc_l->sim_shutdown.store(true, StratosphereAvionics::UPDATE_FLG_ORDR);
+	fmc_r->sim_shutdown.store(true, StratosphereAvionics::UPDATE_FLG_ORDR);
+	avionics->sim_shutdown.store(true, StratosphereAvionics::UPDATE_FLG_ORDR);
+	databus->cleanup();
+	fmc_l_thread.join();
+	fmc_r_thread.join();
+	avionics_thread.join();
+	fmc_dr::unregister_data_refs(&custom_drs);
+	data_refs.clear();
+	fmc_l->disable();
+	fmc_r->disable();
+	avionics->disable();
+	databus->disable();
+
+	double log_sec = double(t_prev_ns - t_first_ns) * 1e-9;
+	printf("%zu frames replayed in %.2f s, %.1f times the recorded rate\n", frame_us.size(),
+		replay_sec, replay_sec > 0 ? log_sec / replay_sec : 0);
+	printf("%llu values written to the sim, %llu magnetic variation misses, %llu sets dropped\n",
+		(unsigned long long)n_applied, (unsigned long long)n_mag_var_misses,
+		(unsigned long long)databus->get_n_sets_dropped());
+	printf("%-24s %10s %10s %10s %10s\n", "us", "mean", "p50", "p99", "max");
+	print_stats("frame cost", get_stats(&frame_us));
+	print_databus_stats(databus);
+
+	return 0;
+}
@@ -0,0 +1,435 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a benchmark of the data bus under the load of
+	the real avionics. It runs DataBus, AvionicsSys and both FMCs against the
+	fake XPLM library. The main thread plays the role of X-Plane: it moves the
+	aircraft, changes FMC inputs and runs flight loops at an accelerated rate.
+	Frame cost is the time spent in flight loops per frame. Request latency is
+	measured by a probe thread that makes blocking reads through the data bus.
+	Set latency and queue depth are reported for each priority lane,
+	request counts and wait times for each producer channel.
+	Before the run, it checks that set requests reach the sim in order and
+	that the read-through cache reads through the data bus only when it has to.
+	Navigation data is loaded from the X-Plane installation at xplane_path.
+	Usage: sim_bench xplane_path [n_frames] [frame_hz]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "sim_utils.hpp"
+#include "rt_cache.hpp"
+#include "777_dr_init.hpp"
+#include "777_dr_decl.hpp"
+#include <libnav/geo_utils.hpp>
+#include <atomic>
+#include <cstdlib>
+
+
+constexpr int N_FRAMES_DEFAULT = 12000;
+constexpr double FRAME_HZ_DEFAULT = 240; // 4 times X-Plane's usual frame rate
+constexpr double POI_CACHE_TILE_SIZE_RAD = 5.0 * geo::DEG_TO_RAD;
+constexpr int N_FMC_REFRESH_HZ = 20;
+constexpr int N_NAV_RADIOS = 6;
+constexpr int NAV_ID_LENGTH = 150;
+constexpr int N_PROBE_PAUSE_US = 200;
+// The left FMC gets a new REF NAV DATA entry this often
+constexpr int N_ICAO_CHANGE_FRAMES = 120;
+constexpr double AC_SPEED_DEG_SEC = 0.002; // Roughly 480 knots
+constexpr double AC_START_LAT = 47.45;
+constexpr double AC_START_LON = -122.31;
+constexpr double AC_ALT_FT = 10000;
+const char* PLUGIN_SIGN = "stratosphere.systems.fmsplugin";
+const char* ORDER_CHECK_DR = "sim_bench/order_check";
+constexpr int ORDER_CHECK_LENGTH = 4;
+constexpr int ORDER_CHECK_IDX = 1;
+constexpr int ORDER_CHECK_MAX_FRAMES = 100;
+const char* RT_CHECK_DR = "sim_bench/rt_cache_check";
+constexpr double RT_CHECK_FRESH_AGE_SEC = 3600;
+constexpr double RT_CHECK_STALE_AGE_SEC = 0.01;
+constexpr int RT_CHECK_N_FRESH_READS = 10;
+const char* ICAO_ENTRIES[] = {"KSEA", "KPDX", "KBFI", "KPAE", "CYVR"};
+constexpr size_t N_ICAO_ENTRIES = sizeof(ICAO_ENTRIES) / sizeof(ICAO_ENTRIES[0]);
+
+
+custom_dr_registry_t custom_drs;
+
+std::vector<XPDataBus::cmd_entry> cmd_entries;
+std::vector<XPDataBus::custom_data_ref_entry> data_refs;
+
+
+struct sim_drs
+{
+	XPLMDataRef alt_ft[3], lat_deg, lon_deg, nav_freq, nav_bearing, nav_dme;
+	XPLMDataRef nav_ids[StratosphereAvionics::N_VHF_NAV_RADIOS];
+	XPLMDataRef dme_ids[StratosphereAvionics::N_VHF_NAV_RADIOS];
+};
+
+sim_drs add_sim_data_refs()
+{
+	/*
+		Adds the sim datarefs that are used by the avionics. Names are
+		taken from av_in so that the two never diverge.
+	*/
+
+	sim_drs out;
+	out.alt_ft[0] = FakeXPLM::add_data_ref(av_in.sim_baro_alt_ft1, xplmType_Float);
+	out.alt_ft[1] = FakeXPLM::add_data_ref(av_in.sim_baro_alt_ft2, xplmType_Float);
+	out.alt_ft[2] = FakeXPLM::add_data_ref(av_in.sim_baro_alt_ft3, xplmType_Float);
+	out.lat_deg = FakeXPLM::add_data_ref(av_in.sim_ac_lat_deg, xplmType_Double);
+	out.lon_deg = FakeXPLM::add_data_ref(av_in.sim_ac_lon_deg, xplmType_Double);
+
+	StratosphereAvionics::radio_drs_t* radio_0 = &av_in.nav_tuner.sim_radio_drs[0];
+	out.nav_freq = FakeXPLM::add_data_ref(radio_0->freq, xplmType_IntArray, N_NAV_RADIOS);
+	out.nav_bearing = FakeXPLM::add_data_ref(radio_0->vor_deg, xplmType_FloatArray,
+		N_NAV_RADIOS);
+	out.nav_dme = FakeXPLM::add_data_ref(radio_0->dme_nm, xplmType_FloatArray, N_NAV_RADIOS);
+	for (size_t i = 0; i < StratosphereAvionics::N_VHF_NAV_RADIOS; i++)
+	{
+		StratosphereAvionics::radio_drs_t* radio = &av_in.nav_tuner.sim_radio_drs[i];
+		out.nav_ids[i] = FakeXPLM::add_data_ref(radio->nav_id, xplmType_Data, NAV_ID_LENGTH);
+		out.dme_ids[i] = FakeXPLM::add_data_ref(radio->dme_id, xplmType_Data, NAV_ID_LENGTH);
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		XPLMSetDataf(out.alt_ft[i], float(AC_ALT_FT));
+	}
+	XPLMSetDatad(out.lat_deg, AC_START_LAT);
+	XPLMSetDatad(out.lon_deg, AC_START_LON);
+
+	return out;
+}
+
+void set_str(const char* dr_name, const char* val)
+{
+	XPLMDataRef dr = XPLMFindDataRef(dr_name);
+	XPLMSetDatab(dr, (void*)val, 0, int(strlen(val)));
+}
+
+bool check_set_order(std::shared_ptr<XPDataBus::DataBus> databus, double frame_dt)
+{
+	/*
+		Queues an element write, a slice that covers the same element and
+		another element write back to back. The sim has to see them in that
+		order, so the last element write must win. Has to be called once the
+		data bus flight loop is running.
+	*/
+
+	XPLMDataRef sim_dr = FakeXPLM::add_data_ref(ORDER_CHECK_DR, xplmType_IntArray,
+		ORDER_CHECK_LENGTH);
+	XPDataBus::dr_handle_t dr = databus->reg_data_ref(ORDER_CHECK_DR);
+
+	databus->set_datai(dr, 1, ORDER_CHECK_IDX);
+	databus->set_datavi(dr, std::vector<int>(ORDER_CHECK_LENGTH, 2), 0);
+	databus->set_datai(dr, 3, ORDER_CHECK_IDX);
+
+	int out[ORDER_CHECK_LENGTH] = {};
+	for (int i = 0; i < ORDER_CHECK_MAX_FRAMES && out[0] == 0; i++)
+	{
+		FakeXPLM::run_frame(frame_dt);
+		XPLMGetDatavi(sim_dr, out, 0, ORDER_CHECK_LENGTH);
+	}
+	for (int i = 0; i < ORDER_CHECK_LENGTH; i++)
+	{
+		int expected = i == ORDER_CHECK_IDX ? 3 : 2;
+		if (out[i] != expected)
+		{
+			printf("Set order check failed: element %d is %d, expected %d\n", i, out[i],
+				expected);
+			return false;
+		}
+	}
+	return true;
+}
+
+struct rt_check_state
+{
+	XPDataBus::ReadThroughCache* cache;
+	XPDataBus::dr_handle_t dr;
+	bool is_invalidating; // The next read from the sim invalidates the cache entry
+	int val;
+};
+
+int rt_check_get_cb(void* refcon)
+{
+	rt_check_state* state = reinterpret_cast<rt_check_state*>(refcon);
+	if (state->is_invalidating)
+	{
+		state->cache->invalidate(state->dr);
+		state->is_invalidating = false;
+	}
+	return state->val;
+}
+
+int rt_check_read(rt_check_state* state, double frame_dt)
+{
+	/*
+		Reads through the cache from another thread, since a refresh waits
+		for the data bus flight loop.
+	*/
+
+	std::atomic<bool> done(false);
+	int out = 0;
+	std::thread reader([state, &done, &out]()
+		{
+			out = state->cache->get_val_i(state->dr);
+			done.store(true);
+		});
+	while (!done.load())
+	{
+		FakeXPLM::run_frame(frame_dt);
+	}
+	reader.join();
+	return out;
+}
+
+bool check_rt_reads(rt_check_state* state, const char* name, uint64_t n_refreshes)
+{
+	XPDataBus::rt_cache_stats st = state->cache->get_stats();
+	if (st.n_refreshes != n_refreshes || st.n_drs_refreshed != n_refreshes)
+	{
+		printf("Read-through cache check failed: %s made %llu bus reads, expected %llu\n", name,
+			(unsigned long long)st.n_refreshes, (unsigned long long)n_refreshes);
+		return false;
+	}
+	return true;
+}
+
+bool check_rt_cache(std::shared_ptr<XPDataBus::DataBus> databus, double frame_dt)
+{
+	/*
+		Counts the reads that the read-through cache makes through the data bus:
+		fresh reads make none, a stale read makes one and so does the read after
+		an entry has been invalidated while it was being refreshed. Every case
+		uses its own cache, so refreshes of one don't count towards another.
+		Has to be called once the data bus flight loop is running.
+	*/
+
+	rt_check_state state = { nullptr, XPDataBus::INVALID_DR_HANDLE, false, 1 };
+	XPLMRegisterDataAccessor(RT_CHECK_DR, xplmType_Int, 0, rt_check_get_cb, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		&state, nullptr);
+	state.dr = databus->reg_data_ref(RT_CHECK_DR);
+
+	XPDataBus::ReadThroughCache fresh(databus);
+	state.cache = &fresh;
+	fresh.bind(state.dr, RT_CHECK_FRESH_AGE_SEC);
+	for (int i = 0; i < RT_CHECK_N_FRESH_READS; i++)
+	{
+		rt_check_read(&state, frame_dt);
+	}
+	if (!check_rt_reads(&state, "fresh reads", 1))
+	{
+		return false;
+	}
+
+	XPDataBus::ReadThroughCache stale(databus);
+	state.cache = &stale;
+	stale.bind(state.dr, RT_CHECK_STALE_AGE_SEC);
+	rt_check_read(&state, frame_dt);
+	std::this_thread::sleep_for(std::chrono::duration<double>(RT_CHECK_STALE_AGE_SEC * 2));
+	rt_check_read(&state, frame_dt);
+	if (!check_rt_reads(&state, "stale reads", 2))
+	{
+		return false;
+	}
+
+	XPDataBus::ReadThroughCache invalidated(databus);
+	state.cache = &invalidated;
+	invalidated.bind(state.dr, RT_CHECK_FRESH_AGE_SEC);
+	state.is_invalidating = true;
+	rt_check_read(&state, frame_dt);
+	state.val = 2;
+	int val = rt_check_read(&state, frame_dt);
+	rt_check_read(&state, frame_dt);
+	if (!check_rt_reads(&state, "reads invalidated during a refresh", 2))
+	{
+		return false;
+	}
+	if (val != state.val)
+	{
+		printf("Read-through cache check failed: read %d after invalidation, expected %d\n",
+			val, state.val);
+		return false;
+	}
+
+	XPLMUnregisterDataAccessor(XPLMFindDataRef(RT_CHECK_DR));
+	return true;
+}
+
+void probe_main(std::shared_ptr<XPDataBus::DataBus> databus, XPDataBus::dr_handle_t dr,
+	std::atomic<bool>* stop, std::atomic<bool>* done, std::vector<double>* lat_us)
+{
+	databus->reg_producer("Probe");
+	while (!stop->load(std::memory_order_relaxed))
+	{
+		auto t1 = std::chrono::steady_clock::now();
+		databus->get_datai(dr);
+		auto t2 = std::chrono::steady_clock::now();
+		lat_us->push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+
+		std::this_thread::sleep_for(std::chrono::microseconds(N_PROBE_PAUSE_US));
+	}
+	done->store(true);
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: %s xplane_path [n_frames] [frame_hz]\n", argv[0]);
+		return 1;
+	}
+
+	std::string xplane_path = argv[1];
+	if (xplane_path.back() != '/')
+	{
+		xplane_path.push_back('/');
+	}
+	int n_frames = N_FRAMES_DEFAULT;
+	double frame_hz = FRAME_HZ_DEFAULT;
+	if (argc > 2)
+	{
+		n_frames = std::max(1, atoi(argv[2]));
+	}
+	if (argc > 3)
+	{
+		frame_hz = std::max(1.0, atof(argv[3]));
+	}
+	double frame_dt = 1.0 / frame_hz;
+
+	FakeXPLM::set_system_path(xplane_path);
+	FakeXPLM::set_plugin_sign(PLUGIN_SIGN);
+	sim_drs sim = add_sim_data_refs();
+
+	if (!fmc_dr::register_data_refs(&cmd_entries, &data_refs, &custom_cmds, &custom_drs))
+	{
+		printf("Failed to register datarefs\n");
+		return 1;
+	}
+
+	/*
+		Same order as FMS_init_FLCB, but without publish_stats, the input filter
+		and the PFD.
+	*/
+	std::shared_ptr<XPDataBus::DataBus> databus = std::make_shared<XPDataBus::DataBus>(
+		&cmd_entries, &data_refs, DATABUS_FRAME_BUDGET_US, PLUGIN_SIGN);
+	databus->begin_dr_report();
+	custom_drs.bind(databus.get());
+	std::shared_ptr<StratosphereAvionics::AvionicsSys> avionics =
+		std::make_shared<StratosphereAvionics::AvionicsSys>(databus, av_in, av_out,
+			POI_CACHE_TILE_SIZE_RAD, N_FMC_REFRESH_HZ);
+	std::shared_ptr<StratosphereAvionics::FMC> fmc_l =
+		std::make_shared<StratosphereAvionics::FMC>(avionics, fmc_l_in, fmc_l_out,
+			N_FMC_REFRESH_HZ);
+	std::shared_ptr<StratosphereAvionics::FMC> fmc_r =
+		std::make_shared<StratosphereAvionics::FMC>(avionics, fmc_r_in, fmc_r_out,
+			N_FMC_REFRESH_HZ);
+	databus->end_dr_report();
+	XPDataBus::dr_handle_t probe_dr = custom_drs.get_hdl<&custom_dr::FMC_R_PAGE>();
+
+	custom_drs.get<&custom_dr::FMC_L_PAGE>().set(
+		int(StratosphereAvionics::fmc_pages::PAGE_REF_NAV_DATA));
+	custom_drs.get<&custom_dr::FMC_R_PAGE>().set(
+		int(StratosphereAvionics::fmc_pages::PAGE_RTE1));
+
+	// Same channels as in FMS_init_FLCB
+	std::thread avionics_thread([databus, avionics]()
+		{
+			databus->reg_producer("Avionics");
+			avionics->main_loop();
+		});
+	std::thread fmc_l_thread([databus, fmc_l]()
+		{
+			databus->reg_producer("FMC L");
+			fmc_l->main_loop();
+		});
+	std::thread fmc_r_thread([databus, fmc_r]()
+		{
+			databus->reg_producer("FMC R");
+			fmc_r->main_loop();
+		});
+
+	wait_for_nav_data(frame_dt, xplane_path, 
+		&custom_drs.get<&custom_dr::UI_MESSAGES_CREATING_DATABASES>());
+	if (!check_set_order(databus, frame_dt) || !check_rt_cache(databus, frame_dt))
+	{
+		return 1;
+	}
+
+	std::atomic<bool> probe_stop(false);
+	std::atomic<bool> probe_done(false);
+	std::vector<double> probe_lat_us;
+	probe_lat_us.reserve(size_t(n_frames) * 4);
+	std::thread probe_thread(probe_main, databus, probe_dr, &probe_stop, &probe_done,
+		&probe_lat_us);
+
+	std::vector<double> frame_us(size_t(n_frames), 0);
+	double lat = AC_START_LAT;
+	double lon = AC_START_LON;
+	auto bench_start = std::chrono::steady_clock::now();
+	auto next_frame = bench_start;
+	for (int i = 0; i < n_frames; i++)
+	{
+		lat += AC_SPEED_DEG_SEC * frame_dt;
+		lon += AC_SPEED_DEG_SEC * frame_dt;
+		XPLMSetDatad(sim.lat_deg, lat);
+		XPLMSetDatad(sim.lon_deg, lon);
+		if (i % N_ICAO_CHANGE_FRAMES == 0)
+		{
+			set_str(fmc_l_in.ref_nav.poi_id.c_str(),
+				ICAO_ENTRIES[size_t(i / N_ICAO_CHANGE_FRAMES) % N_ICAO_ENTRIES]);
+		}
+
+		auto t1 = std::chrono::steady_clock::now();
+		FakeXPLM::run_frame(frame_dt);
+		auto t2 = std::chrono::steady_clock::now();
+		frame_us[size_t(i)] = std::chrono::duration<double, std::micro>(t2 - t1).count();
+
+		next_frame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(frame_dt));
+		std::this_thread::sleep_until(next_frame);
+	}
+	double bench_sec = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - bench_start).count();
+
+	probe_stop.store(true);
+	// The probe may be blocked on a read, so keep serving requests until it exits.
+	while (!probe_done.load())
+	{
+		FakeXPLM::run_frame(frame_dt);
+		std::this_thread::sleep_for(std::chrono::duration<double>(frame_dt));
+	}
+	probe_thread.join();
+
+	// Same order as XPluginStop
+	fmc_l->sim_shutdown.store(true, StratosphereAvionics::UPDATE_FLG_ORDR);
+	fmc_r->sim_shutdown.store(true, StratosphereAvionics::UPDATE_FLG_ORDR);
+	avionics->sim_shutdown.store(true, StratosphereAvionics::UPDATE_FLG_ORDR);
+	databus->cleanup();
+	fmc_l_thread.join();
+	fmc_r_thread.join();
+	avionics_thread.join();
+	fmc_dr::unregister_data_refs(&custom_drs);
+	data_refs.clear();
+	fmc_l->disable();
+	fmc_r->disable();
+	avionics->disable();
+	databus->disable();
+
+	printf("%d frames at %.0f Hz in %.2f s, %llu sets dropped\n", n_frames, frame_hz,
+		bench_sec, (unsigned long long)databus->get_n_sets_dropped());
+	printf("%-24s %10s %10s %10s %10s\n", "us", "mean", "p50", "p99", "max");
+	print_stats("frame cost", get_stats(&frame_us));
+	print_stats("get_datai latency", get_stats(&probe_lat_us));
+	printf("%zu probe reads\n", probe_lat_us.size());
+
+	print_databus_stats(databus);
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains helpers shared by the tools that run the avionics
+	against the fake XPLM library: summary statistics, the data bus report and
+	waiting for the navigation data to load.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "fake_xplm.hpp"
+#include "databus.hpp"
+#include "dataref_structs.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+constexpr double DB_LOAD_TIMEOUT_SEC = 120;
+
+
+struct stats_t
+{
+	double mean, p50, p99, max;
+};
+
+
+inline stats_t get_stats(std::vector<double>* vals)
+{
+	stats_t out = {0, 0, 0, 0};
+	if (vals->empty())
+	{
+		return out;
+	}
+
+	double sum = 0;
+	for (size_t i = 0; i < vals->size(); i++)
+	{
+		sum += vals->at(i);
+	}
+	out.mean = sum / double(vals->size());
+	std::sort(vals->begin(), vals->end());
+	out.p50 = vals->at(vals->size() / 2);
+	out.p99 = vals->at(size_t(double(vals->size() - 1) * 0.99));
+	out.max = vals->back();
+	return out;
+}
+
+inline void print_stats(const char* name, stats_t st)
+{
+	printf("%-24s %10.1f %10.1f %10.1f %10.1f\n", name, st.mean, st.p50, st.p99, st.max);
+}
+
+// Prints set latency and queue depth for each lane, request counts and waits for each channel,
+// and the time the data bus spends on the main thread
+inline void print_databus_stats(std::shared_ptr<XPDataBus::DataBus> databus)
+{
+	const char* lane_names[XPDataBus::N_PRIO_LANES] = {"flight", "normal", "ui"};
+	printf("%-8s %10s %10s %10s %14s %14s\n", "lane", "sets", "depth", "max depth",
+		"avg lat us", "max lat us");
+	for (int i = 0; i < XPDataBus::N_PRIO_LANES; i++)
+	{
+		XPDataBus::lane_stats st = databus->get_lane_stats(XPDataBus::req_priority(i));
+		printf("%-8s %10llu %10llu %10llu %14.1f %14.1f\n", lane_names[i],
+			(unsigned long long)st.n_applied, (unsigned long long)st.depth,
+			(unsigned long long)st.max_depth, st.avg_latency_us, st.max_latency_us);
+	}
+
+	std::vector<XPDataBus::channel_stats> chan_stats = databus->get_channel_stats();
+	printf("%-12s %10s %10s %14s %14s %14s\n", "channel", "requests", "direct", "avg wait us", 
+		"max wait us", "blocked us");
+	for (size_t i = 0; i < chan_stats.size(); i++)
+	{
+		printf("%-12s %10llu %10llu %14.1f %14.1f %14.1f\n", chan_stats[i].name.c_str(),
+			(unsigned long long)chan_stats[i].n_reqs, (unsigned long long)chan_stats[i].n_direct, 
+			chan_stats[i].avg_wait_us, chan_stats[i].max_wait_us, chan_stats[i].blocked_us);
+	}
+
+	XPDataBus::drain_stats d_st = databus->get_drain_stats();
+	printf("drain us: avg %.1f max %.1f over %llu frames\n", d_st.avg_us, d_st.max_us,
+		(unsigned long long)d_st.n_frames);
+}
+
+/*
+	Pumps frames in real time until the navigation data has been loaded,
+	so that the measured frames see the avionics in steady state.
+	db_status is the dataref that the avionics report loading progress through.
+	Returns false if loading failed or timed out.
+*/
+
+inline bool wait_for_nav_data(double frame_dt, std::string xplane_path, DRUtil::dref_i* db_status)
+{
+	bool db_started = false;
+	auto load_start = std::chrono::steady_clock::now();
+	while (true)
+	{
+		FakeXPLM::run_frame(frame_dt);
+		int status = db_status->get();
+		db_started = db_started || status != 0;
+		if (db_started && status != 1)
+		{
+			if (status == -1)
+			{
+				printf("Failed to load navigation data from %s\n", xplane_path.c_str());
+				return false;
+			}
+			return true;
+		}
+		double load_sec = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - load_start).count();
+		if (load_sec > DB_LOAD_TIMEOUT_SEC)
+		{
+			printf("Timed out waiting for navigation data\n");
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::duration<double>(frame_dt));
+	}
+}
@@ -0,0 +1,202 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a microbenchmark of blocking data bus reads.
+	It compares the round trip cost of a read that waits on a std::promise
+	with one that waits on a CompletionSlot. A stand-in for the main thread
+	serves the requests from an MPSCRing and reads values through a small
+	shim in place of XPLMGetDatai.
+	Usage: slot_bench [n_round_trips]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "common.hpp"
+#include "mpsc_ring.hpp"
+#include "completion_slot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <thread>
+#include <vector>
+
+
+constexpr int N_ROUND_TRIPS_DEFAULT = 200000;
+constexpr size_t RING_SIZE = 1024;
+constexpr int N_SHIM_DRS = 64;
+
+
+std::atomic<uint64_t> n_allocs(0);
+
+void* operator new(size_t sz)
+{
+	n_allocs.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = malloc(sz ? sz : 1);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t sz) noexcept
+{
+	(void)sz;
+	free(ptr);
+}
+
+
+// Stand-in for the XPLM dataref API
+namespace xplm_shim
+{
+	int data_i[N_SHIM_DRS];
+
+	int get_datai(int dr)
+	{
+		return data_i[dr];
+	}
+}
+
+
+struct bench_req
+{
+	int dref;
+	XPDataBus::CompletionSlot* slot;
+	std::promise<XPDataBus::generic_val>* prom;
+};
+
+struct bench_res
+{
+	double allocs_per_op;
+	double ns_mean;
+	double ns_p50;
+	double ns_p99;
+};
+
+
+/*
+	Plays the role of the flight loop: pops requests and fulfills them
+	until told to stop.
+*/
+
+void serve(XPDataBus::MPSCRing<bench_req>* ring, std::atomic<bool>* stop)
+{
+	bench_req req;
+	while (!stop->load(std::memory_order_relaxed))
+	{
+		if (!ring->pop(&req))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		XPDataBus::generic_val val = { {0}, "", xplmType_Int, 0 };
+		val.int_val = xplm_shim::get_datai(req.dref);
+		if (req.slot != nullptr)
+		{
+			req.slot->val = val;
+			req.slot->complete();
+		}
+		else
+		{
+			req.prom->set_value(val);
+		}
+	}
+}
+
+int read_promise(XPDataBus::MPSCRing<bench_req>* ring, int dr)
+{
+	std::promise<XPDataBus::generic_val> prom;
+	std::future<XPDataBus::generic_val> fut = prom.get_future();
+	ring->push(bench_req{ dr, nullptr, &prom });
+	return fut.get().int_val;
+}
+
+int read_slot(XPDataBus::MPSCRing<bench_req>* ring, int dr)
+{
+	static thread_local XPDataBus::CompletionSlot slot;
+	uint64_t ticket = slot.arm();
+	ring->push(bench_req{ dr, &slot, nullptr });
+	slot.wait(ticket);
+	return slot.val.int_val;
+}
+
+bench_res run_bench(int n_trips, int (*read_fn)(XPDataBus::MPSCRing<bench_req>*, int))
+{
+	XPDataBus::MPSCRing<bench_req> ring(RING_SIZE);
+	std::atomic<bool> stop(false);
+	std::thread server(serve, &ring, &stop);
+
+	std::vector<double> lat_ns(size_t(n_trips), 0);
+	volatile int sink = 0;
+
+	// Warm up so that the thread local slot is constructed before counting
+	sink = read_fn(&ring, 0);
+
+	uint64_t allocs_start = n_allocs.load();
+	for (int i = 0; i < n_trips; i++)
+	{
+		auto t1 = std::chrono::steady_clock::now();
+		sink = read_fn(&ring, i % N_SHIM_DRS);
+		auto t2 = std::chrono::steady_clock::now();
+		lat_ns[size_t(i)] = std::chrono::duration<double, std::nano>(t2 - t1).count();
+	}
+	uint64_t allocs_end = n_allocs.load();
+	(void)sink;
+
+	stop.store(true);
+	server.join();
+
+	bench_res res;
+	res.allocs_per_op = double(allocs_end - allocs_start) / n_trips;
+	double sum = 0;
+	for (size_t i = 0; i < lat_ns.size(); i++)
+	{
+		sum += lat_ns[i];
+	}
+	res.ns_mean = sum / n_trips;
+	std::sort(lat_ns.begin(), lat_ns.end());
+	res.ns_p50 = lat_ns[lat_ns.size() / 2];
+	res.ns_p99 = lat_ns[size_t(double(lat_ns.size() - 1) * 0.99)];
+	return res;
+}
+
+void print_res(const char* name, bench_res res)
+{
+	printf("%-16s %10.3f %10.0f %10.0f %10.0f\n", name, res.allocs_per_op,
+		res.ns_mean, res.ns_p50, res.ns_p99);
+}
+
+
+int main(int argc, char** argv)
+{
+	int n_trips = N_ROUND_TRIPS_DEFAULT;
+	if (argc > 1)
+	{
+		n_trips = std::max(1, atoi(argv[1]));
+	}
+
+	for (int i = 0; i < N_SHIM_DRS; i++)
+	{
+		xplm_shim::data_i[i] = i;
+	}
+
+	printf("%d round trips\n", n_trips);
+	printf("%-16s %10s %10s %10s %10s\n", "path", "allocs/op", "mean ns", "p50 ns", "p99 ns");
+	print_res("std::promise", run_bench(n_trips, read_promise));
+	print_res("CompletionSlot", run_bench(n_trips, read_slot));
+
+	return 0;
+}
@@ -0,0 +1,288 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains a benchmark of the data bus value type.
+	It counts heap allocations and time per get/set round trip for generic_val
+	and for the old layout that stored strings in std::string. Set requests
+	are pushed through an MPSCRing the way the data bus does it. Gets are 
+	done by a producer thread through a real DataBus that runs on fake_xplm,
+	so they take the completion slot path. Allocations are counted on the
+	requesting thread only, since that's where get_data has to allocate 
+	nothing. The promise/future rows show what the old get path cost.
+	Time of a get includes waiting for the next flight loop, so it depends on 
+	how fast the main thread is pumped and shouldn't be compared to sets.
+	Usage: value_bench [n_iterations]
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "common.hpp"
+#include "mpsc_ring.hpp"
+#include "databus.hpp"
+#include "fake_xplm.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <new>
+#include <thread>
+
+
+constexpr int N_ITER_DEFAULT = 1000000;
+constexpr size_t RING_SIZE = 1024;
+// Every get waits for a flight loop, so these run fewer iterations
+constexpr int BUS_ITER_DIV = 100;
+constexpr int N_BUS_WARMUP = 100;
+constexpr double FRAME_DT = 1.0 / 60;
+constexpr double BUS_BUDGET_US = 500;
+const std::string PLUGIN_SIGN = "bench.value";
+// Length of an FMC screen line
+const char* TEST_STR_24 = "<INDEX          ROUTE>  ";
+
+
+std::atomic<uint64_t> n_allocs(0);
+thread_local uint64_t n_thread_allocs = 0;
+
+void* operator new(size_t sz)
+{
+	n_allocs.fetch_add(1, std::memory_order_relaxed);
+	n_thread_allocs++;
+	void* ptr = malloc(sz ? sz : 1);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t sz) noexcept
+{
+	(void)sz;
+	free(ptr);
+}
+
+
+// generic_val before the inline string buffer was added
+struct legacy_val
+{
+	union
+	{
+		int int_val;
+		float float_val;
+		double double_val;
+	};
+	std::string str;
+	int val_type;
+	int offset;
+};
+
+template <class T>
+struct bench_set_req
+{
+	int dref;
+	bool set_cmd;
+	T val;
+};
+
+struct bench_res
+{
+	double allocs_per_op;
+	double ns_per_op;
+};
+
+
+template <class T>
+bench_res bench_set(int n_iter, const char* str)
+{
+	XPDataBus::MPSCRing<bench_set_req<T>> ring(RING_SIZE);
+	bench_set_req<T> out;
+	volatile float sink = 0;
+
+	uint64_t allocs_start = n_allocs.load();
+	auto t_start = std::chrono::steady_clock::now();
+	for (int i = 0; i < n_iter; i++)
+	{
+		T tmp = { {0}, str, xplmType_Float, 0 };
+		tmp.float_val = float(i);
+		ring.push(bench_set_req<T>{ i, false, std::move(tmp) });
+		ring.pop(&out);
+		sink = out.val.float_val;
+	}
+	auto t_end = std::chrono::steady_clock::now();
+	(void)sink;
+
+	double dt_ns = std::chrono::duration<double, std::nano>(t_end - t_start).count();
+	return { double(n_allocs.load() - allocs_start) / n_iter, dt_ns / n_iter };
+}
+
+// The get path before completion slots: one promise/future pair per request
+template <class T>
+bench_res bench_get_promise(int n_iter, const char* str)
+{
+	volatile float sink = 0;
+
+	uint64_t allocs_start = n_allocs.load();
+	auto t_start = std::chrono::steady_clock::now();
+	for (int i = 0; i < n_iter; i++)
+	{
+		std::promise<T> prom;
+		std::future<T> fut = prom.get_future();
+
+		T tmp = { {0}, str, xplmType_Float, 0 };
+		tmp.float_val = float(i);
+		prom.set_value(tmp);
+
+		T val = fut.get();
+		sink = val.float_val;
+	}
+	auto t_end = std::chrono::steady_clock::now();
+	(void)sink;
+
+	double dt_ns = std::chrono::duration<double, std::nano>(t_end - t_start).count();
+	return { double(n_allocs.load() - allocs_start) / n_iter, dt_ns / n_iter };
+}
+
+bench_res bench_promise_only(int n_iter)
+{
+	uint64_t allocs_start = n_allocs.load();
+	auto t_start = std::chrono::steady_clock::now();
+	for (int i = 0; i < n_iter; i++)
+	{
+		std::promise<int> prom;
+		std::future<int> fut = prom.get_future();
+		prom.set_value(i);
+		fut.get();
+	}
+	auto t_end = std::chrono::steady_clock::now();
+
+	double dt_ns = std::chrono::duration<double, std::nano>(t_end - t_start).count();
+	return { double(n_allocs.load() - allocs_start) / n_iter, dt_ns / n_iter };
+}
+
+enum bus_get_mode
+{
+	BUS_GET_SYNC,
+	BUS_GET_ASYNC
+};
+
+/*
+	Reads dr through db from a registered producer thread while the calling
+	thread plays the role of X-Plane's main thread. A few reads are done 
+	before measuring, so the thread's slots already exist.
+*/
+
+bench_res bench_bus_get(XPDataBus::DataBus* db, XPDataBus::dr_handle_t dr, 
+	bus_get_mode mode, int n_iter)
+{
+	std::atomic<bool> done(false);
+	bench_res res = { 0, 0 };
+	volatile int sink = 0;
+
+	std::thread prod([&]()
+		{
+			db->reg_producer("value_bench");
+			for (int i = 0; i < N_BUS_WARMUP + n_iter; i++)
+			{
+				uint64_t allocs_start = n_thread_allocs;
+				auto t_start = std::chrono::steady_clock::now();
+				XPDataBus::generic_val val;
+				if (mode == BUS_GET_SYNC)
+				{
+					val = db->get_data(dr);
+				}
+				else
+				{
+					XPDataBus::async_get req = db->get_data_async(dr);
+					val = db->get_async_val(&req);
+				}
+				auto t_end = std::chrono::steady_clock::now();
+				sink = val.int_val;
+				if (i >= N_BUS_WARMUP)
+				{
+					res.allocs_per_op += double(n_thread_allocs - allocs_start);
+					res.ns_per_op += std::chrono::duration<double, std::nano>(
+						t_end - t_start).count();
+				}
+			}
+			done.store(true);
+		});
+
+	while (!done.load())
+	{
+		FakeXPLM::run_frame(FRAME_DT);
+	}
+	prod.join();
+	(void)sink;
+
+	res.allocs_per_op /= n_iter;
+	res.ns_per_op /= n_iter;
+	return res;
+}
+
+void print_res(const char* name, bench_res res)
+{
+	printf("%-40s %10.3f %10.1f\n", name, res.allocs_per_op, res.ns_per_op);
+}
+
+
+int main(int argc, char** argv)
+{
+	int n_iter = N_ITER_DEFAULT;
+	if (argc > 1)
+	{
+		n_iter = std::max(1, atoi(argv[1]));
+	}
+
+	printf("%d iterations\n", n_iter);
+	printf("%-40s %10s %10s\n", "case", "allocs/op", "ns/op");
+
+	print_res("set scalar, legacy_val", bench_set<legacy_val>(n_iter, ""));
+	print_res("set scalar, generic_val", bench_set<XPDataBus::generic_val>(n_iter, ""));
+	print_res("set 24 char string, legacy_val", bench_set<legacy_val>(n_iter, TEST_STR_24));
+	print_res("set 24 char string, generic_val",
+		bench_set<XPDataBus::generic_val>(n_iter, TEST_STR_24));
+
+	// Promise/future pairs allocate their shared state, which is shown separately.
+	print_res("promise/future<int> only", bench_promise_only(n_iter));
+	print_res("get scalar, promise, legacy_val", bench_get_promise<legacy_val>(n_iter, ""));
+	print_res("get 24 char string, promise, legacy_val", 
+		bench_get_promise<legacy_val>(n_iter, TEST_STR_24));
+
+	FakeXPLM::set_plugin_sign(PLUGIN_SIGN);
+	XPLMDataRef int_ref = FakeXPLM::add_data_ref("sim/bench/int", xplmType_Int);
+	XPLMDataRef str_ref = FakeXPLM::add_data_ref("sim/bench/str", xplmType_Data, 
+		int(strlen(TEST_STR_24)));
+	XPLMSetDatai(int_ref, 1);
+	XPLMSetDatab(str_ref, (void*)TEST_STR_24, 0, int(strlen(TEST_STR_24)));
+
+	std::vector<XPDataBus::cmd_entry> cmds;
+	std::vector<XPDataBus::custom_data_ref_entry> custom_drs;
+	XPDataBus::DataBus db(&cmds, &custom_drs, BUS_BUDGET_US, PLUGIN_SIGN);
+	XPDataBus::dr_handle_t int_hdl = db.reg_data_ref("sim/bench/int");
+	XPDataBus::dr_handle_t str_hdl = db.reg_data_ref("sim/bench/str");
+
+	int n_bus_iter = std::max(1, n_iter / BUS_ITER_DIV);
+	printf("%d data bus iterations, allocations on the requesting thread\n", n_bus_iter);
+	print_res("get_data scalar", bench_bus_get(&db, int_hdl, BUS_GET_SYNC, n_bus_iter));
+	print_res("get_data 24 char string", 
+		bench_bus_get(&db, str_hdl, BUS_GET_SYNC, n_bus_iter));
+	print_res("get_data_async scalar", bench_bus_get(&db, int_hdl, BUS_GET_ASYNC, n_bus_iter));
+	print_res("get_data_async 24 char string", 
+		bench_bus_get(&db, str_hdl, BUS_GET_ASYNC, n_bus_iter));
+
+	db.cleanup();
+	db.disable();
+
+	return 0;
+}
@@ -100,6 +100,28 @@ namespace StratosphereAvionics
         state_drs = drs;
         ref_hz = ref;
 
+        std::vector<XPDataBus::batch_entry> state_batch = {
+            {data_bus->reg_data_ref(state_drs.ap_eng), 0},
+            {data_bus->reg_data_ref(state_drs.flt_dir_capt), 0},
+            {data_bus->reg_data_ref(state_drs.flt_dir_fo), 0},
+            {data_bus->reg_data_ref(state_drs.fma_thr), 0},
+            {data_bus->reg_data_ref(state_drs.fma_roll), 0},
+            {data_bus->reg_data_ref(state_drs.fma_pitch), 0},
+            {data_bus->reg_data_ref(state_drs.brt_dr), state_drs.cap_brt_idx},
+            {data_bus->reg_data_ref(state_drs.brt_dr), state_drs.fo_brt_idx}
+        };
+
+        if(test_drs != nullptr)
+        {
+            state_batch.push_back({data_bus->reg_data_ref(test_drs->x), 0});
+            state_batch.push_back({data_bus->reg_data_ref(test_drs->y), 0});
+            state_batch.push_back({data_bus->reg_data_ref(test_drs->w), 0});
+            state_batch.push_back({data_bus->reg_data_ref(test_drs->h), 0});
+            state_batch.push_back({data_bus->reg_data_ref(test_drs->radius), 0});
+            state_batch.push_back({data_bus->reg_data_ref(test_drs->l_thick), 0});
+        }
+        state_snap = data_bus->subscribe(&state_batch);
+
         cap_brt = 0;
         fo_brt = 0;
 
@@ -124,14 +146,21 @@ namespace StratosphereAvionics
     {
         while(!is_stopped.load(std::memory_order_relaxed))
         {
+            // All of the state comes from the same frame
+            if (data_bus->get_snapshot(&state_snap, &state_vals) == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(int(1000 / ref_hz)));
+                continue;
+            }
+
             update_test();
 
             update_ap_fd();
             update_brt();
 
-            int curr_spd_md = data_bus->get_datai(state_drs.fma_thr);
-            int curr_roll_md = data_bus->get_datai(state_drs.fma_roll);
-            int curr_pitch_md = data_bus->get_datai(state_drs.fma_pitch);
+            int curr_spd_md = XPDataBus::get_gen_val_i(&state_vals[PFD_BATCH_FMA_THR]);
+            int curr_roll_md = XPDataBus::get_gen_val_i(&state_vals[PFD_BATCH_FMA_ROLL]);
+            int curr_pitch_md = XPDataBus::get_gen_val_i(&state_vals[PFD_BATCH_FMA_PITCH]);
 
             std::string curr_spd = get_at_mode_txt(ATModes(curr_spd_md));
             std::string curr_roll = get_roll_mode_txt(RollModes(curr_roll_md));
@@ -151,14 +180,14 @@ namespace StratosphereAvionics
 
     void PFDData::update_test()
     {
-        if(test_drs != nullptr)
+        if(test_drs != nullptr && state_vals.size() > PFD_BATCH_TEST_THICK)
         {
-            test_pos.x = data_bus->get_datad(test_drs->x);
-            test_pos.y = data_bus->get_datad(test_drs->y);
-            test_sz.x = data_bus->get_datad(test_drs->w);
-            test_sz.y = data_bus->get_datad(test_drs->h);
-            test_rad = data_bus->get_datad(test_drs->radius);
-            test_thick = data_bus->get_datad(test_drs->l_thick);
+            test_pos.x = XPDataBus::get_gen_val_d(&state_vals[PFD_BATCH_TEST_X]);
+            test_pos.y = XPDataBus::get_gen_val_d(&state_vals[PFD_BATCH_TEST_Y]);
+            test_sz.x = XPDataBus::get_gen_val_d(&state_vals[PFD_BATCH_TEST_W]);
+            test_sz.y = XPDataBus::get_gen_val_d(&state_vals[PFD_BATCH_TEST_H]);
+            test_rad = XPDataBus::get_gen_val_d(&state_vals[PFD_BATCH_TEST_R]);
+            test_thick = XPDataBus::get_gen_val_d(&state_vals[PFD_BATCH_TEST_THICK]);
         }
     }
 
@@ -244,9 +273,9 @@ namespace StratosphereAvionics
 
     void PFDData::update_ap_fd()
     {
-        int curr_ap = data_bus->get_datai(state_drs.ap_eng);
-        int curr_fd_cap = data_bus->get_datai(state_drs.flt_dir_capt);
-        int curr_fd_fo = data_bus->get_datai(state_drs.flt_dir_fo);
+        int curr_ap = XPDataBus::get_gen_val_i(&state_vals[PFD_BATCH_AP_ENG]);
+        int curr_fd_cap = XPDataBus::get_gen_val_i(&state_vals[PFD_BATCH_FD_CAPT]);
+        int curr_fd_fo = XPDataBus::get_gen_val_i(&state_vals[PFD_BATCH_FD_FO]);
 
         std::string txt_cap = get_ap_fd_txt(curr_ap, curr_fd_cap);
         std::string txt_fo = get_ap_fd_txt(curr_ap, curr_fd_fo);
@@ -260,8 +289,8 @@ namespace StratosphereAvionics
 
     void PFDData::update_brt()
     {
-        cap_brt = double(data_bus->get_dataf(state_drs.brt_dr, state_drs.cap_brt_idx));
-        fo_brt = double(data_bus->get_dataf(state_drs.brt_dr, state_drs.fo_brt_idx));
+        cap_brt = double(XPDataBus::get_gen_val_f(&state_vals[PFD_BATCH_BRT_CAPT]));
+        fo_brt = double(XPDataBus::get_gen_val_f(&state_vals[PFD_BATCH_BRT_FO]));
     }
 
     void PFDData::update_param(std::string& curr, std::string& prev, double *out)
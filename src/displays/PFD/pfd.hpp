@@ -93,6 +93,27 @@ namespace StratosphereAvionics
         PITCH_MODE_FLC_DES = 5
     };
 
+    // Positions of values inside the PFD data snapshot. Test values are only
+    // present if test datarefs have been provided.
+
+    enum PFDBatchIdx
+    {
+        PFD_BATCH_AP_ENG = 0,
+        PFD_BATCH_FD_CAPT = 1,
+        PFD_BATCH_FD_FO = 2,
+        PFD_BATCH_FMA_THR = 3,
+        PFD_BATCH_FMA_ROLL = 4,
+        PFD_BATCH_FMA_PITCH = 5,
+        PFD_BATCH_BRT_CAPT = 6,
+        PFD_BATCH_BRT_FO = 7,
+        PFD_BATCH_TEST_X = 8,
+        PFD_BATCH_TEST_Y = 9,
+        PFD_BATCH_TEST_W = 10,
+        PFD_BATCH_TEST_H = 11,
+        PFD_BATCH_TEST_R = 12,
+        PFD_BATCH_TEST_THICK = 13
+    };
+
     inline std::string get_at_mode_txt(ATModes mode);
 
     inline std::string get_roll_mode_txt(RollModes mode);
@@ -165,6 +186,9 @@ namespace StratosphereAvionics
         std::shared_ptr<XPDataBus::DataBus> data_bus;
         PFDdrs state_drs;
 
+        std::vector<XPDataBus::snap_handle_t> state_snap;
+        std::vector<XPDataBus::generic_val> state_vals;
+
         double ref_hz;
         libtime::SteadyTimer *tmr;
 
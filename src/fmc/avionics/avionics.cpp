@@ -25,10 +25,24 @@ namespace StratosphereAvionics
 		tile_size = cache_tile_size;
 		ac_pos_last = {};
 
-		in_drs = in;
-		out_drs = out;
-
 		xp_databus = databus;
+
+		std::vector<XPDataBus::batch_entry> ac_pos_drs = {
+			{xp_databus->reg_data_ref(in.sim_baro_alt_ft1), 0},
+			{xp_databus->reg_data_ref(in.sim_baro_alt_ft2), 0},
+			{xp_databus->reg_data_ref(in.sim_baro_alt_ft3), 0},
+			{xp_databus->reg_data_ref(in.sim_ac_lat_deg), 0},
+			{xp_databus->reg_data_ref(in.sim_ac_lon_deg), 0}
+		};
+		ac_pos_snap = xp_databus->subscribe(&ac_pos_drs);
+
+		out_drs.dep_icao = xp_databus->reg_data_ref(out.dep_icao);
+		out_drs.arr_icao = xp_databus->reg_data_ref(out.arr_icao);
+		out_drs.dep_rnw = xp_databus->reg_data_ref(out.dep_rnw);
+		out_drs.excl_navaids = xp_databus->reg_data_refs(&out.excl_navaids);
+		out_drs.excl_vors = xp_databus->reg_data_refs(&out.excl_vors);
+		creating_db_dr = xp_databus->reg_data_ref(out.creating_db);
+
 		strcpy_safe(path_sep, 2, xp_databus->path_sep); // Update path separator
 		xplane_path = xp_databus->xplane_path;
 		prefs_path = xp_databus->prefs_path;
@@ -50,8 +64,8 @@ namespace StratosphereAvionics
 
 		dr_cache = new XPDataBus::DataRefCache();
 
-		navaid_tuner = new NavaidTuner(databus, in_drs.nav_tuner, out_drs.nav_tuner, rad_nav_cand_update_time_sec);
-		navaid_selector = new NavaidSelector(databus, navaid_tuner, out_drs.nav_selector, cache_tile_size,
+		navaid_tuner = new NavaidTuner(databus, in.nav_tuner, out.nav_tuner, rad_nav_cand_update_time_sec);
+		navaid_selector = new NavaidSelector(databus, navaid_tuner, out.nav_selector, cache_tile_size,
 			min_navaid_dist_nm, rad_nav_cand_update_time_sec);
 	}
 
@@ -153,7 +167,11 @@ namespace StratosphereAvionics
 
 	void AvionicsSys::update_sys()
 	{
-		update_ac_pos();
+		// Position stays unknown until the first frame
+		if (!update_ac_pos())
+		{
+			return;
+		}
 
 		navaid_tuner->set_ac_pos(ac_pos);
 
@@ -189,7 +207,7 @@ namespace StratosphereAvionics
 
 	void AvionicsSys::update_load_status()
 	{
-		xp_databus->set_datai("Strato/777/UI/messages/creating_databases", 1);
+		xp_databus->set_datai(creating_db_dr, 1);
 		if (!sim_shutdown.load(UPDATE_FLG_ORDR))
 		{
 			libnav::DbErr err_arpt = apt_db->get_err();
@@ -199,22 +217,28 @@ namespace StratosphereAvionics
 			if (err_arpt != libnav::DbErr::SUCCESS || err_wpt != libnav::DbErr::SUCCESS 
 				|| err_nav != libnav::DbErr::SUCCESS)
 			{
-				xp_databus->set_datai("Strato/777/UI/messages/creating_databases", -1);
+				xp_databus->set_datai(creating_db_dr, -1);
 				return;
 			}
 		}
-		xp_databus->set_datai("Strato/777/UI/messages/creating_databases", 0);
+		xp_databus->set_datai(creating_db_dr, 0);
 	}
 
-	void AvionicsSys::update_ac_pos()
+	bool AvionicsSys::update_ac_pos()
 	{
-		double baro_ft_1 = xp_databus->get_datad(in_drs.sim_baro_alt_ft1);
-		double baro_ft_2 = xp_databus->get_datad(in_drs.sim_baro_alt_ft1);
-		double baro_ft_3 = xp_databus->get_datad(in_drs.sim_baro_alt_ft1);
+		if (xp_databus->get_snapshot(&ac_pos_snap, &ac_pos_vals) == 0)
+		{
+			return false;
+		}
+
+		double baro_ft_1 = XPDataBus::get_gen_val_d(&ac_pos_vals[AC_POS_BARO_ALT_1]);
+		double baro_ft_2 = XPDataBus::get_gen_val_d(&ac_pos_vals[AC_POS_BARO_ALT_2]);
+		double baro_ft_3 = XPDataBus::get_gen_val_d(&ac_pos_vals[AC_POS_BARO_ALT_3]);
 		std::lock_guard<std::mutex> lock(ac_pos_mutex);
-		ac_pos.p.lat_rad = xp_databus->get_datad(in_drs.sim_ac_lat_deg) * geo::DEG_TO_RAD;
-		ac_pos.p.lon_rad = xp_databus->get_datad(in_drs.sim_ac_lon_deg) * geo::DEG_TO_RAD;
+		ac_pos.p.lat_rad = XPDataBus::get_gen_val_d(&ac_pos_vals[AC_POS_LAT]) * geo::DEG_TO_RAD;
+		ac_pos.p.lon_rad = XPDataBus::get_gen_val_d(&ac_pos_vals[AC_POS_LON]) * geo::DEG_TO_RAD;
 		ac_pos.alt_ft = (baro_ft_1 + baro_ft_2 + baro_ft_3) / 3;
+		return true;
 	}
 
 	/*
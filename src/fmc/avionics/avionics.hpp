@@ -35,6 +35,17 @@ namespace StratosphereAvionics
 
 	constexpr int rad_nav_cand_update_time_sec = 5;
 
+	// Positions of values inside the aircraft position snapshot
+
+	enum ac_pos_batch_idx
+	{
+		AC_POS_BARO_ALT_1 = 0,
+		AC_POS_BARO_ALT_2 = 1,
+		AC_POS_BARO_ALT_3 = 2,
+		AC_POS_LAT = 3,
+		AC_POS_LON = 4
+	};
+
 
 	struct avionics_in_drs
 	{
@@ -54,6 +65,17 @@ namespace StratosphereAvionics
 
 		navaid_tuner_out_drs nav_tuner;
 		navaid_selector_out_drs nav_selector;
+
+		std::string creating_db;
+	};
+
+	struct avionics_out_hdls
+	{
+		XPDataBus::dr_handle_t dep_icao, arr_icao;
+		XPDataBus::dr_handle_t dep_rnw;
+
+		std::vector<XPDataBus::dr_handle_t> excl_navaids;
+		std::vector<XPDataBus::dr_handle_t> excl_vors;
 	};
 
 	struct flightplan
@@ -122,8 +144,8 @@ namespace StratosphereAvionics
 		int n_refresh_hz;
 		double tile_size;
 
-		avionics_in_drs in_drs;
-		avionics_out_drs out_drs;
+		avionics_out_hdls out_drs;
+		XPDataBus::dr_handle_t creating_db_dr;
 
 		std::mutex fpln_mutex;
 		std::mutex navaid_inhibit_mutex;
@@ -138,6 +160,9 @@ namespace StratosphereAvionics
 		geo::point3d ac_pos;
 		geo::point3d ac_pos_last;
 
+		std::vector<XPDataBus::snap_handle_t> ac_pos_snap;
+		std::vector<XPDataBus::generic_val> ac_pos_vals;
+
 		libtime::Timer* clock;
 
 		XPDataBus::DataRefCache* dr_cache;
@@ -149,7 +174,8 @@ namespace StratosphereAvionics
 
 		void update_load_status();
 
-		void update_ac_pos();
+		// Returns false if the data bus hasn't published a snapshot yet
+		bool update_ac_pos();
 
 		/*
 			Blacklists all navaids with given id forever.
@@ -12,6 +12,7 @@
 */
 
 #include "navaid_selector.hpp"
+#include <future>
 
 
 namespace StratosphereAvionics
@@ -35,7 +36,8 @@ namespace StratosphereAvionics
 		cand_update_dur_sec = dur_sec;
 		cand_update_last_sec = -dur_sec;
 
-		out_drs = out;
+		out_drs.vor_dme_cand_data = xp_databus->reg_data_refs(&out.vor_dme_cand_data);
+		out_drs.dme_dme_cand_data = xp_databus->reg_data_refs(&out.dme_dme_cand_data);
 
 		navaid_cache = {};
 	}
@@ -30,6 +30,13 @@ namespace StratosphereAvionics
 		std::vector<std::string> dme_dme_cand_data;
 	};
 
+	struct navaid_selector_out_hdls
+	{
+		std::vector<XPDataBus::dr_handle_t> vor_dme_cand_data;
+
+		std::vector<XPDataBus::dr_handle_t> dme_dme_cand_data;
+	};
+
 
 	class NavaidSelector
 	{
@@ -73,7 +80,7 @@ namespace StratosphereAvionics
 		double cache_tile_size, min_navaid_dist_nm,
 			cand_update_last_sec;
 
-		navaid_selector_out_drs out_drs;
+		navaid_selector_out_hdls out_drs;
 
 
 		void update_navaid_cache(geo::point ac_pos);
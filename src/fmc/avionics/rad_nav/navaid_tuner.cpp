@@ -103,8 +103,14 @@ namespace StratosphereAvionics
 		dme_dme_pos_update_last = 0;
 
 		xp_databus = databus;
-		in_drs = in;
-		out_drs = out;
+
+		out_drs.vor_dme_pos_lat = xp_databus->reg_data_ref(out.vor_dme_pos_lat);
+		out_drs.vor_dme_pos_lon = xp_databus->reg_data_ref(out.vor_dme_pos_lon);
+		out_drs.vor_dme_pos_fom = xp_databus->reg_data_ref(out.vor_dme_pos_fom);
+		out_drs.dme_dme_pos_lat = xp_databus->reg_data_ref(out.dme_dme_pos_lat);
+		out_drs.dme_dme_pos_lon = xp_databus->reg_data_ref(out.dme_dme_pos_lon);
+		out_drs.dme_dme_pos_fom = xp_databus->reg_data_ref(out.dme_dme_pos_fom);
+		out_drs.curr_dme_pair_debug = xp_databus->reg_data_ref(out.curr_dme_pair_debug);
 		n_update_freq_hz = freq;
 
 		dme_dme_cand = new radnav_util::navaid_t[N_DME_DME_CAND];
@@ -129,12 +135,24 @@ namespace StratosphereAvionics
 			dme_dme_radios.push_back(tmp_dme_dme);
 		}
 
+		std::vector<XPDataBus::batch_entry> dme_dme_dist_drs;
+		for (size_t i = 0; i < N_DME_DME_RADIOS; i++)
+		{
+			radio_hdls_t* tmp = &dme_dme_radios[i].dr_list;
+			dme_dme_dist_drs.push_back({ tmp->dme_nm, tmp->dr_idx });
+		}
+		dme_dme_dist_snap = xp_databus->subscribe(&dme_dme_dist_drs);
+
 		main_timer = new libtime::Timer();
 		black_list = new BlackList();
 
 		update.store(true, UPDATE_FLG_ORDR);
 
-		radio_thread = std::thread([](NavaidTuner* ptr) {ptr->main_loop(); }, this);
+		radio_thread = std::thread([](NavaidTuner* ptr) 
+			{
+				ptr->xp_databus->reg_producer("Radio tuner");
+				ptr->main_loop(); 
+			}, this);
 	}
 
 	bool NavaidTuner::is_black_listed(std::string* id, libnav::waypoint_entry_t* data)
@@ -190,13 +208,41 @@ namespace StratosphereAvionics
 
 	void NavaidTuner::set_vor_dme_radios()
 	{
+		double c_time_sec = main_timer->get_curr_time();
+		bool is_due[N_VOR_DME_RADIOS];
+		for (size_t i = 0; i < N_VOR_DME_RADIOS; i++)
+		{
+			is_due[i] = c_time_sec >= vor_dme_radios[i].last_tune_time_sec + RADIO_TUNE_DELAY_SEC;
+		}
+
+		/*
+			Outputs of the radios that are due are requested at once, so they
+			are read during the same frame. Radios that were tuned recently
+			aren't read at all.
+		*/
+		radio_state_fut_t radio_fut[N_VOR_DME_RADIOS];
+		for (size_t i = 0; i < N_VOR_DME_RADIOS; i++)
+		{
+			if (is_due[i])
+			{
+				radio_fut[i] = vor_dme_radios[i].request_state();
+			}
+		}
+		radio_state_t radio_state[N_VOR_DME_RADIOS];
+		for (size_t i = 0; i < N_VOR_DME_RADIOS; i++)
+		{
+			if (is_due[i])
+			{
+				radio_state[i] = vor_dme_radios[i].get_state(&radio_fut[i]);
+			}
+		}
+
 		for (size_t i = 0; i < N_VOR_DME_RADIOS; i++)
 		{
 			int mode = vor_dme_radio_modes[i];
-			double c_time_sec = main_timer->get_curr_time();
 			vhf_radio_t* curr_radio = &vor_dme_radios[i];
 
-			if (c_time_sec >= curr_radio->last_tune_time_sec + RADIO_TUNE_DELAY_SEC)
+			if (is_due[i])
 			{
 				radnav_util::navaid_t cand = get_vor_dme_cand();
 
@@ -216,7 +262,7 @@ namespace StratosphereAvionics
 						else
 						{
 							geo::point3d tmp_ac_pos = get_ac_pos();
-							double dme_dist = double(xp_databus->get_dataf(curr_radio->dr_list.dme_nm, curr_radio->dr_list.dr_idx));
+							double dme_dist = radio_state[i].dme_nm;
 							double curr_qual = curr_radio->get_tuned_qual(tmp_ac_pos, dme_dist);
 							if (cand.qual - curr_qual > NAVAID_MAX_QUAL_DIFF)
 							{
@@ -229,7 +275,7 @@ namespace StratosphereAvionics
 
 				if (!is_b_listed)
 				{
-					update_vor_dme_conn(i, c_time_sec);
+					update_vor_dme_conn(i, c_time_sec, &radio_state[i]);
 				}
 			}
 		}
@@ -263,8 +309,12 @@ namespace StratosphereAvionics
 			else
 			{
 				geo::point3d ppos = get_ac_pos();
-				double dist_1 = double(xp_databus->get_dataf(dme_dme_radios[0].dr_list.dme_nm, dme_dme_radios[0].dr_list.dr_idx));
-				double dist_2 = double(xp_databus->get_dataf(dme_dme_radios[1].dr_list.dme_nm, dme_dme_radios[1].dr_list.dr_idx));
+				if (xp_databus->get_snapshot(&dme_dme_dist_snap, &dme_dme_dist_vals) == 0)
+				{
+					return;
+				}
+				double dist_1 = XPDataBus::get_gen_val_d(&dme_dme_dist_vals[0]);
+				double dist_2 = XPDataBus::get_gen_val_d(&dme_dme_dist_vals[1]);
 				double phi = get_curr_dme_dme_phi_rad(ppos, dist_1, dist_2);
 				double curr_qual = get_curr_dme_dme_qual(dist_1, dist_2, 
 					phi * geo::RAD_TO_DEG);
@@ -373,40 +423,39 @@ namespace StratosphereAvionics
 		The calculated position, as well as its FOM(2*standard deviation), get output using certain datarefs.
 	*/
 
-	void NavaidTuner::update_vor_dme_conn(size_t radio_idx, double c_time)
+	void NavaidTuner::update_vor_dme_conn(size_t radio_idx, double c_time, radio_state_t* state)
 	{
 		vhf_radio_t* curr_radio = &vor_dme_radios[radio_idx];
-		if (curr_radio->is_sig_recv(libnav::NavaidType::VOR_DME))
+		if (curr_radio->is_sig_recv(libnav::NavaidType::VOR_DME, state))
 		{
 			vor_dme_radios[radio_idx].conn_retry = false;
 			// Calculate FOM and position
 
 			if (c_time >= vor_dme_pos_update_last + RADIO_POS_UPDATE_DELAY_SEC)
 			{
-				int idx = curr_radio->dr_list.dr_idx;
 				geo::point3d ppos = get_ac_pos();
-				double brng = double(xp_databus->get_dataf(curr_radio->dr_list.vor_deg, idx));
-				double total_dist = double(xp_databus->get_dataf(curr_radio->dr_list.dme_nm, idx));
+				double brng = state->vor_deg;
+				double total_dist = state->dme_nm;
 				double dist = vor_dme_radios[radio_idx].get_gnd_dist(total_dist, ppos.alt_ft);
 
 				geo::point pos = geo::get_pos_from_brng_dist(vor_dme_radios[radio_idx].tuned_navaid.data.pos, brng, dist);
 				double pos_fom_m = radnav_util::get_vor_dme_fom(total_dist) * geo::NM_TO_M;
 
 				xp_databus->set_datad(out_drs.vor_dme_pos_lat, pos.lat_rad 
-					* geo::RAD_TO_DEG);
+					* geo::RAD_TO_DEG, XPDataBus::req_priority::PRIO_FLIGHT);
 				xp_databus->set_datad(out_drs.vor_dme_pos_lon, pos.lon_rad 
-					* geo::RAD_TO_DEG);
+					* geo::RAD_TO_DEG, XPDataBus::req_priority::PRIO_FLIGHT);
 
-				xp_databus->set_datad(out_drs.vor_dme_pos_fom, pos_fom_m);
+				xp_databus->set_datad(out_drs.vor_dme_pos_fom, pos_fom_m, XPDataBus::req_priority::PRIO_FLIGHT);
 
 				vor_dme_pos_update_last = c_time;
 			}
 		}
 		else
 		{
-			xp_databus->set_datad(out_drs.vor_dme_pos_lat, 0);
-			xp_databus->set_datad(out_drs.vor_dme_pos_lon, 0);
-			xp_databus->set_datad(out_drs.vor_dme_pos_fom, 0);
+			xp_databus->set_datad(out_drs.vor_dme_pos_lat, 0, XPDataBus::req_priority::PRIO_FLIGHT);
+			xp_databus->set_datad(out_drs.vor_dme_pos_lon, 0, XPDataBus::req_priority::PRIO_FLIGHT);
+			xp_databus->set_datad(out_drs.vor_dme_pos_fom, 0, XPDataBus::req_priority::PRIO_FLIGHT);
 			black_list_tuned_navaid(&vor_dme_radios[radio_idx], c_time);
 		}
 	}
@@ -546,17 +595,17 @@ namespace StratosphereAvionics
 				}
 
 				xp_databus->set_datad(out_drs.dme_dme_pos_lat, dme_dme_pos->lat_rad
-					 * geo::RAD_TO_DEG);
+					 * geo::RAD_TO_DEG, XPDataBus::req_priority::PRIO_FLIGHT);
 				xp_databus->set_datad(out_drs.dme_dme_pos_lon, dme_dme_pos->lon_rad
-					 * geo::RAD_TO_DEG);
+					 * geo::RAD_TO_DEG, XPDataBus::req_priority::PRIO_FLIGHT);
 
-				xp_databus->set_datad(out_drs.dme_dme_pos_fom, pos_fom_m);
+				xp_databus->set_datad(out_drs.dme_dme_pos_fom, pos_fom_m, XPDataBus::req_priority::PRIO_FLIGHT);
 			}
 			else
 			{
-				xp_databus->set_datad(out_drs.dme_dme_pos_lat, 0);
-				xp_databus->set_datad(out_drs.dme_dme_pos_lon, 0);
-				xp_databus->set_datad(out_drs.dme_dme_pos_fom, 0);
+				xp_databus->set_datad(out_drs.dme_dme_pos_lat, 0, XPDataBus::req_priority::PRIO_FLIGHT);
+				xp_databus->set_datad(out_drs.dme_dme_pos_lon, 0, XPDataBus::req_priority::PRIO_FLIGHT);
+				xp_databus->set_datad(out_drs.dme_dme_pos_fom, 0, XPDataBus::req_priority::PRIO_FLIGHT);
 			}
 		}
 	}
@@ -47,6 +47,12 @@ namespace StratosphereAvionics
 			dme_dme_pos_lat, dme_dme_pos_lon, dme_dme_pos_fom, curr_dme_pair_debug;
 	};
 
+	struct navaid_tuner_out_hdls
+	{
+		XPDataBus::dr_handle_t vor_dme_pos_lat, vor_dme_pos_lon, vor_dme_pos_fom, 
+			dme_dme_pos_lat, dme_dme_pos_lon, dme_dme_pos_fom, curr_dme_pair_debug;
+	};
+
 
 	class BlackList
 	{
@@ -111,8 +117,7 @@ namespace StratosphereAvionics
 	private:
 		int n_update_freq_hz;
 
-		navaid_tuner_in_drs in_drs;
-		navaid_tuner_out_drs out_drs;
+		navaid_tuner_out_hdls out_drs;
 
 		std::thread radio_thread;
 		std::mutex vor_dme_cand_mutex;
@@ -127,6 +132,9 @@ namespace StratosphereAvionics
 		std::vector<vhf_radio_t> vor_dme_radios;
 		std::vector<vhf_radio_t> dme_dme_radios;
 
+		std::vector<XPDataBus::snap_handle_t> dme_dme_dist_snap;
+		std::vector<XPDataBus::generic_val> dme_dme_dist_vals;
+
 		libtime::Timer* main_timer;
 
 		double vor_dme_pos_update_last;
@@ -167,7 +175,7 @@ namespace StratosphereAvionics
 			The calculated position, as well as its FOM(2*standard deviation), get output using certain datarefs.
 		*/
 
-		void update_vor_dme_conn(size_t radio_idx, double c_time);
+		void update_vor_dme_conn(size_t radio_idx, double c_time, radio_state_t* state);
 
 		/*
 			Function: get_curr_dme_dme_phi_rad
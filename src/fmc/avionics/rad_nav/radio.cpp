@@ -17,7 +17,13 @@ namespace StratosphereAvionics
 	vhf_radio_t::vhf_radio_t(std::shared_ptr<XPDataBus::DataBus> databus, radio_drs_t drs)
 	{
 		xp_databus = databus;
-		dr_list = drs;
+
+		dr_list.freq = xp_databus->reg_data_ref(drs.freq);
+		dr_list.nav_id = xp_databus->reg_data_ref(drs.nav_id);
+		dr_list.dme_id = xp_databus->reg_data_ref(drs.dme_id);
+		dr_list.vor_deg = xp_databus->reg_data_ref(drs.vor_deg);
+		dr_list.dme_nm = xp_databus->reg_data_ref(drs.dme_nm);
+		dr_list.dr_idx = drs.dr_idx;
 
 		tuned_navaid = {};
 		last_tune_time_sec = 0;
@@ -30,7 +36,7 @@ namespace StratosphereAvionics
 		if (navaid_data) // Make sure the pointer to navaid data isn't null.
 		{
 			tuned_navaid = new_navaid;
-			xp_databus->set_datai(dr_list.freq, int(navaid_data->freq), dr_list.dr_idx);
+			xp_databus->set_datai(dr_list.freq, int(navaid_data->freq), dr_list.dr_idx, XPDataBus::req_priority::PRIO_FLIGHT);
 			last_tune_time_sec = c_time;
 			conn_retry = false;
 		}
@@ -55,6 +61,44 @@ namespace StratosphereAvionics
 		}
 	}
 
+	bool vhf_radio_t::is_sig_recv(libnav::NavaidType expected_type, radio_state_t* state)
+	{
+		switch (expected_type)
+		{
+		case libnav::NavaidType::VOR:
+			return state->nav_id == tuned_navaid.id;
+		case libnav::NavaidType::DME:
+			return state->dme_id == tuned_navaid.id;
+		case libnav::NavaidType::VOR_DME:
+			return state->nav_id == tuned_navaid.id && state->dme_id == tuned_navaid.id;
+		default:
+			return false;
+		}
+	}
+
+	radio_state_fut_t vhf_radio_t::request_state()
+	{
+		radio_state_fut_t out;
+		out.nav_id = xp_databus->get_data_async(dr_list.nav_id);
+		out.dme_id = xp_databus->get_data_async(dr_list.dme_id);
+		out.vor_deg = xp_databus->get_data_async(dr_list.vor_deg, dr_list.dr_idx);
+		out.dme_nm = xp_databus->get_data_async(dr_list.dme_nm, dr_list.dr_idx);
+		return out;
+	}
+
+	radio_state_t vhf_radio_t::get_state(radio_state_fut_t* fut)
+	{
+		XPDataBus::generic_val vor_deg = xp_databus->get_async_val(&fut->vor_deg);
+		XPDataBus::generic_val dme_nm = xp_databus->get_async_val(&fut->dme_nm);
+
+		radio_state_t out;
+		out.nav_id = xp_databus->get_async_val(&fut->nav_id).str.to_string();
+		out.dme_id = xp_databus->get_async_val(&fut->dme_id).str.to_string();
+		out.vor_deg = double(XPDataBus::get_gen_val_f(&vor_deg));
+		out.dme_nm = double(XPDataBus::get_gen_val_f(&dme_nm));
+		return out;
+	}
+
 	/*
 		The following function returns the ground distance to the tuned nav aid.
 		It uses the distance output from a DME and accounts for slant angle using
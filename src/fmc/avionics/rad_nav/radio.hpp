@@ -31,11 +31,30 @@ namespace StratosphereAvionics
 		int dr_idx; // This index is used to obtain navaid identifiers, bearings and distances
 	};
 
+	struct radio_hdls_t
+	{
+		XPDataBus::dr_handle_t freq, nav_id, dme_id, vor_deg, dme_nm;
+		int dr_idx;
+	};
+
+	// Values a radio outputs during a single frame
+
+	struct radio_state_t
+	{
+		std::string nav_id, dme_id;
+		double vor_deg, dme_nm;
+	};
+
+	struct radio_state_fut_t
+	{
+		XPDataBus::async_get nav_id, dme_id, vor_deg, dme_nm;
+	};
+
 	struct vhf_radio_t
 	{
 		std::shared_ptr<XPDataBus::DataBus> xp_databus;
 
-		radio_drs_t dr_list;
+		radio_hdls_t dr_list;
 
 		radnav_util::navaid_t tuned_navaid;
 
@@ -50,6 +69,17 @@ namespace StratosphereAvionics
 
 		bool is_sig_recv(libnav::NavaidType expected_type);
 
+		bool is_sig_recv(libnav::NavaidType expected_type, radio_state_t* state);
+
+		/*
+			The following function queues reads of all radio outputs
+			without waiting for them. Use get_state to collect the values.
+		*/
+
+		radio_state_fut_t request_state();
+
+		radio_state_t get_state(radio_state_fut_t* fut);
+
 		/*
 			The following function returns the ground distance to the tuned nav aid.
 			It uses the distance output from a DME and accounts for slant angle using
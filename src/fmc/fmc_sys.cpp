@@ -24,18 +24,20 @@ namespace StratosphereAvionics
 		avionics = av;
 		navaid_db = avionics->navaid_db;
 		apt_db = avionics->apt_db;
-		in_drs = in;
-		out_drs = out;
-
 		xp_databus = avionics->xp_databus;
 
+		reg_data_refs(&in, &out);
+		add_watches();
+
 		dr_cache = new XPDataBus::DataRefCache();
+		in_cache = new XPDataBus::ReadThroughCache(xp_databus);
+		bind_inputs();
 	}
 
 	geo::point FMC::get_ac_pos()
 	{
-		double ac_lat = xp_databus->get_datad(in_drs.sim_ac_lat_deg) * geo::DEG_TO_RAD;
-		double ac_lon = xp_databus->get_datad(in_drs.sim_ac_lon_deg) * geo::DEG_TO_RAD;
+		double ac_lat = in_cache->get_val_d(in_drs.sim_ac_lat_deg) * geo::DEG_TO_RAD;
+		double ac_lon = in_cache->get_val_d(in_drs.sim_ac_lon_deg) * geo::DEG_TO_RAD;
 
 		return { ac_lat, ac_lon };
 	}
@@ -47,8 +49,9 @@ namespace StratosphereAvionics
 	{
 		int n_subpages = int(ceil(float(vec.size()) / float(N_CDU_OUT_LINES)));
 
-		xp_databus->set_datai(out_drs.sel_desired_wpt.is_active, 1);
-		xp_databus->set_datai(out_drs.sel_desired_wpt.n_subpages, n_subpages);
+		xp_databus->set_datai(out_drs.sel_desired_wpt.is_active, 1, XPDataBus::req_priority::PRIO_UI);
+		in_cache->invalidate(out_drs.sel_desired_wpt.is_active);
+		xp_databus->set_datai(out_drs.sel_desired_wpt.n_subpages, n_subpages, XPDataBus::req_priority::PRIO_UI);
 
 		geo::point ac_pos = get_ac_pos(); // Current aircraft position
 
@@ -60,14 +63,14 @@ namespace StratosphereAvionics
 
 		int start_idx = 0;
 
-		int user_idx = xp_databus->get_datai(in_drs.sel_desired_wpt.poi_idx);
+		int user_idx = in_cache->get_val_i(in_drs.sel_desired_wpt.poi_idx);
 
 		libnav::waypoint_entry_t out_navaid{};
 
 		while ((user_idx < 0 || user_idx >= n_navaids_displayed) && !sim_shutdown.load(std::memory_order_relaxed))
 		{
 			// If user decides to leave this page, reset and exit
-			if (!xp_databus->get_datai(out_drs.sel_desired_wpt.is_active))
+			if (!in_cache->get_val_i(out_drs.sel_desired_wpt.is_active))
 			{
 				return out_navaid;
 			}
@@ -83,7 +86,10 @@ namespace StratosphereAvionics
 					n_navaids_displayed = int(vec.size()) - start_idx;
 				}
 
-				xp_databus->set_datai(out_drs.sel_desired_wpt.n_pois, n_navaids_displayed);
+				xp_databus->set_datai(out_drs.sel_desired_wpt.n_pois, n_navaids_displayed, XPDataBus::req_priority::PRIO_UI);
+
+				// Frequency, latitude and longitude of each navaid
+				std::vector<float> poi_list;
 
 				for (int i = start_idx; i < start_idx + n_navaids_displayed; i++)
 				{
@@ -100,21 +106,22 @@ namespace StratosphereAvionics
 
 					std::string type_str = id + " " + libnav::navaid_to_str(vec.at(i_idx).type);
 
-					xp_databus->set_data_s(out_drs.sel_desired_wpt.poi_types.at(size_t(i - start_idx)), type_str);
-					xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, float(poi_freq), (i - start_idx) * 3);
-					xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, float(poi_lat), (i - start_idx) * 3 + 1);
-					xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, float(poi_lon), (i - start_idx) * 3 + 2);
+					xp_databus->set_data_s(out_drs.sel_desired_wpt.poi_types.at(size_t(i - start_idx)), type_str, 0, XPDataBus::req_priority::PRIO_UI);
+					poi_list.push_back(float(poi_freq));
+					poi_list.push_back(float(poi_lat));
+					poi_list.push_back(float(poi_lon));
 				}
+				xp_databus->set_datavf(out_drs.sel_desired_wpt.poi_list, poi_list, 0, XPDataBus::req_priority::PRIO_UI);
 				subpage_prev = curr_subpage;
 			}
 
-			curr_subpage = libnav::clamp(xp_databus->get_datai(in_drs.sel_desired_wpt.curr_page), n_subpages, 1);
-			user_idx = xp_databus->get_datai(in_drs.sel_desired_wpt.poi_idx);
+			curr_subpage = libnav::clamp(in_cache->get_val_i(in_drs.sel_desired_wpt.curr_page), n_subpages, 1);
+			user_idx = in_cache->get_val_i(in_drs.sel_desired_wpt.poi_idx);
 
-			std::this_thread::sleep_for(std::chrono::milliseconds(1000 / n_refresh_hz));
+			wait_for_inputs(sel_des_wpt_watch);
 		}
 
-		xp_databus->set_datai(out_drs.sel_desired_wpt.is_active, 0);
+		xp_databus->set_datai(out_drs.sel_desired_wpt.is_active, 0, XPDataBus::req_priority::PRIO_UI);
 		reset_sel_navaid();
 
 		if (user_idx != -1 && curr_subpage <= n_subpages)
@@ -129,15 +136,15 @@ namespace StratosphereAvionics
 	{
 		for (int i = 0; i < N_CDU_OUT_LINES; i++)
 		{
-			xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, 0, i * 3);
-			xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, 0, i * 3 + 1);
-			xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, 0, i * 3 + 2);
-			xp_databus->set_data_s(out_drs.sel_desired_wpt.poi_types.at(size_t(i)), " ", -1);
+			xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, 0, i * 3, XPDataBus::req_priority::PRIO_UI);
+			xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, 0, i * 3 + 1, XPDataBus::req_priority::PRIO_UI);
+			xp_databus->set_dataf(out_drs.sel_desired_wpt.poi_list, 0, i * 3 + 2, XPDataBus::req_priority::PRIO_UI);
+			xp_databus->set_data_s(out_drs.sel_desired_wpt.poi_types.at(size_t(i)), " ", -1, XPDataBus::req_priority::PRIO_UI);
 		}
-		xp_databus->set_datai(out_drs.sel_desired_wpt.n_pois, 0);
-		xp_databus->set_datai(out_drs.sel_desired_wpt.n_subpages, 0);
-		xp_databus->set_datai(in_drs.sel_desired_wpt.curr_page, 1);
-		xp_databus->set_datai(in_drs.sel_desired_wpt.poi_idx, -1);
+		xp_databus->set_datai(out_drs.sel_desired_wpt.n_pois, 0, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datai(out_drs.sel_desired_wpt.n_subpages, 0, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datai(in_drs.sel_desired_wpt.curr_page, 1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datai(in_drs.sel_desired_wpt.poi_idx, -1, XPDataBus::req_priority::PRIO_UI);
 	}
 
 	// REF NAV DATA page:
@@ -146,26 +153,26 @@ namespace StratosphereAvionics
 		libnav::airport_data_t arpt_found, libnav::runway_entry_t rwy_found,
 		std::vector<libnav::waypoint_entry_t> wpts_found)
 	{
-		xp_databus->set_data_s(out_drs.ref_nav.poi_id, icao);
+		xp_databus->set_data_s(out_drs.ref_nav.poi_id, icao, 0, XPDataBus::req_priority::PRIO_UI);
 
 		double poi_lat, poi_lon;
 
 		if (n_arpt_found)
 		{
-			xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_AIRPORT);
+			xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_AIRPORT, XPDataBus::req_priority::PRIO_UI);
 			poi_lat = arpt_found.pos.lat_rad * geo::RAD_TO_DEG;
 			poi_lon = arpt_found.pos.lon_rad * geo::RAD_TO_DEG;
 
-			xp_databus->set_datai(out_drs.ref_nav.poi_elevation, int(arpt_found.elevation_ft));
+			xp_databus->set_datai(out_drs.ref_nav.poi_elevation, int(arpt_found.elevation_ft), XPDataBus::req_priority::PRIO_UI);
 		}
 		else if (n_rwys_found)
 		{
 			double rwy_length_m = rwy_found.get_impl_length_m() - rwy_found.displ_threshold_m;
 			double rwy_length_ft = rwy_length_m * geo::M_TO_FT;
-			xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_RWY);
-			xp_databus->set_datai(out_drs.ref_nav.poi_length_m, int(rwy_length_m));
-			xp_databus->set_datai(out_drs.ref_nav.poi_length_ft, int(rwy_length_ft));
-			xp_databus->set_datai(out_drs.ref_nav.poi_elevation, int(arpt_found.elevation_ft));
+			xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_RWY, XPDataBus::req_priority::PRIO_UI);
+			xp_databus->set_datai(out_drs.ref_nav.poi_length_m, int(rwy_length_m), XPDataBus::req_priority::PRIO_UI);
+			xp_databus->set_datai(out_drs.ref_nav.poi_length_ft, int(rwy_length_ft), XPDataBus::req_priority::PRIO_UI);
+			xp_databus->set_datai(out_drs.ref_nav.poi_elevation, int(arpt_found.elevation_ft), XPDataBus::req_priority::PRIO_UI);
 			poi_lat = rwy_found.start.lat_rad * geo::RAD_TO_DEG;
 			poi_lon = rwy_found.start.lon_rad * geo::RAD_TO_DEG;
 		}
@@ -185,12 +192,12 @@ namespace StratosphereAvionics
 
 			if (curr_wpt.type == libnav::NavaidType::WAYPOINT)
 			{
-				xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_WAYPOINT);
+				xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_WAYPOINT, XPDataBus::req_priority::PRIO_UI);
 			}
 			else
 			{
-				xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_NAVAID);
-				xp_databus->set_datad(out_drs.ref_nav.poi_freq, curr_wpt.navaid->freq);
+				xp_databus->set_datai(out_drs.ref_nav.poi_type, POI_NAVAID, XPDataBus::req_priority::PRIO_UI);
+				xp_databus->set_datad(out_drs.ref_nav.poi_freq, curr_wpt.navaid->freq, XPDataBus::req_priority::PRIO_UI);
 			}
 
 			poi_lat = curr_wpt.pos.lat_rad * geo::RAD_TO_DEG;
@@ -200,32 +207,29 @@ namespace StratosphereAvionics
 		double mag_var = xp_databus->get_mag_var(poi_lat, poi_lon);
 		std::string mag_var_str = strutils::mag_var_to_str(mag_var);
 
-		xp_databus->set_datad(out_drs.ref_nav.poi_lat, poi_lat);
-		xp_databus->set_datad(out_drs.ref_nav.poi_lon, poi_lon);
-		xp_databus->set_data_s(out_drs.ref_nav.poi_mag_var, mag_var_str);
+		xp_databus->set_datad(out_drs.ref_nav.poi_lat, poi_lat, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datad(out_drs.ref_nav.poi_lon, poi_lon, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_data_s(out_drs.ref_nav.poi_mag_var, mag_var_str, 0, XPDataBus::req_priority::PRIO_UI);
 
 		return 1;
 	}
 
-	void FMC::update_ref_nav_inhibit(std::vector<std::string>* nav_drs, 
+	void FMC::update_ref_nav_inhibit(std::vector<dr_hdl_t>* nav_drs, 
 		libnav::NavaidType types, ref_nav threshold, bool add_vor)
 	{
 		for (size_t i = 0; i < nav_drs->size(); i++)
 		{
-			std::string curr_dr_name = nav_drs->at(i);
-			std::string tmp = xp_databus->get_data_s(curr_dr_name);
+			dr_hdl_t curr_dr = nav_drs->at(i);
+			std::string tmp = in_cache->get_val_s(curr_dr);
 			std::string entry_curr;
-			std::string entry_last = dr_cache->get_val_s(curr_dr_name);
 
 			strip_str(&tmp, &entry_curr);
 
-			if (entry_curr != entry_last)
+			if (dr_cache->update_s(curr_dr, entry_curr))
 			{
-				dr_cache->set_val_s(curr_dr_name, entry_curr);
-
 				if (entry_curr != "")
 				{
-					if (xp_databus->get_datai(in_drs.ref_nav.rad_nav_inh) > static_cast<int>(threshold))
+					if (in_cache->get_val_i(in_drs.ref_nav.rad_nav_inh) > static_cast<int>(threshold))
 					{
 						if (navaid_db->is_navaid_of_type(entry_curr, types))
 						{
@@ -241,7 +245,7 @@ namespace StratosphereAvionics
 						else
 						{
 							size_t msg_idx = out_drs.scratch_msg.not_in_db_idx;
-							xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1);
+							xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1, XPDataBus::req_priority::PRIO_UI);
 						}
 					}
 				}
@@ -260,12 +264,13 @@ namespace StratosphereAvionics
 		}
 	}
 
-	void FMC::reset_ref_nav_poi_data(std::vector<std::string>* nav_drs)
+	void FMC::reset_ref_nav_poi_data(std::vector<dr_hdl_t>* nav_drs)
 	{
 		for (size_t i = 0; i < nav_drs->size(); i++)
 		{
-			std::string curr_dr = nav_drs->at(i);
-			xp_databus->set_data_s(curr_dr, " ", -1);
+			dr_hdl_t curr_dr = nav_drs->at(i);
+			xp_databus->set_data_s(curr_dr, " ", -1, XPDataBus::req_priority::PRIO_UI);
+			in_cache->invalidate(curr_dr);
 		}
 	}
 
@@ -309,30 +314,28 @@ namespace StratosphereAvionics
 		{
 			// Trigger NOT IN DATA BASE scratch pad message
 			size_t msg_idx = out_drs.scratch_msg.not_in_db_idx;
-			xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1);
+			xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1, XPDataBus::req_priority::PRIO_UI);
 		}
 		return 1;
 	}
 
 	void FMC::ref_nav_main_loop() // Updates ref nav data page
 	{
-		while (xp_databus->get_datai(in_drs.curr_page) == static_cast<int>(fmc_pages::PAGE_REF_NAV_DATA) &&
+		while (in_cache->get_val_i(in_drs.curr_page) == static_cast<int>(fmc_pages::PAGE_REF_NAV_DATA) &&
 			!sim_shutdown.load(std::memory_order_relaxed))
 		{
-			std::string tmp = xp_databus->get_data_s(in_drs.ref_nav.poi_id);
+			std::string tmp = in_cache->get_val_s(in_drs.ref_nav.poi_id);
 			std::string icao;
-			std::string icao_entry_last = dr_cache->get_val_s(in_drs.ref_nav.poi_id);
 
 			strip_str(&tmp, &icao);
 
-			if (icao != icao_entry_last)
+			if (dr_cache->update_s(in_drs.ref_nav.poi_id, icao))
 			{
-				dr_cache->set_val_s(in_drs.ref_nav.poi_id, icao);
-
 				if (icao != "")
 				{
 					// Reset poi id so that the it isn't corrupted
-					xp_databus->set_data_s(in_drs.ref_nav.poi_id, " ", -1);
+					xp_databus->set_data_s(in_drs.ref_nav.poi_id, " ", -1, XPDataBus::req_priority::PRIO_UI);
+					in_cache->invalidate(in_drs.ref_nav.poi_id);
 
 					int ret = update_ref_nav(icao);
 
@@ -351,34 +354,32 @@ namespace StratosphereAvionics
 			update_ref_nav_inhibit(&in_drs.ref_nav.in_vors, vor_tp, 
 				ref_nav::RAD_NAV_VOR_ONLY_INHIBIT, true);
 
-			int inh_curr = xp_databus->get_datai(in_drs.ref_nav.rad_nav_inh);
-			int inh_last = dr_cache->get_val_i(in_drs.ref_nav.rad_nav_inh);
+			int inh_curr = in_cache->get_val_i(in_drs.ref_nav.rad_nav_inh);
 
-			if (inh_curr != inh_last)
+			if (dr_cache->update_i(in_drs.ref_nav.rad_nav_inh, inh_curr))
 			{
-				dr_cache->set_val_i(in_drs.ref_nav.rad_nav_inh, inh_curr);
 				reset_ref_nav_poi_data(&in_drs.ref_nav.in_navaids);
 				reset_ref_nav_poi_data(&in_drs.ref_nav.in_vors);
 			}
 
 			update_scratch_msg();
 
-			std::this_thread::sleep_for(std::chrono::milliseconds(1000 / n_refresh_hz));
+			wait_for_inputs(ref_nav_watch);
 		}
 		reset_ref_nav();
 	}
 
 	void FMC::reset_ref_nav()
 	{
-		xp_databus->set_datai(out_drs.ref_nav.poi_type, 0);
-		xp_databus->set_datad(out_drs.ref_nav.poi_lat, -1);
-		xp_databus->set_datad(out_drs.ref_nav.poi_lon, -1);
-		xp_databus->set_datad(out_drs.ref_nav.poi_elevation, -1);
-		xp_databus->set_datad(out_drs.ref_nav.poi_freq, -1);
-		xp_databus->set_data_s(out_drs.ref_nav.poi_mag_var, " ", -1);
-		xp_databus->set_data_s(out_drs.ref_nav.poi_id, " ", -1);
-		xp_databus->set_datai(out_drs.ref_nav.poi_length_ft, 0);
-		xp_databus->set_datai(out_drs.ref_nav.poi_length_m, 0);
+		xp_databus->set_datai(out_drs.ref_nav.poi_type, 0, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datad(out_drs.ref_nav.poi_lat, -1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datad(out_drs.ref_nav.poi_lon, -1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datad(out_drs.ref_nav.poi_elevation, -1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datad(out_drs.ref_nav.poi_freq, -1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_data_s(out_drs.ref_nav.poi_mag_var, " ", -1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_data_s(out_drs.ref_nav.poi_id, " ", -1, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datai(out_drs.ref_nav.poi_length_ft, 0, XPDataBus::req_priority::PRIO_UI);
+		xp_databus->set_datai(out_drs.ref_nav.poi_length_m, 0, XPDataBus::req_priority::PRIO_UI);
 	}
 
 	// RTE1 page:
@@ -389,19 +390,16 @@ namespace StratosphereAvionics
 			Otherwise, returns false.
 	*/
 
-	bool FMC::update_rte_apt(std::string in_dr, libnav::airport_data_t* apt_data, 
+	bool FMC::update_rte_apt(dr_hdl_t in_dr, libnav::airport_data_t* apt_data, 
 		libnav::runway_data* rnw_data)
 	{
-		std::string tmp = xp_databus->get_data_s(in_dr);
+		std::string tmp = in_cache->get_val_s(in_dr);
 		std::string icao_curr;
-		std::string icao_last = dr_cache->get_val_s(in_dr);
 
 		strip_str(&tmp, &icao_curr);
 
-		if (icao_curr != icao_last)
+		if (dr_cache->update_s(in_dr, icao_curr))
 		{
-			dr_cache->set_val_s(in_dr, icao_curr);
-
 			int n_arpts = apt_db->get_airport_data(icao_curr, apt_data);
 
 			if (n_arpts)
@@ -413,7 +411,7 @@ namespace StratosphereAvionics
 			else
 			{
 				size_t msg_idx = out_drs.scratch_msg.not_in_db_idx;
-				xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1);
+				xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1, XPDataBus::req_priority::PRIO_UI);
 			}
 		}
 
@@ -427,7 +425,7 @@ namespace StratosphereAvionics
 		libnav::airport_data_t arr_data;
 		libnav::runway_data arr_runways;
 
-		while (xp_databus->get_datai(in_drs.curr_page) == static_cast<int>(fmc_pages::PAGE_RTE1) &&
+		while (in_cache->get_val_i(in_drs.curr_page) == static_cast<int>(fmc_pages::PAGE_RTE1) &&
 			!sim_shutdown.load(std::memory_order_relaxed))
 		{
 			bool ret1 = update_rte_apt(in_drs.rte1.dep_icao, &dep_data, &dep_runways);
@@ -435,24 +433,24 @@ namespace StratosphereAvionics
 
 			if (ret1)
 			{
-				std::string dep_icao = xp_databus->get_data_s(in_drs.rte1.dep_icao);
+				std::string dep_icao = in_cache->get_val_s(in_drs.rte1.dep_icao);
 				avionics->set_fpln_dep_apt({ dep_icao,  dep_data });
 			}
 			if (ret2)
 			{
-				std::string arr_icao = xp_databus->get_data_s(in_drs.rte1.arr_icao);
+				std::string arr_icao = in_cache->get_val_s(in_drs.rte1.arr_icao);
 				avionics->set_fpln_arr_apt({ arr_icao,  arr_data });
 			}
 
-			std::string tmp = xp_databus->get_data_s(in_drs.rte1.dep_rnw);
+			std::string tmp = in_cache->get_val_s(in_drs.rte1.dep_rnw);
 			std::string rnw_curr;
-			std::string rnw_last = dr_cache->get_val_s(in_drs.rte1.dep_rnw);
 
 			strip_str(&tmp, &rnw_curr);
 
 			if (rnw_curr != "")
 			{
-				xp_databus->set_data_s(in_drs.rte1.dep_rnw, " ", -1);
+				xp_databus->set_data_s(in_drs.rte1.dep_rnw, " ", -1, XPDataBus::req_priority::PRIO_UI);
+				in_cache->invalidate(in_drs.rte1.dep_rnw);
 				if (dep_runways.find(rnw_curr) != dep_runways.end())
 				{
 					avionics->set_fpln_dep_rnw({ rnw_curr, dep_runways.at(rnw_curr) });
@@ -460,13 +458,13 @@ namespace StratosphereAvionics
 				else
 				{
 					size_t msg_idx = out_drs.scratch_msg.not_in_db_idx;
-					xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1);
+					xp_databus->set_datai(out_drs.scratch_msg.dr_list[msg_idx], 1, XPDataBus::req_priority::PRIO_UI);
 				}
 			}
 
 			update_scratch_msg();
 
-			std::this_thread::sleep_for(std::chrono::milliseconds(1000 / n_refresh_hz));
+			wait_for_inputs(rte1_watch);
 		}
 	}
 
@@ -478,13 +476,14 @@ namespace StratosphereAvionics
 
 	void FMC::update_scratch_msg()
 	{
-		if (xp_databus->get_datai(in_drs.scratch_pad_msg_clear))
+		if (in_cache->get_val_i(in_drs.scratch_pad_msg_clear))
 		{
 			for (size_t i = 0; i < out_drs.scratch_msg.dr_list.size(); i++)
 			{
-				xp_databus->set_datai(out_drs.scratch_msg.dr_list[i], 0);
+				xp_databus->set_datai(out_drs.scratch_msg.dr_list[i], 0, XPDataBus::req_priority::PRIO_UI);
 			}
-			xp_databus->set_datai(in_drs.scratch_pad_msg_clear, 0);
+			xp_databus->set_datai(in_drs.scratch_pad_msg_clear, 0, XPDataBus::req_priority::PRIO_UI);
+			in_cache->invalidate(in_drs.scratch_pad_msg_clear);
 		}
 	}
 
@@ -492,7 +491,7 @@ namespace StratosphereAvionics
 	{
 		while (!sim_shutdown.load(UPDATE_FLG_ORDR))
 		{
-			fmc_pages page = static_cast<fmc_pages>(xp_databus->get_datai(in_drs.curr_page));
+			fmc_pages page = static_cast<fmc_pages>(in_cache->get_val_i(in_drs.curr_page));
 			switch (page)
 			{
 			case fmc_pages::PAGE_REF_NAV_DATA:
@@ -502,6 +501,7 @@ namespace StratosphereAvionics
 				update_rte1();
 				continue;
 			default:
+				wait_for_inputs(page_watch);
 				continue;
 			}
 		}
@@ -511,6 +511,7 @@ namespace StratosphereAvionics
 	{
 		XPLMDebugString("777_FMS: Disabling fmc\n");
 		delete dr_cache;
+		delete in_cache;
 	}
 
 	FMC::~FMC()
@@ -520,6 +521,112 @@ namespace StratosphereAvionics
 
 	// Private member functions:
 
+	void FMC::reg_data_refs(fmc_in_drs* in, fmc_out_drs* out)
+	{
+		in_drs.sim_ac_lat_deg = xp_databus->reg_data_ref(in->sim_ac_lat_deg);
+		in_drs.sim_ac_lon_deg = xp_databus->reg_data_ref(in->sim_ac_lon_deg);
+
+		in_drs.ref_nav.poi_id = xp_databus->reg_data_ref(in->ref_nav.poi_id);
+		in_drs.ref_nav.rad_nav_inh = xp_databus->reg_data_ref(in->ref_nav.rad_nav_inh);
+		in_drs.ref_nav.in_navaids = xp_databus->reg_data_refs(&in->ref_nav.in_navaids);
+		in_drs.ref_nav.in_vors = xp_databus->reg_data_refs(&in->ref_nav.in_vors);
+
+		in_drs.rte1.dep_icao = xp_databus->reg_data_ref(in->rte1.dep_icao);
+		in_drs.rte1.arr_icao = xp_databus->reg_data_ref(in->rte1.arr_icao);
+		in_drs.rte1.dep_rnw = xp_databus->reg_data_ref(in->rte1.dep_rnw);
+
+		in_drs.sel_desired_wpt.curr_page = xp_databus->reg_data_ref(in->sel_desired_wpt.curr_page);
+		in_drs.sel_desired_wpt.poi_idx = xp_databus->reg_data_ref(in->sel_desired_wpt.poi_idx);
+
+		in_drs.scratch_pad_msg_clear = xp_databus->reg_data_ref(in->scratch_pad_msg_clear);
+		in_drs.curr_page = xp_databus->reg_data_ref(in->curr_page);
+
+		out_drs.ref_nav.poi_id = xp_databus->reg_data_ref(out->ref_nav.poi_id);
+		out_drs.ref_nav.poi_type = xp_databus->reg_data_ref(out->ref_nav.poi_type);
+		out_drs.ref_nav.poi_lat = xp_databus->reg_data_ref(out->ref_nav.poi_lat);
+		out_drs.ref_nav.poi_lon = xp_databus->reg_data_ref(out->ref_nav.poi_lon);
+		out_drs.ref_nav.poi_elevation = xp_databus->reg_data_ref(out->ref_nav.poi_elevation);
+		out_drs.ref_nav.poi_freq = xp_databus->reg_data_ref(out->ref_nav.poi_freq);
+		out_drs.ref_nav.poi_mag_var = xp_databus->reg_data_ref(out->ref_nav.poi_mag_var);
+		out_drs.ref_nav.poi_length_ft = xp_databus->reg_data_ref(out->ref_nav.poi_length_ft);
+		out_drs.ref_nav.poi_length_m = xp_databus->reg_data_ref(out->ref_nav.poi_length_m);
+
+		out_drs.sel_desired_wpt.is_active = xp_databus->reg_data_ref(out->sel_desired_wpt.is_active);
+		out_drs.sel_desired_wpt.n_subpages = xp_databus->reg_data_ref(out->sel_desired_wpt.n_subpages);
+		out_drs.sel_desired_wpt.n_pois = xp_databus->reg_data_ref(out->sel_desired_wpt.n_pois);
+		out_drs.sel_desired_wpt.poi_list = xp_databus->reg_data_ref(out->sel_desired_wpt.poi_list);
+		out_drs.sel_desired_wpt.poi_types = xp_databus->reg_data_refs(&out->sel_desired_wpt.poi_types);
+
+		out_drs.scratch_msg.not_in_db_idx = out->scratch_msg.not_in_db_idx;
+		out_drs.scratch_msg.dr_list = xp_databus->reg_data_refs(&out->scratch_msg.dr_list);
+	}
+
+	void FMC::add_watches()
+	{
+		std::vector<XPDataBus::batch_entry> drs = { {in_drs.curr_page, 0} };
+		page_watch = xp_databus->add_watch(&drs);
+
+		drs.push_back({ in_drs.scratch_pad_msg_clear, 0 });
+		std::vector<XPDataBus::batch_entry> ref_nav_drs = drs;
+		std::vector<XPDataBus::batch_entry> rte1_drs = drs;
+
+		ref_nav_drs.push_back({ in_drs.ref_nav.poi_id, 0 });
+		ref_nav_drs.push_back({ in_drs.ref_nav.rad_nav_inh, 0 });
+		for (size_t i = 0; i < in_drs.ref_nav.in_navaids.size(); i++)
+		{
+			ref_nav_drs.push_back({ in_drs.ref_nav.in_navaids[i], 0 });
+		}
+		for (size_t i = 0; i < in_drs.ref_nav.in_vors.size(); i++)
+		{
+			ref_nav_drs.push_back({ in_drs.ref_nav.in_vors[i], 0 });
+		}
+		ref_nav_watch = xp_databus->add_watch(&ref_nav_drs);
+
+		rte1_drs.push_back({ in_drs.rte1.dep_icao, 0 });
+		rte1_drs.push_back({ in_drs.rte1.arr_icao, 0 });
+		rte1_drs.push_back({ in_drs.rte1.dep_rnw, 0 });
+		rte1_watch = xp_databus->add_watch(&rte1_drs);
+
+		std::vector<XPDataBus::batch_entry> sel_des_wpt_drs = {
+			{out_drs.sel_desired_wpt.is_active, 0},
+			{in_drs.sel_desired_wpt.curr_page, 0},
+			{in_drs.sel_desired_wpt.poi_idx, 0}
+		};
+		sel_des_wpt_watch = xp_databus->add_watch(&sel_des_wpt_drs);
+	}
+
+	void FMC::bind_inputs()
+	{
+		std::vector<dr_hdl_t> inputs = {
+			in_drs.sim_ac_lat_deg, in_drs.sim_ac_lon_deg,
+			in_drs.ref_nav.poi_id, in_drs.ref_nav.rad_nav_inh,
+			in_drs.rte1.dep_icao, in_drs.rte1.arr_icao, in_drs.rte1.dep_rnw,
+			in_drs.sel_desired_wpt.curr_page, in_drs.sel_desired_wpt.poi_idx,
+			out_drs.sel_desired_wpt.is_active,
+			in_drs.scratch_pad_msg_clear, in_drs.curr_page
+		};
+		inputs.insert(inputs.end(), in_drs.ref_nav.in_navaids.begin(), 
+			in_drs.ref_nav.in_navaids.end());
+		inputs.insert(inputs.end(), in_drs.ref_nav.in_vors.begin(), 
+			in_drs.ref_nav.in_vors.end());
+
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			in_cache->bind(inputs[i], FMC_INPUT_MAX_AGE_SEC);
+		}
+	}
+
+	bool FMC::wait_for_inputs(XPDataBus::watch_handle_t watch)
+	{
+		bool is_changed = xp_databus->wait_for_change(watch, FMC_WATCH_TIMEOUT_MS);
+		if (is_changed)
+		{
+			// Whatever changed gets read in a single batch
+			in_cache->invalidate_all();
+		}
+		return is_changed;
+	}
+
 	int FMC::get_arrival_rwy_data(std::string rwy_id, libnav::runway_entry_t* out)
 	{
 		std::string arr_icao = avionics->get_fpln_arr_icao();
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <libxp/dr_cache.hpp>
+#include <libxp/rt_cache.hpp>
 #include <libxp/databus.hpp>
 #include <libtime/timer.hpp>
 #include <cstring>
@@ -44,6 +45,14 @@ namespace StratosphereAvionics
 	};
 
 	constexpr int N_CDU_OUT_LINES = 6;
+	// Pages are refreshed at least this often even if none of their inputs have changed
+	constexpr int FMC_WATCH_TIMEOUT_MS = 1000;
+	/*
+		Inputs are read through a cache. Watched inputs are invalidated
+		whenever a watch reports a change, so this only bounds the age
+		of the ones that aren't watched.
+	*/
+	constexpr double FMC_INPUT_MAX_AGE_SEC = 1.0;
 
 
 	struct fmc_ref_nav_in_drs
@@ -106,6 +115,67 @@ namespace StratosphereAvionics
 		// MISC
 		scratchpad_drs scratch_msg;
 	};
+
+	/*
+		The following structures mirror the ones above.
+		They hold DataBus handles of the datarefs instead of their names.
+	*/
+
+	typedef XPDataBus::dr_handle_t dr_hdl_t;
+
+	struct fmc_ref_nav_in_hdls
+	{
+		dr_hdl_t poi_id, rad_nav_inh;
+
+		std::vector<dr_hdl_t> in_navaids;
+		std::vector<dr_hdl_t> in_vors;
+	};
+
+	struct fmc_ref_nav_out_hdls
+	{
+		dr_hdl_t poi_id, poi_type, poi_lat, poi_lon, poi_elevation,
+			poi_freq, poi_mag_var, poi_length_ft, poi_length_m;
+	};
+
+	struct fmc_rte_hdls
+	{
+		dr_hdl_t dep_icao, arr_icao, dep_rnw;
+	};
+
+	struct fmc_sel_desired_wpt_in_hdls
+	{
+		dr_hdl_t curr_page, poi_idx;
+	};
+
+	struct fmc_sel_desired_wpt_out_hdls
+	{
+		dr_hdl_t is_active, n_subpages, n_pois, poi_list;
+
+		std::vector<dr_hdl_t> poi_types;
+	};
+
+	struct scratchpad_hdls
+	{
+		size_t not_in_db_idx;
+		std::vector<dr_hdl_t> dr_list;
+	};
+
+	struct fmc_in_hdls
+	{
+		dr_hdl_t sim_ac_lat_deg, sim_ac_lon_deg;
+
+		fmc_ref_nav_in_hdls ref_nav;
+		fmc_rte_hdls rte1;
+		fmc_sel_desired_wpt_in_hdls sel_desired_wpt;
+		dr_hdl_t scratch_pad_msg_clear, curr_page;
+	};
+
+	struct fmc_out_hdls
+	{
+		fmc_ref_nav_out_hdls ref_nav;
+		fmc_sel_desired_wpt_out_hdls sel_desired_wpt;
+		scratchpad_hdls scratch_msg;
+	};
 	
 
 	class FMC
@@ -126,9 +196,9 @@ namespace StratosphereAvionics
 									libnav::airport_data_t arpt_found, libnav::runway_entry_t rwy_found,
 									std::vector<libnav::waypoint_entry_t> wpts_found);
 
-		void reset_ref_nav_poi_data(std::vector<std::string>* nav_drs);
+		void reset_ref_nav_poi_data(std::vector<dr_hdl_t>* nav_drs);
 
-		void update_ref_nav_inhibit(std::vector<std::string>* nav_drs, libnav::NavaidType types,
+		void update_ref_nav_inhibit(std::vector<dr_hdl_t>* nav_drs, libnav::NavaidType types,
 									ref_nav threshold, bool add_vor);
 
 		int update_ref_nav(std::string icao); // Updates REF NAV DATA page
@@ -143,7 +213,7 @@ namespace StratosphereAvionics
 			Otherwise, returns false.
 		*/
 
-		bool update_rte_apt(std::string in_dr, libnav::airport_data_t* apt_data, 
+		bool update_rte_apt(dr_hdl_t in_dr, libnav::airport_data_t* apt_data, 
 			libnav::runway_data* rnw_data);
 
 		void update_rte1();
@@ -162,13 +232,26 @@ namespace StratosphereAvionics
 		std::shared_ptr<libnav::NavaidDB> navaid_db;
 		std::shared_ptr<libnav::ArptDB> apt_db;
 		std::shared_ptr<AvionicsSys> avionics;
-		fmc_in_drs in_drs;
-		fmc_out_drs out_drs;
+		fmc_in_hdls in_drs;
+		fmc_out_hdls out_drs;
 
 		std::shared_ptr<XPDataBus::DataBus> xp_databus;
 
-		XPDataBus::DataRefCache* dr_cache;
+		XPDataBus::DataRefCache* dr_cache; // Values that the pages have acted upon
+		XPDataBus::ReadThroughCache* in_cache;
+
+		// Inputs of each page. Page loops wait on these instead of polling.
+		XPDataBus::watch_handle_t page_watch, ref_nav_watch, rte1_watch, sel_des_wpt_watch;
+
+
+		void reg_data_refs(fmc_in_drs* in, fmc_out_drs* out);
+
+		void add_watches();
+
+		void bind_inputs();
 
+		// Returns true if any input of the watch has changed
+		bool wait_for_inputs(XPDataBus::watch_handle_t watch);
 
 		int get_arrival_rwy_data(std::string rwy_id, libnav::runway_entry_t* out);
 	};
@@ -50,9 +50,12 @@ namespace StratosphereAvionics
 				will be considered 0.
 				dz_roll: roll dead zone. Analagous to pitch dead zone.
 				dz_hdg: heading(yaw) dead zone. Analagous to pitch dead zone.
+				ap, roll_md, pitch_md, yoke_cmd: custom datarefs of the autopilot. These
+				are owned by the plugin's dataref registry and have been initialized already.
 			*/
 
-			InputFilter(float dz_pitch, float dz_roll, float dz_hdg)
+			InputFilter(float dz_pitch, float dz_roll, float dz_hdg, DRUtil::dref_i* ap, 
+				DRUtil::dref_i* roll_md, DRUtil::dref_i* pitch_md, DRUtil::dref_fa* yoke_cmd)
 			{
 				// Set up the dead zones
 
@@ -60,19 +63,20 @@ namespace StratosphereAvionics
 				dead_zone_roll = dz_roll;
 				dead_zone_hdg = dz_hdg;
 
+				ap_on = ap;
+				act_roll_mode = roll_md;
+				act_pitch_mode = pitch_md;
+				ap_yoke_cmd = yoke_cmd;
+
 				// Create all dataref structures
 
 				// Int datarefs
 				override_joy_pitch = { {"sim/operation/override/override_joystick_pitch", DR_WRITABLE, false, nullptr}, 0 };
 				override_joy_roll = { {"sim/operation/override/override_joystick_roll", DR_WRITABLE, false, nullptr}, 0 };
 				override_joy_hdg = { {"sim/operation/override/override_joystick_heading", DR_WRITABLE, false, nullptr}, 0 };
-				ap_on = { {"Strato/777/mcp/ap_on", DR_WRITABLE, false, nullptr}, 0 };
-				act_roll_mode = { {"Strato/777/fma/active_roll_mode", DR_WRITABLE, false, nullptr}, 0 };
-				act_pitch_mode = { {"Strato/777/fma/active_vert_mode", DR_WRITABLE, false, nullptr}, 0 };
 
 				// Float array datarefs
 				joy_axes = { {"sim/joystick/joy_mapped_axis_value", DR_WRITABLE, false, nullptr}, nullptr, JOY_DR_ARR_LENGTH };
-				ap_yoke_cmd = { {"Strato/777/autopilot/yoke_cmd", DR_WRITABLE, false, nullptr}, nullptr, 2 };
 
 				// Float datarefs
 				pitch_ratio = { {"sim/cockpit2/controls/yoke_pitch_ratio", DR_WRITABLE, false, nullptr}, 0 };
@@ -86,12 +90,8 @@ namespace StratosphereAvionics
 				stat *= override_joy_pitch.init();
 				stat *= override_joy_roll.init();
 				stat *= override_joy_hdg.init();
-				stat *= ap_on.init();
-				stat *= act_roll_mode.init();
-				stat *= act_pitch_mode.init();
 
 				stat *= joy_axes.init();
-				stat *= ap_yoke_cmd.init();
 
 				stat *= pitch_ratio.init();
 				stat *= roll_ratio.init();
@@ -123,9 +123,9 @@ namespace StratosphereAvionics
 			
 			void update_filter()
 			{
-				int curr_ap_status = ap_on.get();
-				int curr_roll_md = act_roll_mode.get();
-				int curr_pitch_md = act_pitch_mode.get();
+				int curr_ap_status = ap_on->get();
+				int curr_roll_md = act_roll_mode->get();
+				int curr_pitch_md = act_pitch_mode->get();
 
 				if(curr_ap_status == 0 || curr_roll_md == 0)
 				{
@@ -133,7 +133,7 @@ namespace StratosphereAvionics
 				}
 				else
 				{
-					update_dr(&ap_yoke_cmd, &roll_ratio, AP_ROLL_IDX, 0, 
+					update_dr(ap_yoke_cmd, &roll_ratio, AP_ROLL_IDX, 0, 
 						AUTOPILOT_INPUT_GAIN);
 				}
 				if(curr_ap_status == 0 || curr_pitch_md == 0)
@@ -142,7 +142,7 @@ namespace StratosphereAvionics
 				}
 				else
 				{
-					update_dr(&ap_yoke_cmd, &pitch_ratio, AP_PITCH_IDX, 0, 
+					update_dr(ap_yoke_cmd, &pitch_ratio, AP_PITCH_IDX, 0, 
 						AUTOPILOT_INPUT_GAIN);
 				}
 
@@ -199,10 +199,11 @@ namespace StratosphereAvionics
 
 			XPLMFlightLoopID flt_loop_id;
 
-			DRUtil::dref_i override_joy_pitch, override_joy_roll, override_joy_hdg,
-				ap_on, act_roll_mode, act_pitch_mode;
+			DRUtil::dref_i override_joy_pitch, override_joy_roll, override_joy_hdg;
+			DRUtil::dref_i *ap_on, *act_roll_mode, *act_pitch_mode;
 
-			DRUtil::dref_fa joy_axes, ap_yoke_cmd;
+			DRUtil::dref_fa joy_axes;
+			DRUtil::dref_fa* ap_yoke_cmd;
 			DRUtil::dref_f roll_ratio, pitch_ratio, hdg_ratio, fr_time;
 
 			/*
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "XPLMDataAccess.h"
+#include "small_str.hpp"
 #include <string>
 
 
@@ -58,6 +59,21 @@ inline void strip_str(std::string* src, std::string* dst)
 
 namespace XPDataBus
 {
+	/*
+		Handles are indices into the flat tables of datarefs/commands
+		owned by the data bus. They are obtained once via DataBus::reg_data_ref/reg_cmd.
+	*/
+
+	typedef int dr_handle_t;
+
+	constexpr dr_handle_t INVALID_DR_HANDLE = -1;
+
+	/*
+		Storage of a dataref owned by this plugin. ptr points to std::atomic<T>
+		for scalar types and to SeqBuf<T> for arrays and strings, so that it 
+		can be accessed from any thread.
+	*/
+
 	struct generic_ptr
 	{
 		void* ptr;
@@ -65,6 +81,12 @@ namespace XPDataBus
 		int n_length;
 	};
 
+	// Latitude and longitude in degrees
+	struct geo_point
+	{
+		double lat, lon;
+	};
+
 	struct generic_val
 	{
 		union
@@ -73,8 +95,65 @@ namespace XPDataBus
 			float float_val;
 			double double_val;
 		};
-		std::string str;
+		SmallStr str; // Doesn't allocate unless longer than SMALL_STR_CAP
 		int val_type;
 		int offset;
 	};
+
+
+	/*
+		The following functions convert a generic value to the requested type.
+		If the value holds none of the numeric types, 0 is returned.
+	*/
+
+	inline int get_gen_val_i(generic_val* val)
+	{
+		if (xplmType_Int & val->val_type)
+		{
+			return val->int_val;
+		}
+		else if (xplmType_Float & val->val_type)
+		{
+			return int(val->float_val);
+		}
+		else if (xplmType_Double & val->val_type)
+		{
+			return int(val->double_val);
+		}
+		return 0;
+	}
+
+	inline float get_gen_val_f(generic_val* val)
+	{
+		if (xplmType_Float & val->val_type)
+		{
+			return val->float_val;
+		}
+		else if (xplmType_Double & val->val_type)
+		{
+			return float(val->double_val);
+		}
+		else if (xplmType_Int & val->val_type)
+		{
+			return float(val->int_val);
+		}
+		return 0;
+	}
+
+	inline double get_gen_val_d(generic_val* val)
+	{
+		if (xplmType_Double & val->val_type)
+		{
+			return val->double_val;
+		}
+		else if (xplmType_Float & val->val_type)
+		{
+			return double(val->float_val);
+		}
+		else if (xplmType_Int & val->val_type)
+		{
+			return double(val->int_val);
+		}
+		return 0;
+	}
 }
@@ -0,0 +1,134 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains a reusable completion slot. Each thread that
+	makes blocking requests to the data bus owns one slot. The main thread
+	writes the result into the slot and bumps its sequence number, which
+	wakes up the requesting thread. Unlike std::promise, nothing is allocated
+	per request. The main thread only takes the lock if the requesting thread
+	has gone to sleep.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "common.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+namespace XPDataBus
+{
+	// Number of times the requesting thread polls the slot before going to sleep
+	constexpr int COMPLETION_N_SPIN = 64;
+	// Lowest bit of the slot's state. The rest is the number of completed requests.
+	constexpr uint64_t COMPLETION_SLEEPING = 1;
+	constexpr uint64_t COMPLETION_DONE_INC = 2;
+
+
+	class CompletionSlot
+	{
+	public:
+		// Results. Only written by the main thread between arm() and complete().
+		generic_val val;
+
+
+		CompletionSlot()
+		{
+			val = { {0}, "", 0, 0 };
+			n_armed = 0;
+			n_woken = 0;
+			state.store(0, std::memory_order_relaxed);
+			is_notifying.store(false, std::memory_order_relaxed);
+		}
+
+		CompletionSlot(const CompletionSlot&) = delete;
+
+		CompletionSlot& operator=(const CompletionSlot&) = delete;
+
+		// Ran from owning thread only:
+
+		/*
+			Returns a ticket that is passed to wait(). Only one request
+			can use the slot at a time.
+		*/
+
+		uint64_t arm()
+		{
+			return ++n_armed;
+		}
+
+		void wait(uint64_t ticket)
+		{
+			for (int i = 0; i < COMPLETION_N_SPIN; i++)
+			{
+				if (state.load(std::memory_order_acquire) / COMPLETION_DONE_INC >= ticket)
+				{
+					return;
+				}
+			}
+
+			/*
+			* The sleeping bit is set in the same word as the counter, so complete()
+			* either sees it or has finished with the slot before it was set.
+			*/
+			std::unique_lock<std::mutex> lock(slot_mutex);
+			uint64_t prev = state.fetch_or(COMPLETION_SLEEPING, std::memory_order_acq_rel);
+			if (prev / COMPLETION_DONE_INC < ticket)
+			{
+				slot_cv.wait(lock, [this, ticket]()
+					{
+						return n_woken >= ticket;
+					});
+			}
+			state.fetch_and(~COMPLETION_SLEEPING, std::memory_order_relaxed);
+		}
+
+		// Ran from main thread only:
+
+		void complete()
+		{
+			/*
+			* A waiter that hasn't gone to sleep may return as soon as the counter
+			* is bumped and its thread may exit, so the slot isn't touched after
+			* that unless the waiter is asleep. The waiter is notified after the
+			* lock is released, so it doesn't wake up only to block on the mutex.
+			* It may return before notify_one, so the destructor waits for 
+			* is_notifying to be cleared.
+			*/
+			uint64_t prev = state.fetch_add(COMPLETION_DONE_INC, std::memory_order_acq_rel);
+			if (prev & COMPLETION_SLEEPING)
+			{
+				is_notifying.store(true, std::memory_order_relaxed);
+				{
+					std::lock_guard<std::mutex> lock(slot_mutex);
+					n_woken = prev / COMPLETION_DONE_INC + 1;
+				}
+				slot_cv.notify_one();
+				is_notifying.store(false, std::memory_order_release);
+			}
+		}
+
+		~CompletionSlot()
+		{
+			while (is_notifying.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		uint64_t n_armed;
+		uint64_t n_woken; // Guarded by slot_mutex
+		std::atomic<uint64_t> state;
+		std::atomic<bool> is_notifying;
+		std::mutex slot_mutex;
+		std::condition_variable slot_cv;
+	};
+}
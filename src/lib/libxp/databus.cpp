@@ -11,12 +11,20 @@
 
 #include "databus.hpp"
 #include <iostream>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
 
 namespace XPDataBus
 {
 	DataBus::DataBus(std::vector<XPDataBus::cmd_entry>* cmds, 
-		std::vector<custom_data_ref_entry>* data_refs, uint64_t max_q_refresh,
-		std::string sign)
+		std::vector<custom_data_ref_entry>* data_refs, double budget_us,
+		std::string sign): mag_var_queue(MAG_VAR_QUEUE_SIZE), get_queue(GET_QUEUE_SIZE),
+		batch_get_queue(BATCH_GET_QUEUE_SIZE), 
+		set_queues{SET_QUEUE_SIZE, SET_QUEUE_SIZE, SET_QUEUE_SIZE}, 
+		watch_queue(WATCH_QUEUE_SIZE)
 	{
 		// Get plugin id
 		plug_id = XPLMFindPluginBySignature(sign.c_str());
@@ -55,7 +63,83 @@ namespace XPDataBus
 			custom_data_refs.insert(tmp);
 		}
 
-		max_queue_refresh = max_q_refresh;
+		cache_frame = 1;
+		direct_ptrs = new generic_ptr[N_MAX_DIRECT_DRS];
+		for (size_t i = 0; i < N_MAX_DIRECT_DRS; i++)
+		{
+			direct_ptrs[i] = { nullptr, 0, 0 };
+		}
+
+		snap_bufs = new snap_buf[N_SNAPSHOT_BUFS];
+		for (size_t i = 0; i < N_SNAPSHOT_BUFS; i++)
+		{
+			snap_bufs[i].seq.store(0, std::memory_order_relaxed);
+			for (size_t j = 0; j < N_MAX_SNAPSHOT_DRS; j++)
+			{
+				snap_val* curr = &snap_bufs[i].vals[j];
+				curr->raw.store(0, std::memory_order_relaxed);
+				curr->val_type.store(0, std::memory_order_relaxed);
+			}
+		}
+		snap_frame.store(0, ATOMIC_ORDR);
+		n_sets_dropped.store(0, ATOMIC_ORDR);
+		for (int i = 0; i < N_MAX_PRODUCERS; i++)
+		{
+			producers[i].store(nullptr, std::memory_order_relaxed);
+		}
+		n_producers.store(0, ATOMIC_ORDR);
+		shared_cnt.n_reqs.store(0, std::memory_order_relaxed);
+		shared_cnt.n_direct.store(0, std::memory_order_relaxed);
+		shared_cnt.wait_sum_ns.store(0, std::memory_order_relaxed);
+		shared_cnt.max_wait_ns.store(0, std::memory_order_relaxed);
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			rr_next[i] = 0;
+			queue_cnt[i].n_served.store(0, std::memory_order_relaxed);
+			queue_cnt[i].depth.store(0, std::memory_order_relaxed);
+			queue_cnt[i].max_depth.store(0, std::memory_order_relaxed);
+			for (int j = 0; j < N_LATENCY_BUCKETS; j++)
+			{
+				queue_cnt[i].latency_hist[j].store(0, std::memory_order_relaxed);
+			}
+		}
+		drain_cnt.n_frames.store(0, std::memory_order_relaxed);
+		drain_cnt.last_ns.store(0, std::memory_order_relaxed);
+		drain_cnt.sum_ns.store(0, std::memory_order_relaxed);
+		drain_cnt.max_ns.store(0, std::memory_order_relaxed);
+		for (int i = 0; i < N_LATENCY_BUCKETS; i++)
+		{
+			drain_cnt.hist[i].store(0, std::memory_order_relaxed);
+		}
+		dr_req_cnt = new std::atomic<uint64_t>[N_MAX_COUNTED_DRS];
+		for (size_t i = 0; i < N_MAX_COUNTED_DRS; i++)
+		{
+			dr_req_cnt[i].store(0, std::memory_order_relaxed);
+		}
+		is_dr_report_open = false;
+		n_report_drs = 0;
+		report_lookup_ns = 0;
+		is_publishing_stats = false;
+		mag_model_year = 0;
+		stats_dump_interval_ns = 0;
+		t_next_dump_ns = 0;
+		stats_writer = nullptr;
+		is_report_pending = false;
+		is_stats_writer_stopping = false;
+		for (int i = 0; i < N_PRIO_LANES; i++)
+		{
+			lane_cnt[i].n_applied.store(0, std::memory_order_relaxed);
+			lane_cnt[i].depth.store(0, std::memory_order_relaxed);
+			lane_cnt[i].max_depth.store(0, std::memory_order_relaxed);
+			lane_cnt[i].latency_sum_ns.store(0, std::memory_order_relaxed);
+			lane_cnt[i].max_latency_ns.store(0, std::memory_order_relaxed);
+		}
+
+		frame_budget_us = budget_us;
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			item_cost_us[i] = DRAIN_COST_INIT_US;
+		}
 		flt_loop_id = reg_flt_loop();
 		XPLMScheduleFlightLoop(flt_loop_id, 1, true);
 		is_operative.store(true, ATOMIC_ORDR);
@@ -135,518 +219,2259 @@ namespace XPDataBus
 		return out_path;
 	}
 
-	void DataBus::add_to_mag_var_queue(geo_point point, std::promise<float>* prom)
-	{
-		std::lock_guard<std::mutex> lock(mag_var_queue_mutex);
-		mag_var_queue.push(mag_var_req{ point, prom });
-	}
-
-	void DataBus::add_to_get_queue(std::string dr_name, std::promise<generic_val>* prom, int offset)
+	inline int64_t get_time_ns()
 	{
-		std::lock_guard<std::mutex> lock(get_queue_mutex);
-		get_queue.push(get_req{ dr_name, prom, offset });
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
 	}
 
-	XPLMDataRef DataBus::add_data_ref_entry(std::string* dr_name)
+	// Returns the log2 histogram bucket of a duration
+	inline int get_hist_bucket(uint64_t dur_ns)
 	{
-		size_t length = dr_name->length() + 1;
-		char* cstr = new char[length];
-		strcpy_safe(cstr, length, dr_name->c_str());
-		XPLMDataRef ref_ptr = XPLMFindDataRef(cstr);
-		delete[] cstr;
-		if (ref_ptr != nullptr)
+		uint64_t dur_us = dur_ns / 1000;
+		int bucket = 0;
+		while (dur_us > 1 && bucket < N_LATENCY_BUCKETS - 1)
 		{
-			data_refs[*dr_name] = data_ref_entry{ ref_ptr, XPLMGetDataRefTypes(ref_ptr) };
+			dur_us >>= 1;
+			bucket++;
 		}
-		return ref_ptr;
+		return bucket;
 	}
 
-	float DataBus::get_mag_var(double lat, double lon)
+	// Channel registered by the calling thread and the data bus it belongs to
+	thread_local producer_channel* tls_channel = nullptr;
+	thread_local DataBus* tls_channel_owner = nullptr;
+
+	CompletionSlot* DataBus::get_thread_slot()
 	{
-		std::promise<float> prom;
-		std::future<float> fut_val = prom.get_future();
-		add_to_mag_var_queue(geo_point{ lat, lon }, &prom);
-		return fut_val.get();
+		static thread_local CompletionSlot slot;
+		return &slot;
 	}
 
-	generic_val DataBus::get_data(std::string dr_name, int offset)
+	async_slot_pool* DataBus::get_thread_async_pool()
 	{
-		std::promise<generic_val> prom;
-		std::future<generic_val> fut_val = prom.get_future();
-		add_to_get_queue(dr_name, &prom, offset);
-		return fut_val.get();
+		static thread_local async_slot_pool pool;
+		return &pool;
 	}
 
-	int DataBus::get_datai(std::string dr_name, int offset)
+	producer_channel* DataBus::get_thread_channel()
 	{
-		if(!is_operative.load(ATOMIC_ORDR))
+		if (tls_channel_owner == this)
 		{
-			return 0;
+			return tls_channel;
 		}
-		generic_val val = get_data(dr_name, offset);
-		int ret_val = 0;
-		if (xplmType_Int & val.val_type)
+		return nullptr;
+	}
+
+	int DataBus::get_thread_channel_id()
+	{
+		producer_channel* chan = get_thread_channel();
+		if (chan != nullptr)
 		{
-			ret_val = val.int_val;
+			return chan->channel;
 		}
-		else if (xplmType_Float & val.val_type)
+		return SHARED_CHANNEL;
+	}
+
+	void DataBus::record_val(int kind, int channel, dr_handle_t dr, generic_val* val)
+	{
+		// Snapshot and watch reads of the main thread aren't requests, so they aren't counted
+		if (dr >= 0 && size_t(dr) < N_MAX_COUNTED_DRS && kind != REC_CMD && 
+			channel != MAIN_CHANNEL)
 		{
-			ret_val = int(val.float_val);
+			dr_req_cnt[size_t(dr)].fetch_add(1, std::memory_order_relaxed);
 		}
-		else if (xplmType_Double & val.val_type)
+		if (!recorder.is_on())
 		{
-			ret_val = int(val.double_val);
+			return;
 		}
-		return ret_val;
+		traffic_rec rec = { 0, kind, channel, dr, *val, 0, 0, false, 0 };
+		recorder.add(&rec);
 	}
 
-	float DataBus::get_dataf(std::string dr_name, int offset)
+	void DataBus::record_range(int kind, int channel, dr_handle_t dr, int offset, 
+		int val_type, void* vals, int n)
 	{
-		if(!is_operative.load(ATOMIC_ORDR))
-		{
-			return 0;
-		}
-		generic_val val = get_data(dr_name, offset);
-		float ret_val = 0;
-
-		if (xplmType_Float & val.val_type)
+		if (dr >= 0 && size_t(dr) < N_MAX_COUNTED_DRS)
 		{
-			ret_val = val.float_val;
+			dr_req_cnt[size_t(dr)].fetch_add(1, std::memory_order_relaxed);
 		}
-		else if (xplmType_Double & val.val_type)
+		if (!recorder.is_on())
 		{
-			ret_val = float(val.double_val);
+			return;
 		}
-		else if (xplmType_Int & val.val_type)
+		for (int i = 0; i < n; i++)
 		{
-			ret_val = float(val.int_val);
+			traffic_rec rec = { 0, kind, channel, dr, generic_val{ {0}, "", val_type, offset + i }, 
+				0, 0, false, 0 };
+			if (val_type == xplmType_IntArray)
+			{
+				rec.val.int_val = reinterpret_cast<int*>(vals)[i];
+			}
+			else
+			{
+				rec.val.float_val = reinterpret_cast<float*>(vals)[i];
+			}
+			recorder.add(&rec);
 		}
-		
-		return ret_val;
 	}
 
-	double DataBus::get_datad(std::string dr_name, int offset)
+	void DataBus::record_channel(int channel, std::string name)
 	{
-		if(!is_operative.load(ATOMIC_ORDR))
+		if (!recorder.is_on())
 		{
-			return 0;
+			return;
 		}
-		generic_val val = get_data(dr_name, offset);
-		double ret_val = 0;
+		traffic_rec rec = { 0, REC_CHANNEL, channel, INVALID_DR_HANDLE, 
+			generic_val{ {0}, name, 0, 0 }, 0, 0, false, 0 };
+		recorder.add(&rec);
+	}
 
-		if (xplmType_Double & val.val_type)
+	void DataBus::record_dr_name(dr_handle_t dr)
+	{
+		data_ref_entry* entry = get_dr_entry(dr);
+		if (!recorder.is_on() || entry == nullptr)
 		{
-			ret_val = val.double_val;
+			return;
 		}
-		else if (xplmType_Float & val.val_type)
+
+		traffic_rec rec = { 0, REC_DR_NAME, MAIN_CHANNEL, dr, 
+			generic_val{ {0}, entry->name, entry->dr_type, 0 }, 0, 0, entry->is_custom, 0 };
+		if (entry->is_custom)
 		{
-			ret_val = double(val.float_val);
+			rec.val.val_type = entry->custom_val.ptr_type;
+			rec.n_length = entry->custom_val.n_length;
 		}
-		else if (xplmType_Int & val.val_type)
+		else if (entry->ref != nullptr)
 		{
-			ret_val = double(val.int_val);
+			if (xplmType_IntArray & entry->dr_type)
+			{
+				rec.n_length = XPLMGetDatavi(entry->ref, nullptr, 0, 0);
+			}
+			else if (xplmType_FloatArray & entry->dr_type)
+			{
+				rec.n_length = XPLMGetDatavf(entry->ref, nullptr, 0, 0);
+			}
+			else if (xplmType_Data & entry->dr_type)
+			{
+				rec.n_length = XPLMGetDatab(entry->ref, nullptr, 0, 0);
+			}
 		}
-		
-		return ret_val;
+		recorder.add(&rec);
 	}
 
-	std::string DataBus::get_data_s(std::string dr_name, int offset)
+	producer_channel* DataBus::get_producer(int channel)
 	{
-		if(!is_operative.load(ATOMIC_ORDR))
+		if (channel <= SHARED_CHANNEL || channel > N_MAX_PRODUCERS)
 		{
-			return "";
+			return nullptr;
 		}
-		generic_val val = get_data(dr_name, offset);
-		return val.str;
-	}
-
-	void DataBus::cmd_once(std::string cmd_name)
-	{
-		std::lock_guard<std::mutex> lock(set_queue_mutex);
-		set_queue.push(set_req{ cmd_name, true, {} });
-	}
-
-	void DataBus::set_data(std::string dr_name, generic_val value)
-	{
-		std::lock_guard<std::mutex> lock(set_queue_mutex);
-		set_queue.push(set_req{ dr_name, false, value });
+		return producers[channel - 1].load(std::memory_order_acquire);
 	}
 
-	void DataBus::set_datai(std::string dr_name, int value, int offset)
+	channel_counters* DataBus::get_channel_counters(int channel)
 	{
-		int val_type = xplmType_Int;
-		if (offset >= 0)
+		producer_channel* chan = get_producer(channel);
+		if (chan != nullptr)
 		{
-			val_type = xplmType_IntArray;
+			return &chan->cnt;
 		}
-		generic_val tmp = { {0}, "", val_type, offset};
-		tmp.int_val = value;
-		set_data(dr_name, tmp);
+		return &shared_cnt;
 	}
 
-	void DataBus::set_dataf(std::string dr_name, float value, int offset)
+	void DataBus::count_req(int queue_id, int channel, int64_t t_queued_ns)
 	{
-		int val_type = xplmType_Float;
-		if (offset >= 0)
+		channel_counters* cnt = get_channel_counters(channel);
+		uint64_t wait_ns = uint64_t(std::max(int64_t(0), get_time_ns() - t_queued_ns));
+		cnt->n_reqs.fetch_add(1, std::memory_order_relaxed);
+		cnt->wait_sum_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+		if (wait_ns > cnt->max_wait_ns.load(std::memory_order_relaxed))
 		{
-			val_type = xplmType_FloatArray;
+			cnt->max_wait_ns.store(wait_ns, std::memory_order_relaxed);
 		}
-		generic_val tmp = { {0}, "", val_type, offset };
-		tmp.float_val = value;
-		set_data(dr_name, tmp);
-	}
 
-	void DataBus::set_datad(std::string dr_name, double value)
-	{
-		generic_val tmp = { {0}, "", xplmType_Double, 0 };
-		tmp.double_val = value;
-		set_data(dr_name, tmp);
+		queue_counters* q_cnt = &queue_cnt[queue_id];
+		q_cnt->n_served.fetch_add(1, std::memory_order_relaxed);
+		q_cnt->latency_hist[get_hist_bucket(wait_ns)].fetch_add(1, std::memory_order_relaxed);
 	}
 
-	void DataBus::set_data_s(std::string dr_name, std::string in, int offset)
+	void DataBus::count_direct(int channel)
 	{
-		/*
-		* This function is for custom datarefs only.
-		*/
-		generic_val tmp = { {0}, in, xplmType_Data, offset };
-		set_data(dr_name, tmp);
+		get_channel_counters(channel)->n_direct.fetch_add(1, std::memory_order_relaxed);
 	}
 
-	int DataBus::get_data_ref_value(std::string* dr_name, generic_val* out)
+	template <class T>
+	int DataBus::pop_next(int queue_id, MPSCRing<T>* shared_queue, 
+		SPSCRing<T> producer_channel::* queue, T* out)
 	{
-		/*
-		* This function gets a value of a dataref that isn't owned by this plugin
-		*/
-		int dr_set = 0;
-		data_ref_entry ref = data_refs[*dr_name];
-
-		if (xplmType_IntArray & ref.dr_type)
-		{
-			out->val_type = xplmType_Int;
-			return XPLMGetDatavi(ref.ref, &out->int_val, out->offset, 1);
-		}
-		else if (xplmType_FloatArray & ref.dr_type)
-		{
-			out->val_type = xplmType_Float;
-			return XPLMGetDatavf(ref.ref, &out->float_val, out->offset, 1);
-		}
-		else if (xplmType_Data & ref.dr_type)
+		int n_channels = std::min(n_producers.load(std::memory_order_acquire), 
+			N_MAX_PRODUCERS) + 1;
+		for (int i = 0; i < n_channels; i++)
 		{
-			out->val_type = xplmType_Data;
-			char buf[CHAR_BUF_SIZE+1] = {0};
-			dr_set = XPLMGetDatab(ref.ref, &buf, out->offset, CHAR_BUF_SIZE);
-			int n_val_written = dr_set - out->offset;
-			if (n_val_written <= CHAR_BUF_SIZE && n_val_written >= 0)
+			int channel = (rr_next[queue_id] + i) % n_channels;
+			bool is_popped = false;
+			if (channel == SHARED_CHANNEL)
 			{
-				buf[n_val_written] = 0;
+				is_popped = shared_queue->pop(out);
+			}
+			else
+			{
+				producer_channel* chan = get_producer(channel);
+				is_popped = chan != nullptr && (chan->*queue).pop(out);
 			}
-			out->str = buf;
-		}
 
-		if (xplmType_Int & ref.dr_type)
-		{
-			out->val_type |= xplmType_Int;
-			out->int_val = XPLMGetDatai(ref.ref);
-			dr_set = 1;
+			if (is_popped)
+			{
+				rr_next[queue_id] = channel + 1;
+				return channel;
+			}
 		}
-		if (xplmType_Float & ref.dr_type)
+		return -1;
+	}
+
+	void DataBus::add_to_mag_var_queue(mag_var_point* points, size_t n_points, 
+		CompletionSlot* slot)
+	{
+		mag_var_req req = { points, n_points, slot, get_time_ns() };
+		producer_channel* chan = get_thread_channel();
+		if (chan != nullptr)
 		{
-			out->val_type |= xplmType_Float;
-			out->float_val = XPLMGetDataf(ref.ref);
-			dr_set = 1;
+			chan->mag_var_queue.push(req);
 		}
-		if (xplmType_Double & ref.dr_type)
+		else
 		{
-			out->val_type |= xplmType_Double;
-			out->double_val = XPLMGetDatad(ref.ref);
-			dr_set = 1;
+			mag_var_queue.push(req);
 		}
-		
-		return dr_set;
 	}
 
-	int DataBus::get_custom_data_ref_value(std::string* dr_name, generic_val* out)
+	void DataBus::add_to_get_queue(dr_handle_t dr, CompletionSlot* slot, int offset, 
+		range_buf range)
 	{
-		/*
-		* This function gets a value of a dataref that is owned by this plugin
-		*/
-		int offset = out->offset;
-		generic_ptr ptr = custom_data_refs[*dr_name];
-		if (ptr.ptr_type == xplmType_Int)
-		{
-			out->val_type = xplmType_Int;
-			out->int_val = *reinterpret_cast<int*>(ptr.ptr);
-			return 1;
-		}
-		else if (ptr.ptr_type == xplmType_Float)
+		get_req req = { dr, slot, offset, get_time_ns(), range };
+		producer_channel* chan = get_thread_channel();
+		if (chan != nullptr)
 		{
-			out->val_type = xplmType_Float;
-			out->float_val = *reinterpret_cast<float*>(ptr.ptr);
-			return 1;
+			chan->get_queue.push(req);
 		}
-		else if (ptr.ptr_type == xplmType_Double)
+		else
 		{
-			out->val_type = xplmType_Double;
-			out->double_val = *reinterpret_cast<double*>(ptr.ptr);
-			return 1;
+			get_queue.push(req);
 		}
-		else if (xplmType_IntArray & ptr.ptr_type && offset < ptr.n_length)
+	}
+
+	void DataBus::add_to_batch_get_queue(std::vector<batch_entry>* drs, 
+		std::vector<generic_val>* out, CompletionSlot* slot)
+	{
+		batch_get_req req = { drs, out, slot, get_time_ns() };
+		producer_channel* chan = get_thread_channel();
+		if (chan != nullptr)
 		{
-			out->val_type = xplmType_Int;
-			out->int_val = reinterpret_cast<int*>(ptr.ptr)[offset];
-			return 1;
+			chan->batch_get_queue.push(req);
 		}
-		else if (xplmType_FloatArray & ptr.ptr_type && offset < ptr.n_length)
+		else
 		{
-			out->val_type = xplmType_Float;
-			out->float_val = reinterpret_cast<float*>(ptr.ptr)[offset];
-			return 1;
+			batch_get_queue.push(req);
 		}
-		else if (xplmType_Data & ptr.ptr_type && offset < ptr.n_length)
+	}
+
+	void DataBus::add_to_set_queue(set_req* req, req_priority prio)
+	{
+		generic_ptr* ptr = get_direct_ptr(req->dref);
+		if (!req->set_cmd && ptr != nullptr)
 		{
-			out->val_type = xplmType_Data;
-			char* data = reinterpret_cast<char*>(ptr.ptr);
-			for (int i = offset; i < ptr.n_length && data[i]; i++)
+			int channel = get_thread_channel_id();
+			count_direct(channel);
+			if (req->range_i.size())
 			{
-				out->str.push_back(data[i]);
+				set_custom_range(ptr, req);
+				record_range(REC_SET, channel, req->dref, req->val.offset, xplmType_IntArray, 
+					req->range_i.data(), int(req->range_i.size()));
 			}
-			return 1;
+			else if (req->range_f.size())
+			{
+				set_custom_range(ptr, req);
+				record_range(REC_SET, channel, req->dref, req->val.offset, xplmType_FloatArray, 
+					req->range_f.data(), int(req->range_f.size()));
+			}
+			else
+			{
+				set_custom_data_ref(ptr, &req->val);
+				record_val(REC_SET, channel, req->dref, &req->val);
+			}
+			return;
 		}
-		return 0;
-	}
 
-	void DataBus::trigger_cmd_once(std::string* cmd_name)
-	{
-		if(all_cmds.find(*cmd_name) != all_cmds.end())
+		producer_channel* chan = get_thread_channel();
+		if (chan != nullptr)
 		{
-			XPLMCommandOnce(all_cmds[*cmd_name]);
+			chan->set_queues[static_cast<int>(prio)].push(std::move(*req));
 		}
 		else
 		{
-			XPLMCommandRef ref = XPLMFindCommand(cmd_name->c_str());
-
-			if(ref != nullptr)
-			{
-				all_cmds[*cmd_name] = ref;
-				XPLMCommandOnce(ref);
-			}
+			set_queues[static_cast<int>(prio)].push(std::move(*req));
 		}
 	}
 
-	void DataBus::set_data_ref_value(std::string* dr_name, generic_val* in)
+	void DataBus::add_to_watch_queue(watch_handle_t watch, CompletionSlot* slot, int timeout_ms)
 	{
-		/*
-		* This function sets a value of a dataref that isn't owned by this plugin
-		*/
-		data_ref_entry ref = data_refs[*dr_name];
-		if (ref.dr_type == xplmType_Int)
+		int64_t t_now = get_time_ns();
+		watch_req req = { watch, slot, t_now + int64_t(timeout_ms) * 1000000, t_now };
+		producer_channel* chan = get_thread_channel();
+		if (chan != nullptr)
 		{
-			XPLMSetDatai(ref.ref, in->int_val);
+			chan->watch_queue.push(req);
 		}
-		else if (ref.dr_type == xplmType_Float)
+		else
 		{
-			XPLMSetDataf(ref.ref, in->float_val);
+			watch_queue.push(req);
 		}
-		else if (ref.dr_type == xplmType_Double)
+	}
+
+	dr_handle_t DataBus::reg_data_ref(std::string dr_name)
+	{
+		int64_t t_start = get_time_ns();
+		bool is_new = false;
+		dr_handle_t hdl = add_data_ref_entry(dr_name, &is_new);
+		if (!is_new)
 		{
-			XPLMSetDatad(ref.ref, in->double_val);
+			return hdl;
 		}
-		else if (xplmType_IntArray & ref.dr_type)
+
+		bool is_found = is_resolved(hdl);
+		if (is_dr_report_open)
 		{
-			XPLMSetDatavi(data_refs[*dr_name].ref, &in->int_val, in->offset, 1);
+			n_report_drs++;
+			report_lookup_ns += get_time_ns() - t_start;
+			if (!is_found)
+			{
+				report_unresolved.push_back(dr_name);
+			}
 		}
-		else if (xplmType_FloatArray & data_refs[*dr_name].dr_type)
+		else if (!is_found)
 		{
-			XPLMSetDatavf(data_refs[*dr_name].ref, &in->float_val, in->offset, 1);
+			std::string tmp = "777_FMS: Failed to find dataref: " + dr_name + "\n";
+			XPLMDebugString(tmp.c_str());
 		}
+		return hdl;
 	}
 
-	void DataBus::set_custom_data_ref_value(std::string* dr_name, generic_val* in)
+	dr_handle_t DataBus::add_data_ref_entry(std::string dr_name, bool* is_new)
 	{
+		if (dr_handles.find(dr_name) != dr_handles.end())
+		{
+			*is_new = false;
+			return dr_handles.at(dr_name);
+		}
+		*is_new = true;
+
 		/*
-		* This function sets a value of a dataref that is owned by this plugin.
+			Entries of datarefs that weren't found are kept with ref set to nullptr,
+			so misspelled names are only searched for once.
 		*/
-		generic_ptr ptr = custom_data_refs[*dr_name];
-		if (ptr.ptr_type == xplmType_Int)
+
+		data_ref_entry entry = { dr_name, nullptr, xplmType_Unknown, false, {nullptr, 0, 0}, 
+			-1, 0, {}, {} };
+		if (custom_data_refs.find(dr_name) != custom_data_refs.end())
 		{
-			*reinterpret_cast<int*>(ptr.ptr) = in->int_val;
+			entry.is_custom = true;
+			entry.custom_val = custom_data_refs.at(dr_name);
 		}
-		else if (ptr.ptr_type == xplmType_Float)
+		else
 		{
-			*reinterpret_cast<float*>(ptr.ptr) = in->float_val;
+			entry.ref = XPLMFindDataRef(dr_name.c_str());
+			if (entry.ref != nullptr)
+			{
+				entry.dr_type = XPLMGetDataRefTypes(entry.ref);
+			}
 		}
-		else if (ptr.ptr_type == xplmType_Double)
+
+		dr_handle_t hdl = dr_handle_t(dr_entries.size());
+		dr_entries.push_back(entry);
+		dr_handles[dr_name] = hdl;
+		if (entry.is_custom && size_t(hdl) < N_MAX_DIRECT_DRS)
 		{
-			*reinterpret_cast<double*>(ptr.ptr) = in->double_val;
+			direct_ptrs[size_t(hdl)] = entry.custom_val;
 		}
-		else if (xplmType_IntArray & ptr.ptr_type)
+		record_dr_name(hdl);
+		return hdl;
+	}
+
+	bool DataBus::is_resolved(dr_handle_t dr)
+	{
+		data_ref_entry* entry = get_dr_entry(dr);
+		return entry != nullptr && (entry->is_custom || entry->ref != nullptr);
+	}
+
+	std::vector<dr_handle_t> DataBus::reg_data_refs(std::vector<std::string>* dr_names)
+	{
+		std::vector<dr_handle_t> out;
+		for (size_t i = 0; i < dr_names->size(); i++)
 		{
-			reinterpret_cast<int*>(ptr.ptr)[in->offset] = in->int_val;
+			out.push_back(reg_data_ref(dr_names->at(i)));
 		}
-		else if (xplmType_FloatArray & ptr.ptr_type)
+		return out;
+	}
+
+	void DataBus::begin_dr_report()
+	{
+		is_dr_report_open = true;
+		n_report_drs = 0;
+		report_lookup_ns = 0;
+		report_unresolved.clear();
+	}
+
+	size_t DataBus::end_dr_report()
+	{
+		is_dr_report_open = false;
+		double t_ms = double(report_lookup_ns) / 1000000.0;
+
+		std::string tmp = "777_FMS: Resolved " + std::to_string(n_report_drs) + " datarefs in " + 
+			std::to_string(t_ms) + " ms, " + std::to_string(report_unresolved.size()) + 
+			" unresolved\n";
+		for (size_t i = 0; i < report_unresolved.size(); i++)
 		{
-			reinterpret_cast<float*>(ptr.ptr)[in->offset] = in->float_val;
+			tmp += "777_FMS: Failed to find dataref: " + report_unresolved[i] + "\n";
 		}
-		else if (xplmType_Data & ptr.ptr_type)
-		{
-			char* data = reinterpret_cast<char*>(ptr.ptr);
-			int data_length = ptr.n_length - in->offset;
-			int str_length = int(in->str.length());
+		XPLMDebugString(tmp.c_str());
 
-			if (str_length <= 1 && in->offset == -1) // Set all elements of output string to 1 character
-			{
-				char c = 0;
-				if (str_length)
-				{
-					c = in->str.at(0);
-				}
-				for(int i = 0; i < ptr.n_length; i++)
-				{
-					data[i] = c;
-				}
-			}
-			else
-			{
-				for (int i = 0; i < data_length; i++)
-				{
-					if (i < str_length)
-					{
-						data[i + in->offset] = in->str.at(size_t(i));
-					}
-					else
-					{
-						data[i + in->offset] = DEFAULT_STR_FILL_CHAR;
-					}
-				}
-			}
-		}
+		size_t n_unresolved = report_unresolved.size();
+		report_unresolved.clear();
+		return n_unresolved;
 	}
 
-	int DataBus::get_data_ref(std::string* dr_name, generic_val* out)
+	dr_handle_t DataBus::reg_cmd(std::string cmd_name)
 	{
-		XPLMDataRef ref_ptr = nullptr;
-		if (data_refs.find(*dr_name) != data_refs.end())
+		if (cmd_handles.find(cmd_name) != cmd_handles.end())
 		{
-			ref_ptr = data_refs[*dr_name].ref;
+			return cmd_handles.at(cmd_name);
 		}
-		else
+
+		XPLMCommandRef ref = nullptr;
+		if (all_cmds.find(cmd_name) != all_cmds.end())
 		{
-			ref_ptr = add_data_ref_entry(dr_name);
+			ref = all_cmds.at(cmd_name);
 		}
-		if (ref_ptr != nullptr)
+		else
 		{
-			return get_data_ref_value(dr_name, out);
+			ref = XPLMFindCommand(cmd_name.c_str());
 		}
-		return 0;
+
+		dr_handle_t hdl = dr_handle_t(cmd_entries.size());
+		cmd_entries.push_back(ref);
+		cmd_handles[cmd_name] = hdl;
+		return hdl;
 	}
 
-	int DataBus::get_custom_data_ref(std::string* dr_name, generic_val* out)
+	std::string DataBus::get_dr_name(dr_handle_t dr)
 	{
-		if (custom_data_refs.find(*dr_name) != custom_data_refs.end())
+		data_ref_entry* entry = get_dr_entry(dr);
+		if (entry != nullptr)
 		{
-			return get_custom_data_ref_value(dr_name, out);
+			return entry->name;
 		}
-		return 0;
+		return "";
 	}
 
-	int DataBus::set_data_ref(std::string* dr_name, generic_val* in)
+	snap_handle_t DataBus::subscribe(dr_handle_t dr, int offset)
 	{
-		XPLMDataRef ref_ptr = nullptr;
-		if (data_refs.find(*dr_name) != data_refs.end())
-		{
-			ref_ptr = data_refs[*dr_name].ref;
-		}
-		else
+		std::pair<dr_handle_t, int> key = std::make_pair(dr, offset);
+		if (snap_handles.find(key) != snap_handles.end())
 		{
-			ref_ptr = add_data_ref_entry(dr_name);
+			return snap_handles.at(key);
 		}
-		if (ref_ptr != nullptr)
+		if (snap_drs.size() >= N_MAX_SNAPSHOT_DRS)
 		{
-			if (data_refs[*dr_name].dr_type & in->val_type)
-			{
-				set_data_ref_value(dr_name, in);
-				return 1;
-			}
-			return 3;
+			std::string tmp = "777_FMS: Snapshot is full. Failed to subscribe to: " + 
+				get_dr_name(dr) + "\n";
+			XPLMDebugString(tmp.c_str());
+			return INVALID_SNAP_HANDLE;
 		}
-		return 0;
+
+		snap_handle_t hdl = snap_handle_t(snap_drs.size());
+		snap_drs.push_back({ dr, offset });
+		snap_handles[key] = hdl;
+		return hdl;
 	}
 
-	int DataBus::set_custom_data_ref(std::string* dr_name, generic_val* in)
+	std::vector<snap_handle_t> DataBus::subscribe(std::vector<batch_entry>* drs)
 	{
-		if (custom_data_refs.find(*dr_name) != custom_data_refs.end())
+		std::vector<snap_handle_t> out;
+		for (size_t i = 0; i < drs->size(); i++)
 		{
-			if (custom_data_refs[*dr_name].ptr_type & in->val_type)
-			{
-				set_custom_data_ref_value(dr_name, in);
-				return 1;
-			}
-			return 3;
+			out.push_back(subscribe(drs->at(i).dref, drs->at(i).offset));
 		}
-		return 0;
+		return out;
 	}
 
-	void DataBus::get_xplm_mag_var()
+	watch_handle_t DataBus::add_watch(std::vector<batch_entry>* drs)
 	{
-		uint64_t counter = 0;
-		while (mag_var_queue.size() && counter < max_queue_refresh)
-		{
-			std::lock_guard<std::mutex> lock(mag_var_queue_mutex);
-			mag_var_req data = mag_var_queue.front();
-			mag_var_queue.pop();
-
-			float mag_var = XPLMGetMagneticVariation(data.point.lat, data.point.lon);
+		watch_handle_t hdl = watch_handle_t(watches.size());
+		watches.push_back({ *drs, {} });
+		update_watch_vals(&watches.back());
+		return hdl;
+	}
 
-			data.prom->set_value(mag_var);
+	bool DataBus::reg_producer(std::string name)
+	{
+		if (get_thread_channel() != nullptr)
+		{
+			return true;
+		}
 
-			counter++;
+		int idx = n_producers.fetch_add(1);
+		if (idx >= N_MAX_PRODUCERS)
+		{
+			std::string tmp = "777_FMS: Out of databus channels. " + name + 
+				" will use the shared one\n";
+			XPLMDebugString(tmp.c_str());
+			return false;
 		}
+
+		producer_channel* chan = new producer_channel(name, idx + 1);
+		producers[idx].store(chan, std::memory_order_release);
+		tls_channel = chan;
+		tls_channel_owner = this;
+		record_channel(chan->channel, name);
+		return true;
 	}
 
-	void DataBus::get_data_refs()
+	template <class Q>
+	uint64_t DataBus::get_full_wait_ns(Q* q)
 	{
-		uint64_t counter = 0;
-		while (get_queue.size() && counter < max_queue_refresh)
+		uint64_t out = q->mag_var_queue.get_full_wait_ns() + q->get_queue.get_full_wait_ns() + 
+			q->batch_get_queue.get_full_wait_ns() + q->watch_queue.get_full_wait_ns();
+		for (int i = 0; i < N_PRIO_LANES; i++)
 		{
-			std::lock_guard<std::mutex> lock(get_queue_mutex);
-			get_req data = get_queue.front();
-			get_queue.pop();
-			generic_val tmp = { {0}, "", 0, data.offset};
-			if (get_custom_data_ref(&data.dref, &tmp) != 1)
+			out += q->set_queues[i].get_full_wait_ns();
+		}
+		return out;
+	}
+
+	std::vector<channel_stats> DataBus::get_channel_stats()
+	{
+		std::vector<channel_stats> out;
+		int n_channels = std::min(n_producers.load(std::memory_order_acquire), 
+			N_MAX_PRODUCERS) + 1;
+		for (int i = 0; i < n_channels; i++)
+		{
+			producer_channel* chan = get_producer(i);
+			if (i != SHARED_CHANNEL && chan == nullptr)
+			{
+				continue;
+			}
+
+			channel_counters* cnt = get_channel_counters(i);
+			channel_stats st = { i == SHARED_CHANNEL ? "shared" : chan->name, 0, 0, 0, 0, 0 };
+			st.n_reqs = cnt->n_reqs.load(std::memory_order_relaxed);
+			st.n_direct = cnt->n_direct.load(std::memory_order_relaxed);
+			if (st.n_reqs)
+			{
+				st.avg_wait_us = double(cnt->wait_sum_ns.load(std::memory_order_relaxed)) / 
+					double(st.n_reqs) / 1000.0;
+			}
+			st.max_wait_us = double(cnt->max_wait_ns.load(std::memory_order_relaxed)) / 1000.0;
+			if (i == SHARED_CHANNEL)
+			{
+				st.blocked_us = double(get_full_wait_ns(this)) / 1000.0;
+			}
+			else
+			{
+				st.blocked_us = double(get_full_wait_ns(chan)) / 1000.0;
+			}
+			out.push_back(st);
+		}
+		return out;
+	}
+
+	queue_stats DataBus::get_queue_stats(drain_queue_id queue_id)
+	{
+		queue_stats out;
+		queue_counters* cnt = &queue_cnt[queue_id];
+		out.n_served = cnt->n_served.load(std::memory_order_relaxed);
+		out.depth = cnt->depth.load(std::memory_order_relaxed);
+		out.max_depth = cnt->max_depth.load(std::memory_order_relaxed);
+		for (int i = 0; i < N_LATENCY_BUCKETS; i++)
+		{
+			out.latency_hist[i] = cnt->latency_hist[i].load(std::memory_order_relaxed);
+		}
+		return out;
+	}
+
+	drain_stats DataBus::get_drain_stats()
+	{
+		drain_stats out;
+		out.n_frames = drain_cnt.n_frames.load(std::memory_order_relaxed);
+		out.last_us = double(drain_cnt.last_ns.load(std::memory_order_relaxed)) / 1000.0;
+		out.avg_us = 0;
+		if (out.n_frames)
+		{
+			out.avg_us = double(drain_cnt.sum_ns.load(std::memory_order_relaxed)) / 
+				double(out.n_frames) / 1000.0;
+		}
+		out.max_us = double(drain_cnt.max_ns.load(std::memory_order_relaxed)) / 1000.0;
+		for (int i = 0; i < N_LATENCY_BUCKETS; i++)
+		{
+			out.hist[i] = drain_cnt.hist[i].load(std::memory_order_relaxed);
+		}
+		return out;
+	}
+
+	float DataBus::get_mag_var(double lat, double lon)
+	{
+		geo_point point = { lat, lon };
+		float out = 0;
+		get_mag_vars(&point, &out, 1);
+		return out;
+	}
+
+	void DataBus::get_mag_var_batch(std::vector<geo_point>* points, std::vector<float>* out)
+	{
+		out->assign(points->size(), 0);
+		get_mag_vars(points->data(), out->data(), points->size());
+	}
+
+	void DataBus::get_mag_vars(geo_point* points, float* out, size_t n)
+	{
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return;
+		}
+		if (mag_model.is_loaded())
+		{
+			mag_model.get_mag_var_batch(points, out, n, 0, mag_model_year);
+			return;
+		}
+
+		/*
+		* Nodes that are missing from the grid are requested once each. 
+		* Points that aren't cached at all are requested as they are.
+		* Their results are matched up by index in the request.
+		*/
+		std::vector<mag_var_point> req_points;
+		std::vector<mag_var_cell> cells(n);
+		std::vector<int> req_idx(n, -1);
+		for (size_t i = 0; i < n; i++)
+		{
+			if (!mag_var_grid.get_cell(points[i].lat, points[i].lon, &cells[i]))
+			{
+				req_idx[i] = int(req_points.size());
+				req_points.push_back({ points[i], -1, 0 });
+				continue;
+			}
+			for (int j = 0; j < N_MAG_VAR_CELL_NODES; j++)
+			{
+				int node = cells[i].nodes[j];
+				if (mag_var_grid.has_node(node))
+				{
+					continue;
+				}
+				bool is_dup = false;
+				for (size_t k = 0; k < req_points.size() && !is_dup; k++)
+				{
+					is_dup = req_points[k].node == node;
+				}
+				if (!is_dup)
+				{
+					geo_point node_pos = { MagVarGrid::get_node_lat(node), 
+						MagVarGrid::get_node_lon(node) };
+					req_points.push_back({ node_pos, node, 0 });
+				}
+			}
+		}
+
+		if (req_points.size())
+		{
+			CompletionSlot* slot = get_thread_slot();
+			uint64_t ticket = slot->arm();
+			add_to_mag_var_queue(req_points.data(), req_points.size(), slot);
+			slot->wait(ticket);
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			if (req_idx[i] >= 0)
+			{
+				out[i] = req_points[size_t(req_idx[i])].mag_var;
+			}
+			else if (!mag_var_grid.interpolate(&cells[i], &out[i]))
+			{
+				// Only happens if the data bus was shut down while waiting
+				out[i] = 0;
+			}
+		}
+	}
+
+	generic_val DataBus::get_data(dr_handle_t dr, int offset)
+	{
+		generic_ptr* ptr = get_direct_ptr(dr);
+		if (ptr != nullptr)
+		{
+			int channel = get_thread_channel_id();
+			generic_val tmp = get_direct_val(ptr, offset);
+			count_direct(channel);
+			record_val(REC_GET, channel, dr, &tmp);
+			return tmp;
+		}
+		CompletionSlot* slot = get_thread_slot();
+		uint64_t ticket = slot->arm();
+		add_to_get_queue(dr, slot, offset);
+		slot->wait(ticket);
+		return std::move(slot->val);
+	}
+
+	int DataBus::get_datai(dr_handle_t dr, int offset)
+	{
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return 0;
+		}
+		generic_val val = get_data(dr, offset);
+		return get_gen_val_i(&val);
+	}
+
+	float DataBus::get_dataf(dr_handle_t dr, int offset)
+	{
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return 0;
+		}
+		generic_val val = get_data(dr, offset);
+		return get_gen_val_f(&val);
+	}
+
+	double DataBus::get_datad(dr_handle_t dr, int offset)
+	{
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return 0;
+		}
+		generic_val val = get_data(dr, offset);
+		return get_gen_val_d(&val);
+	}
+
+	std::string DataBus::get_data_s(dr_handle_t dr, int offset)
+	{
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return "";
+		}
+		generic_val val = get_data(dr, offset);
+		return val.str.to_string();
+	}
+
+	async_get DataBus::get_data_async(dr_handle_t dr, int offset)
+	{
+		async_get out = { -1, 0, generic_val{ {0}, "", 0, 0 } };
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return out;
+		}
+		async_slot_pool* pool = get_thread_async_pool();
+		int idx = -1;
+		if (get_direct_ptr(dr) == nullptr)
+		{
+			for (int i = 0; i < N_ASYNC_SLOTS && idx == -1; i++)
+			{
+				if (!pool->is_busy[i])
+				{
+					idx = i;
+				}
+			}
+		}
+		if (idx == -1)
+		{
+			// Plugin-owned datarefs are read right away, as are reads that find no free slot
+			out.val = get_data(dr, offset);
+			return out;
+		}
+		pool->is_busy[idx] = true;
+		out.slot_idx = idx;
+		out.ticket = pool->slots[idx].arm();
+		add_to_get_queue(dr, &pool->slots[idx], offset);
+		return out;
+	}
+
+	generic_val DataBus::get_async_val(async_get* req)
+	{
+		if (req->slot_idx == -1)
+		{
+			return std::move(req->val);
+		}
+		async_slot_pool* pool = get_thread_async_pool();
+		CompletionSlot* slot = &pool->slots[req->slot_idx];
+		slot->wait(req->ticket);
+		generic_val out = std::move(slot->val);
+		pool->is_busy[req->slot_idx] = false;
+		req->slot_idx = -1;
+		return out;
+	}
+
+	int DataBus::get_datavi(dr_handle_t dr, std::vector<int>* out, int offset, int n)
+	{
+		out->assign(size_t(std::max(n, 0)), 0);
+		range_buf range = { out->data(), xplmType_IntArray, n };
+		int n_read = get_range(dr, offset, &range);
+		out->resize(size_t(n_read));
+		return n_read;
+	}
+
+	int DataBus::get_datavf(dr_handle_t dr, std::vector<float>* out, int offset, int n)
+	{
+		out->assign(size_t(std::max(n, 0)), 0);
+		range_buf range = { out->data(), xplmType_FloatArray, n };
+		int n_read = get_range(dr, offset, &range);
+		out->resize(size_t(n_read));
+		return n_read;
+	}
+
+	void DataBus::get_data_batch(std::vector<batch_entry>* drs, std::vector<generic_val>* out)
+	{
+		out->assign(drs->size(), generic_val{ {0}, "", 0, 0 });
+		if(!is_operative.load(ATOMIC_ORDR) || drs->size() == 0)
+		{
+			return;
+		}
+
+		bool all_direct = true;
+		for (size_t i = 0; i < drs->size() && all_direct; i++)
+		{
+			all_direct = get_direct_ptr(drs->at(i).dref) != nullptr;
+		}
+		if (all_direct)
+		{
+			int channel = get_thread_channel_id();
+			for (size_t i = 0; i < drs->size(); i++)
+			{
+				out->at(i) = get_direct_val(get_direct_ptr(drs->at(i).dref), 
+					drs->at(i).offset);
+				record_val(REC_GET, channel, drs->at(i).dref, &out->at(i));
+			}
+			count_direct(channel);
+			return;
+		}
+
+		CompletionSlot* slot = get_thread_slot();
+		uint64_t ticket = slot->arm();
+		add_to_batch_get_queue(drs, out, slot);
+		slot->wait(ticket);
+	}
+
+	uint64_t DataBus::get_snapshot(std::vector<snap_handle_t>* hdls, std::vector<generic_val>* out)
+	{
+		out->assign(hdls->size(), generic_val{ {0}, "", 0, 0 });
+		while (true)
+		{
+			uint64_t frame = snap_frame.load(std::memory_order_acquire);
+			if (frame == 0)
+			{
+				return 0;
+			}
+			snap_buf* buf = &snap_bufs[frame % N_SNAPSHOT_BUFS];
+			uint64_t seq_start = buf->seq.load(std::memory_order_acquire);
+			if (seq_start != 2 * frame)
+			{
+				/*
+				* The main thread has already moved on to the next frames 
+				* and is overwriting this buffer.
+				*/
+				continue;
+			}
+
+			for (size_t i = 0; i < hdls->size(); i++)
+			{
+				snap_handle_t hdl = hdls->at(i);
+				if (hdl < 0 || size_t(hdl) >= N_MAX_SNAPSHOT_DRS)
+				{
+					continue;
+				}
+				snap_val* src = &buf->vals[size_t(hdl)];
+				generic_val* dst = &out->at(i);
+				uint64_t raw = src->raw.load(std::memory_order_relaxed);
+				std::memcpy(&dst->double_val, &raw, sizeof(raw));
+				dst->val_type = src->val_type.load(std::memory_order_relaxed);
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (buf->seq.load(std::memory_order_relaxed) == seq_start)
+			{
+				return frame;
+			}
+		}
+	}
+
+	bool DataBus::wait_for_change(watch_handle_t watch, int timeout_ms)
+	{
+		if(!is_operative.load(ATOMIC_ORDR))
+		{
+			return false;
+		}
+		CompletionSlot* slot = get_thread_slot();
+		uint64_t ticket = slot->arm();
+		add_to_watch_queue(watch, slot, timeout_ms);
+		slot->wait(ticket);
+		return slot->val.int_val != 0;
+	}
+
+	uint64_t DataBus::get_n_sets_dropped()
+	{
+		return n_sets_dropped.load(std::memory_order_relaxed);
+	}
+
+	lane_stats DataBus::get_lane_stats(req_priority prio)
+	{
+		lane_stats out = {0, 0, 0, 0, 0};
+		int lane = static_cast<int>(prio);
+		if (lane < 0 || lane >= N_PRIO_LANES)
+		{
+			return out;
+		}
+
+		lane_counters* cnt = &lane_cnt[lane];
+		out.n_applied = cnt->n_applied.load(std::memory_order_relaxed);
+		out.depth = cnt->depth.load(std::memory_order_relaxed);
+		out.max_depth = cnt->max_depth.load(std::memory_order_relaxed);
+		if (out.n_applied)
+		{
+			out.avg_latency_us = double(cnt->latency_sum_ns.load(std::memory_order_relaxed)) / 
+				double(out.n_applied) / 1000.0;
+		}
+		out.max_latency_us = double(cnt->max_latency_ns.load(std::memory_order_relaxed)) / 1000.0;
+		return out;
+	}
+
+	void DataBus::cmd_once(dr_handle_t cmd, req_priority prio)
+	{
+		set_req req = { cmd, true, {}, get_time_ns(), SHARED_CHANNEL, {}, {} };
+		add_to_set_queue(&req, prio);
+	}
+
+	void DataBus::set_data(dr_handle_t dr, generic_val value, req_priority prio)
+	{
+		set_req req = { dr, false, std::move(value), get_time_ns(), SHARED_CHANNEL, {}, {} };
+		add_to_set_queue(&req, prio);
+	}
+
+	void DataBus::set_datai(dr_handle_t dr, int value, int offset, req_priority prio)
+	{
+		int val_type = xplmType_Int;
+		if (offset >= 0)
+		{
+			val_type = xplmType_IntArray;
+		}
+		generic_val tmp = { {0}, "", val_type, offset};
+		tmp.int_val = value;
+		set_data(dr, tmp, prio);
+	}
+
+	void DataBus::set_dataf(dr_handle_t dr, float value, int offset, req_priority prio)
+	{
+		int val_type = xplmType_Float;
+		if (offset >= 0)
+		{
+			val_type = xplmType_FloatArray;
+		}
+		generic_val tmp = { {0}, "", val_type, offset };
+		tmp.float_val = value;
+		set_data(dr, tmp, prio);
+	}
+
+	void DataBus::set_datai(dr_handle_t dr, int value, req_priority prio)
+	{
+		set_datai(dr, value, -1, prio);
+	}
+
+	void DataBus::set_dataf(dr_handle_t dr, float value, req_priority prio)
+	{
+		set_dataf(dr, value, -1, prio);
+	}
+
+	void DataBus::set_datad(dr_handle_t dr, double value, req_priority prio)
+	{
+		generic_val tmp = { {0}, "", xplmType_Double, 0 };
+		tmp.double_val = value;
+		set_data(dr, tmp, prio);
+	}
+
+	void DataBus::set_data_s(dr_handle_t dr, std::string in, int offset, req_priority prio)
+	{
+		/*
+		* This function is for custom datarefs only.
+		*/
+		generic_val tmp = { {0}, in, xplmType_Data, offset };
+		set_data(dr, tmp, prio);
+	}
+
+	void DataBus::set_datavi(dr_handle_t dr, std::vector<int> in, int offset, req_priority prio)
+	{
+		if (in.size() == 0)
+		{
+			return;
+		}
+		set_req req = { dr, false, generic_val{ {0}, "", xplmType_IntArray, offset }, 
+			get_time_ns(), SHARED_CHANNEL, std::move(in), {} };
+		add_to_set_queue(&req, prio);
+	}
+
+	void DataBus::set_datavf(dr_handle_t dr, std::vector<float> in, int offset, req_priority prio)
+	{
+		if (in.size() == 0)
+		{
+			return;
+		}
+		set_req req = { dr, false, generic_val{ {0}, "", xplmType_FloatArray, offset }, 
+			get_time_ns(), SHARED_CHANNEL, {}, std::move(in) };
+		add_to_set_queue(&req, prio);
+	}
+
+	bool DataBus::load_mag_model(std::string path)
+	{
+		mag_model_year = get_decimal_year();
+		if (!mag_model.load(path, mag_model_year))
+		{
+			std::string tmp = "777_FMS: Failed to load magnetic model from " + path + "\n";
+			if (mag_model.get_epoch() != 0)
+			{
+				tmp = "777_FMS: Magnetic model " + mag_model.get_name() + " in " + path + 
+					" is out of date. Its epoch is " + std::to_string(mag_model.get_epoch()) + 
+					". Magnetic variation will be taken from X-plane\n";
+			}
+			XPLMDebugString(tmp.c_str());
+			return false;
+		}
+		std::string tmp = "777_FMS: Loaded magnetic model " + mag_model.get_name() + 
+			" from " + path + "\n";
+		XPLMDebugString(tmp.c_str());
+		return true;
+	}
+
+	bool DataBus::start_recording(std::string path)
+	{
+		if (!recorder.start(path))
+		{
+			std::string tmp = "777_FMS: Failed to open traffic log: " + path + "\n";
+			XPLMDebugString(tmp.c_str());
+			return false;
+		}
+
+		// Datarefs and channels that were registered before the recording started
+		for (size_t i = 0; i < dr_entries.size(); i++)
+		{
+			record_dr_name(dr_handle_t(i));
+		}
+		int n_channels = std::min(n_producers.load(std::memory_order_acquire), N_MAX_PRODUCERS);
+		for (int i = 1; i <= n_channels; i++)
+		{
+			producer_channel* chan = get_producer(i);
+			if (chan != nullptr)
+			{
+				record_channel(i, chan->name);
+			}
+		}
+
+		std::string tmp = "777_FMS: Recording databus traffic to " + path + "\n";
+		XPLMDebugString(tmp.c_str());
+		return true;
+	}
+
+	void DataBus::stop_recording()
+	{
+		if (recorder.is_on())
+		{
+			recorder.stop();
+			std::string tmp = "777_FMS: Stopped recording databus traffic. " + 
+				std::to_string(recorder.get_n_dropped()) + " records dropped\n";
+			XPLMDebugString(tmp.c_str());
+		}
+	}
+
+	uint64_t DataBus::get_n_recs_dropped()
+	{
+		return recorder.get_n_dropped();
+	}
+
+	void DataBus::publish_stats(databus_stats_hdls* hdls, std::string dump_path, 
+		double dump_interval_sec)
+	{
+		stats_hdls = *hdls;
+
+		dr_handle_t all_hdls[] = {stats_hdls.drain_us, stats_hdls.max_drain_us, 
+			stats_hdls.n_served, stats_hdls.queue_depth, stats_hdls.get_latency_hist, 
+			stats_hdls.set_latency_hist, stats_hdls.drain_hist};
+		for (size_t i = 0; i < sizeof(all_hdls) / sizeof(all_hdls[0]); i++)
+		{
+			if (get_direct_ptr(all_hdls[i]) == nullptr)
+			{
+				XPLMDebugString("777_FMS: Databus statistics datarefs have to be owned by this plugin\n");
+				return;
+			}
+		}
+
+		stats_dump_path = dump_path;
+		stats_dump_interval_ns = int64_t(dump_interval_sec * 1e9);
+		t_next_dump_ns = get_time_ns() + stats_dump_interval_ns;
+		if (stats_dump_path != "" && stats_writer == nullptr)
+		{
+			stats_writer = new std::thread([this]() { stats_writer_main(); });
+		}
+		is_publishing_stats = true;
+	}
+
+	std::vector<std::pair<std::string, uint64_t>> DataBus::get_top_drs(size_t n)
+	{
+		std::vector<std::pair<std::string, uint64_t>> out;
+		size_t n_drs = std::min(dr_entries.size(), N_MAX_COUNTED_DRS);
+		for (size_t i = 0; i < n_drs; i++)
+		{
+			uint64_t n_reqs = dr_req_cnt[i].load(std::memory_order_relaxed);
+			if (n_reqs)
+			{
+				out.push_back(std::make_pair(dr_entries[i].name, n_reqs));
+			}
+		}
+
+		auto cmp = [](const std::pair<std::string, uint64_t>& a, 
+			const std::pair<std::string, uint64_t>& b) { return a.second > b.second; };
+		n = std::min(n, out.size());
+		std::partial_sort(out.begin(), out.begin() + long(n), out.end(), cmp);
+		out.resize(n);
+		return out;
+	}
+
+	bool DataBus::dump_stats(std::string path)
+	{
+		stats_report report = get_stats_report();
+		return write_stats_report(path, &report);
+	}
+
+	stats_report DataBus::get_stats_report()
+	{
+		stats_report out;
+		out.drain = get_drain_stats();
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			out.queues[i] = get_queue_stats(drain_queue_id(i));
+		}
+		out.channels = get_channel_stats();
+		out.top_drs = get_top_drs(N_STATS_TOP_DRS);
+		return out;
+	}
+
+	bool DataBus::write_stats_report(std::string path, stats_report* report)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "w");
+		if (file == nullptr)
+		{
+			return false;
+		}
+
+		const char* queue_names[N_DRAIN_QUEUES] = {"mag var", "get", "batch get", "set", "watch"};
+		drain_stats* d_st = &report->drain;
+		std::fprintf(file, "Frames: %llu\n", (unsigned long long)d_st->n_frames);
+		std::fprintf(file, "Drain time us: last %.1f avg %.1f max %.1f\n\n", d_st->last_us, 
+			d_st->avg_us, d_st->max_us);
+
+		std::fprintf(file, "%-10s %12s %8s %10s\n", "queue", "served", "depth", "max depth");
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			queue_stats* st = &report->queues[i];
+			std::fprintf(file, "%-10s %12llu %8llu %10llu\n", queue_names[i], 
+				(unsigned long long)st->n_served, (unsigned long long)st->depth, 
+				(unsigned long long)st->max_depth);
+		}
+
+		// Bucket i covers latencies below 2^(i+1) us
+		std::fprintf(file, "\n%-10s", "< us");
+		for (int i = 0; i < N_LATENCY_BUCKETS; i++)
+		{
+			std::fprintf(file, " %8llu", 2ULL << i);
+		}
+		std::fprintf(file, "\n");
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			std::fprintf(file, "%-10s", queue_names[i]);
+			for (int j = 0; j < N_LATENCY_BUCKETS; j++)
+			{
+				std::fprintf(file, " %8llu", 
+					(unsigned long long)report->queues[i].latency_hist[j]);
+			}
+			std::fprintf(file, "\n");
+		}
+		std::fprintf(file, "%-10s", "drain");
+		for (int i = 0; i < N_LATENCY_BUCKETS; i++)
+		{
+			std::fprintf(file, " %8llu", (unsigned long long)d_st->hist[i]);
+		}
+		std::fprintf(file, "\n\n");
+
+		std::fprintf(file, "%-12s %12s %12s %14s %14s %14s\n", "channel", "queued", "direct", 
+			"avg wait us", "max wait us", "blocked us");
+		for (size_t i = 0; i < report->channels.size(); i++)
+		{
+			channel_stats* chan = &report->channels[i];
+			std::fprintf(file, "%-12s %12llu %12llu %14.1f %14.1f %14.1f\n", chan->name.c_str(), 
+				(unsigned long long)chan->n_reqs, (unsigned long long)chan->n_direct, 
+				chan->avg_wait_us, chan->max_wait_us, chan->blocked_us);
+		}
+
+		std::fprintf(file, "\n%-64s %12s\n", "dataref", "requests");
+		for (size_t i = 0; i < report->top_drs.size(); i++)
+		{
+			std::fprintf(file, "%-64s %12llu\n", report->top_drs[i].first.c_str(), 
+				(unsigned long long)report->top_drs[i].second);
+		}
+
+		std::fclose(file);
+		return true;
+	}
+
+	data_ref_entry* DataBus::get_dr_entry(dr_handle_t dr)
+	{
+		if (dr >= 0 && size_t(dr) < dr_entries.size())
+		{
+			return &dr_entries[size_t(dr)];
+		}
+		return nullptr;
+	}
+
+	generic_ptr* DataBus::get_direct_ptr(dr_handle_t dr)
+	{
+		if (dr >= 0 && size_t(dr) < N_MAX_DIRECT_DRS && direct_ptrs[size_t(dr)].ptr != nullptr)
+		{
+			return &direct_ptrs[size_t(dr)];
+		}
+		return nullptr;
+	}
+
+	generic_val DataBus::get_direct_val(generic_ptr* ptr, int offset)
+	{
+		generic_val tmp = { {0}, "", 0, offset };
+		if (get_custom_data_ref_value(ptr, &tmp) != 1)
+		{
+			tmp.offset = -1;
+		}
+		return tmp;
+	}
+
+	int DataBus::get_range(dr_handle_t dr, int offset, range_buf* range)
+	{
+		if(!is_operative.load(ATOMIC_ORDR) || range->n_vals <= 0)
+		{
+			return 0;
+		}
+		generic_ptr* ptr = get_direct_ptr(dr);
+		if (ptr != nullptr)
+		{
+			int channel = get_thread_channel_id();
+			int n_read = get_custom_range(ptr, offset, range);
+			count_direct(channel);
+			record_range(REC_GET, channel, dr, offset, range->val_type, range->vals, n_read);
+			return n_read;
+		}
+		CompletionSlot* slot = get_thread_slot();
+		uint64_t ticket = slot->arm();
+		add_to_get_queue(dr, slot, offset, *range);
+		slot->wait(ticket);
+		return slot->val.int_val;
+	}
+
+	int DataBus::get_data_ref_value(data_ref_entry* entry, generic_val* out)
+	{
+		/*
+		* This function gets a value of a dataref that isn't owned by this plugin
+		*/
+		int dr_set = 0;
+		data_ref_entry& ref = *entry;
+
+		if (xplmType_IntArray & ref.dr_type)
+		{
+			out->val_type = xplmType_Int;
+			return read_array(entry, &entry->cache_i, out->offset, 1, &out->int_val);
+		}
+		else if (xplmType_FloatArray & ref.dr_type)
+		{
+			out->val_type = xplmType_Float;
+			return read_array(entry, &entry->cache_f, out->offset, 1, &out->float_val);
+		}
+		else if (xplmType_Data & ref.dr_type)
+		{
+			/*
+			* The string is read straight into the value. Only strings longer 
+			* than SMALL_STR_CAP need a heap buffer.
+			*/
+			out->val_type = xplmType_Data;
+			int n_avail = XPLMGetDatab(ref.ref, nullptr, 0, 0) - out->offset;
+			if (n_avail > CHAR_BUF_SIZE)
+			{
+				n_avail = CHAR_BUF_SIZE;
+			}
+			if (n_avail > 0)
+			{
+				char* buf = out->str.prepare(size_t(n_avail));
+				dr_set = XPLMGetDatab(ref.ref, buf, out->offset, n_avail);
+				if (dr_set < 0)
+				{
+					dr_set = 0;
+				}
+				out->str.set_length(strnlen(buf, size_t(dr_set)));
+			}
+		}
+
+		if (xplmType_Int & ref.dr_type)
+		{
+			out->val_type |= xplmType_Int;
+			out->int_val = XPLMGetDatai(ref.ref);
+			dr_set = 1;
+		}
+		if (xplmType_Float & ref.dr_type)
+		{
+			out->val_type |= xplmType_Float;
+			out->float_val = XPLMGetDataf(ref.ref);
+			dr_set = 1;
+		}
+		if (xplmType_Double & ref.dr_type)
+		{
+			out->val_type |= xplmType_Double;
+			out->double_val = XPLMGetDatad(ref.ref);
+			dr_set = 1;
+		}
+		
+		return dr_set;
+	}
+
+	int DataBus::get_custom_data_ref_value(generic_ptr* val_ptr, generic_val* out)
+	{
+		/*
+		* This function gets a value of a dataref that is owned by this plugin
+		*/
+		int offset = out->offset;
+		generic_ptr ptr = *val_ptr;
+		if (ptr.ptr_type == xplmType_Int)
+		{
+			out->val_type = xplmType_Int;
+			out->int_val = reinterpret_cast<std::atomic<int>*>(ptr.ptr)->load(
+				std::memory_order_relaxed);
+			return 1;
+		}
+		else if (ptr.ptr_type == xplmType_Float)
+		{
+			out->val_type = xplmType_Float;
+			out->float_val = reinterpret_cast<std::atomic<float>*>(ptr.ptr)->load(
+				std::memory_order_relaxed);
+			return 1;
+		}
+		else if (ptr.ptr_type == xplmType_Double)
+		{
+			out->val_type = xplmType_Double;
+			out->double_val = reinterpret_cast<std::atomic<double>*>(ptr.ptr)->load(
+				std::memory_order_relaxed);
+			return 1;
+		}
+		else if (offset < 0 || offset >= ptr.n_length)
+		{
+			return 0;
+		}
+		else if (xplmType_IntArray & ptr.ptr_type)
+		{
+			out->val_type = xplmType_Int;
+			out->int_val = reinterpret_cast<SeqBuf<int>*>(ptr.ptr)->get(size_t(offset));
+			return 1;
+		}
+		else if (xplmType_FloatArray & ptr.ptr_type)
+		{
+			out->val_type = xplmType_Float;
+			out->float_val = reinterpret_cast<SeqBuf<float>*>(ptr.ptr)->get(size_t(offset));
+			return 1;
+		}
+		else if (xplmType_Data & ptr.ptr_type)
+		{
+			out->val_type = xplmType_Data;
+			char data[CHAR_BUF_SIZE];
+			size_t n_read = reinterpret_cast<SeqBuf<char>*>(ptr.ptr)->read(data, 
+				size_t(offset), CHAR_BUF_SIZE);
+			out->str.assign(data, strnlen(data, n_read));
+			return 1;
+		}
+		return 0;
+	}
+
+	void DataBus::trigger_cmd_once(dr_handle_t cmd)
+	{
+		if (cmd >= 0 && size_t(cmd) < cmd_entries.size() && cmd_entries[size_t(cmd)] != nullptr)
+		{
+			XPLMCommandOnce(cmd_entries[size_t(cmd)]);
+		}
+	}
+
+	void DataBus::set_data_ref_value(data_ref_entry* entry, generic_val* in)
+	{
+		/*
+		* This function sets a value of a dataref that isn't owned by this plugin
+		*/
+		data_ref_entry& ref = *entry;
+		if (ref.dr_type == xplmType_Int)
+		{
+			XPLMSetDatai(ref.ref, in->int_val);
+		}
+		else if (ref.dr_type == xplmType_Float)
+		{
+			XPLMSetDataf(ref.ref, in->float_val);
+		}
+		else if (ref.dr_type == xplmType_Double)
+		{
+			XPLMSetDatad(ref.ref, in->double_val);
+		}
+		else if (xplmType_IntArray & ref.dr_type)
+		{
+			XPLMSetDatavi(ref.ref, &in->int_val, in->offset, 1);
+		}
+		else if (xplmType_FloatArray & ref.dr_type)
+		{
+			XPLMSetDatavf(ref.ref, &in->float_val, in->offset, 1);
+		}
+	}
+
+	void DataBus::set_custom_data_ref_value(generic_ptr* val_ptr, generic_val* in)
+	{
+		/*
+		* This function sets a value of a dataref that is owned by this plugin.
+		*/
+		generic_ptr ptr = *val_ptr;
+		if (ptr.ptr_type == xplmType_Int)
+		{
+			reinterpret_cast<std::atomic<int>*>(ptr.ptr)->store(in->int_val, 
+				std::memory_order_relaxed);
+		}
+		else if (ptr.ptr_type == xplmType_Float)
+		{
+			reinterpret_cast<std::atomic<float>*>(ptr.ptr)->store(in->float_val, 
+				std::memory_order_relaxed);
+		}
+		else if (ptr.ptr_type == xplmType_Double)
+		{
+			reinterpret_cast<std::atomic<double>*>(ptr.ptr)->store(in->double_val, 
+				std::memory_order_relaxed);
+		}
+		else if (xplmType_IntArray & ptr.ptr_type)
+		{
+			reinterpret_cast<SeqBuf<int>*>(ptr.ptr)->set(size_t(in->offset), in->int_val);
+		}
+		else if (xplmType_FloatArray & ptr.ptr_type)
+		{
+			reinterpret_cast<SeqBuf<float>*>(ptr.ptr)->set(size_t(in->offset), in->float_val);
+		}
+		else if (xplmType_Data & ptr.ptr_type)
+		{
+			/*
+			* The new contents are put together first and written in one go,
+			* so readers never see a partially written string.
+			*/
+			SeqBuf<char>* data = reinterpret_cast<SeqBuf<char>*>(ptr.ptr);
+			int str_length = int(in->str.length());
+
+			if (str_length <= 1 && in->offset == -1) // Set all elements of output string to 1 character
+			{
+				char c = 0;
+				if (str_length)
+				{
+					c = in->str.at(0);
+				}
+				data->fill(c);
+			}
+			else
+			{
+				int offset = std::max(in->offset, 0);
+				int data_length = std::min(ptr.n_length - offset, CHAR_BUF_SIZE);
+				if (data_length > 0)
+				{
+					char tmp[CHAR_BUF_SIZE];
+					int n_copy = std::min(str_length, data_length);
+					std::memcpy(tmp, in->str.c_str(), size_t(n_copy));
+					std::memset(tmp + n_copy, DEFAULT_STR_FILL_CHAR, size_t(data_length - n_copy));
+					data->write(tmp, size_t(offset), size_t(data_length));
+				}
+			}
+		}
+	}
+
+	generic_val DataBus::get_any_data_ref(dr_handle_t dr, int offset)
+	{
+		generic_val tmp = { {0}, "", 0, offset };
+		data_ref_entry* entry = get_dr_entry(dr);
+		int n_read = 0;
+		if (entry != nullptr)
+		{
+			if (entry->is_custom)
+			{
+				n_read = get_custom_data_ref_value(&entry->custom_val, &tmp);
+			}
+			else if (entry->ref != nullptr)
+			{
+				n_read = get_data_ref_value(entry, &tmp);
+			}
+		}
+		if (n_read != 1)
+		{
+			tmp.offset = -1;
+		}
+		return tmp;
+	}
+
+	inline int xplm_get_datav(XPLMDataRef ref, int* out, int offset, int n)
+	{
+		return XPLMGetDatavi(ref, out, offset, n);
+	}
+
+	inline int xplm_get_datav(XPLMDataRef ref, float* out, int offset, int n)
+	{
+		return XPLMGetDatavf(ref, out, offset, n);
+	}
+
+	template <class T>
+	int DataBus::read_array(data_ref_entry* entry, std::vector<T>* cache, int offset, int n, T* out)
+	{
+		if (offset < 0 || n <= 0)
+		{
+			return 0;
+		}
+		if (entry->arr_length < 0)
+		{
+			entry->arr_length = std::max(xplm_get_datav(entry->ref, (T*)nullptr, 0, 0), 0);
+		}
+		if (entry->arr_length > N_MAX_CACHED_ARR_LENGTH)
+		{
+			return xplm_get_datav(entry->ref, out, offset, n);
+		}
+
+		if (entry->cache_frame != cache_frame)
+		{
+			cache->resize(size_t(entry->arr_length));
+			int n_read = 0;
+			if (entry->arr_length)
+			{
+				n_read = xplm_get_datav(entry->ref, cache->data(), 0, entry->arr_length);
+			}
+			cache->resize(size_t(std::max(n_read, 0)));
+			entry->cache_frame = cache_frame;
+		}
+
+		int n_copy = std::min(n, int(cache->size()) - offset);
+		for (int i = 0; i < n_copy; i++)
+		{
+			out[i] = cache->at(size_t(offset + i));
+		}
+		return std::max(n_copy, 0);
+	}
+
+	int DataBus::get_custom_range(generic_ptr* ptr, int offset, range_buf* range)
+	{
+		if (offset < 0 || !(ptr->ptr_type & range->val_type))
+		{
+			return 0;
+		}
+		if (range->val_type == xplmType_IntArray)
+		{
+			return int(reinterpret_cast<SeqBuf<int>*>(ptr->ptr)->read(
+				reinterpret_cast<int*>(range->vals), size_t(offset), size_t(range->n_vals)));
+		}
+		return int(reinterpret_cast<SeqBuf<float>*>(ptr->ptr)->read(
+			reinterpret_cast<float*>(range->vals), size_t(offset), size_t(range->n_vals)));
+	}
+
+	int DataBus::get_any_range(dr_handle_t dr, int offset, range_buf* range)
+	{
+		data_ref_entry* entry = get_dr_entry(dr);
+		if (entry == nullptr)
+		{
+			return 0;
+		}
+		if (entry->is_custom)
+		{
+			return get_custom_range(&entry->custom_val, offset, range);
+		}
+		if (entry->ref == nullptr || !(entry->dr_type & range->val_type))
+		{
+			return 0;
+		}
+		if (range->val_type == xplmType_IntArray)
+		{
+			return read_array(entry, &entry->cache_i, offset, range->n_vals, 
+				reinterpret_cast<int*>(range->vals));
+		}
+		return read_array(entry, &entry->cache_f, offset, range->n_vals, 
+			reinterpret_cast<float*>(range->vals));
+	}
+
+	int DataBus::set_custom_range(generic_ptr* ptr, set_req* req)
+	{
+		int offset = req->val.offset;
+		if (offset < 0 || !(ptr->ptr_type & req->val.val_type))
+		{
+			return 0;
+		}
+		if (req->val.val_type == xplmType_IntArray)
+		{
+			return int(reinterpret_cast<SeqBuf<int>*>(ptr->ptr)->write(req->range_i.data(), 
+				size_t(offset), req->range_i.size()));
+		}
+		return int(reinterpret_cast<SeqBuf<float>*>(ptr->ptr)->write(req->range_f.data(), 
+			size_t(offset), req->range_f.size()));
+	}
+
+	int DataBus::set_any_range(dr_handle_t dr, set_req* req)
+	{
+		data_ref_entry* entry = get_dr_entry(dr);
+		if (entry == nullptr)
+		{
+			return 0;
+		}
+		if (entry->is_custom)
+		{
+			return set_custom_range(&entry->custom_val, req);
+		}
+		if (entry->ref == nullptr || req->val.offset < 0 || !(entry->dr_type & req->val.val_type))
+		{
+			return 0;
+		}
+		if (req->val.val_type == xplmType_IntArray)
+		{
+			XPLMSetDatavi(entry->ref, req->range_i.data(), req->val.offset, 
+				int(req->range_i.size()));
+			return int(req->range_i.size());
+		}
+		XPLMSetDatavf(entry->ref, req->range_f.data(), req->val.offset, 
+			int(req->range_f.size()));
+		return int(req->range_f.size());
+	}
+
+	int DataBus::set_data_ref(data_ref_entry* entry, generic_val* in)
+	{
+		if (entry->ref != nullptr)
+		{
+			if (entry->dr_type & in->val_type)
 			{
-				if (get_data_ref(&data.dref, &tmp) != 1)
+				set_data_ref_value(entry, in);
+				return 1;
+			}
+			return 3;
+		}
+		return 0;
+	}
+
+	int DataBus::set_custom_data_ref(generic_ptr* ptr, generic_val* in)
+	{
+		if (ptr->ptr_type & in->val_type)
+		{
+			set_custom_data_ref_value(ptr, in);
+			return 1;
+		}
+		return 3;
+	}
+
+	int DataBus::set_any_data_ref(dr_handle_t dr, generic_val* in)
+	{
+		data_ref_entry* entry = get_dr_entry(dr);
+		if (entry == nullptr)
+		{
+			return 0;
+		}
+		if (entry->is_custom)
+		{
+			return set_custom_data_ref(&entry->custom_val, in);
+		}
+		return set_data_ref(entry, in);
+	}
+
+	void DataBus::update_snapshot()
+	{
+		if (snap_drs.size() == 0)
+		{
+			return;
+		}
+
+		uint64_t frame = snap_frame.load(std::memory_order_relaxed) + 1;
+		snap_buf* buf = &snap_bufs[frame % N_SNAPSHOT_BUFS];
+		buf->seq.store(2 * frame - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (size_t i = 0; i < snap_drs.size(); i++)
+		{
+			generic_val tmp = get_any_data_ref(snap_drs[i].dref, snap_drs[i].offset);
+			record_val(REC_GET, MAIN_CHANNEL, snap_drs[i].dref, &tmp);
+			snap_val* dst = &buf->vals[i];
+			uint64_t raw = 0;
+			std::memcpy(&raw, &tmp.double_val, sizeof(raw));
+			dst->raw.store(raw, std::memory_order_relaxed);
+			dst->val_type.store(tmp.val_type, std::memory_order_relaxed);
+		}
+
+		buf->seq.store(2 * frame, std::memory_order_release);
+		snap_frame.store(frame, std::memory_order_release);
+	}
+
+	void DataBus::check_watches()
+	{
+		if (watch_waits.size() == 0)
+		{
+			return;
+		}
+
+		int64_t t_now = get_time_ns();
+		size_t n_left = 0;
+		for (size_t i = 0; i < watch_waits.size(); i++)
+		{
+			watch_req* curr = &watch_waits[i];
+			bool is_changed = update_watch_vals(&watches[size_t(curr->watch)]);
+			if (is_changed || t_now >= curr->t_deadline_ns)
+			{
+				curr->slot->val.int_val = int(is_changed);
+				curr->slot->complete();
+			}
+			else
+			{
+				watch_waits[n_left++] = *curr;
+			}
+		}
+		watch_waits.resize(n_left);
+	}
+
+	inline bool is_same_val(generic_val* v1, generic_val* v2)
+	{
+		if (v1->val_type != v2->val_type || v1->offset != v2->offset)
+		{
+			return false;
+		}
+		if ((xplmType_Double & v1->val_type) && v1->double_val != v2->double_val)
+		{
+			return false;
+		}
+		else if ((xplmType_Float & v1->val_type) && v1->float_val != v2->float_val)
+		{
+			return false;
+		}
+		else if ((xplmType_Int & v1->val_type) && v1->int_val != v2->int_val)
+		{
+			return false;
+		}
+		return v1->str.length() == v2->str.length() && 
+			std::memcmp(v1->str.c_str(), v2->str.c_str(), v1->str.length()) == 0;
+	}
+
+	bool DataBus::update_watch_vals(watch_entry* watch)
+	{
+		bool is_changed = false;
+		watch->last.resize(watch->drs.size(), generic_val{ {0}, "", 0, 0 });
+		for (size_t i = 0; i < watch->drs.size(); i++)
+		{
+			batch_entry* curr = &watch->drs[i];
+			generic_val tmp = get_any_data_ref(curr->dref, curr->offset);
+			record_val(REC_GET, MAIN_CHANNEL, curr->dref, &tmp);
+			if (!is_same_val(&tmp, &watch->last[i]))
+			{
+				watch->last[i] = std::move(tmp);
+				is_changed = true;
+			}
+		}
+		return is_changed;
+	}
+
+	void DataBus::add_pending_set(int lane, set_req* req)
+	{
+		/*
+		* Last writer wins: a write to a dataref and offset that is still pending
+		* replaces the value of the earlier write and keeps its place in the queue,
+		* so every key lands in the next frame that reaches it. Commands, slices
+		* and fills (offset -1) are barriers: they take the keys of the dataref
+		* out of the map (commands take all of them), so later writes are queued
+		* behind them.
+		*/
+		std::unordered_map<dr_handle_t, std::unordered_map<int, set_req*>>* keys = 
+			&pending_set_keys[lane];
+		if (req->set_cmd)
+		{
+			keys->clear();
+			pending_sets[lane].push_back(std::move(*req));
+			return;
+		}
+		if (req->range_i.size() || req->range_f.size())
+		{
+			keys->erase(req->dref);
+			pending_sets[lane].push_back(std::move(*req));
+			return;
+		}
+
+		std::unordered_map<int, set_req*>* dr_keys = &(*keys)[req->dref];
+		int offset = req->val.offset;
+		auto it = dr_keys->find(offset);
+		if (it != dr_keys->end())
+		{
+			// The earlier write keeps its time, so latency isn't understated
+			it->second->val = std::move(req->val);
+			n_sets_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		if (offset < 0)
+		{
+			dr_keys->clear();
+		}
+		else
+		{
+			dr_keys->erase(-1);
+		}
+		pending_sets[lane].push_back(std::move(*req));
+		(*dr_keys)[offset] = &pending_sets[lane].back();
+	}
+
+	void DataBus::remove_pending_key(int lane, set_req* req)
+	{
+		auto dr_it = pending_set_keys[lane].find(req->dref);
+		if (dr_it == pending_set_keys[lane].end())
+		{
+			return;
+		}
+		// The key may already belong to a write that was queued behind a barrier
+		auto it = dr_it->second.find(req->val.offset);
+		if (it != dr_it->second.end() && it->second == req)
+		{
+			dr_it->second.erase(it);
+		}
+		if (dr_it->second.empty())
+		{
+			pending_set_keys[lane].erase(dr_it);
+		}
+	}
+
+	size_t DataBus::get_xplm_mag_var()
+	{
+		mag_var_req data;
+		int channel = pop_next(DRAIN_MAG_VAR, &mag_var_queue, &producer_channel::mag_var_queue, 
+			&data);
+		if (channel < 0)
+		{
+			return 0;
+		}
+
+		for (size_t i = 0; i < data.n_points; i++)
+		{
+			mag_var_point* curr = &data.points[i];
+			curr->mag_var = XPLMGetMagneticVariation(curr->point.lat, curr->point.lon);
+			if (curr->node >= 0)
+			{
+				mag_var_grid.set_node(curr->node, curr->mag_var);
+			}
+			if (recorder.is_on())
+			{
+				traffic_rec rec = { 0, REC_MAG_VAR, channel, INVALID_DR_HANDLE, 
+					generic_val{ {0}, "", xplmType_Float, 0 }, curr->point.lat, curr->point.lon, 
+					false, 0 };
+				rec.val.float_val = curr->mag_var;
+				recorder.add(&rec);
+			}
+		}
+
+		data.slot->complete();
+		count_req(DRAIN_MAG_VAR, channel, data.t_queued_ns);
+		return data.n_points;
+	}
+
+	size_t DataBus::get_data_ref()
+	{
+		get_req data;
+		int channel = pop_next(DRAIN_GET, &get_queue, &producer_channel::get_queue, &data);
+		if (channel < 0)
+		{
+			return 0;
+		}
+		if (data.range.n_vals > 0)
+		{
+			int n_read = get_any_range(data.dref, data.offset, &data.range);
+			record_range(REC_GET, channel, data.dref, data.offset, data.range.val_type, 
+				data.range.vals, n_read);
+			data.slot->val.int_val = n_read;
+			data.slot->complete();
+			count_req(DRAIN_GET, channel, data.t_queued_ns);
+			return 1;
+		}
+
+		generic_val tmp = get_any_data_ref(data.dref, data.offset);
+		record_val(REC_GET, channel, data.dref, &tmp);
+		data.slot->val = std::move(tmp);
+		data.slot->complete();
+		count_req(DRAIN_GET, channel, data.t_queued_ns);
+		return 1;
+	}
+
+	size_t DataBus::get_data_ref_batch()
+	{
+		// Batches are never split across frames, so that the requesting thread
+		// receives values from the same frame.
+		batch_get_req batch;
+		int channel = pop_next(DRAIN_BATCH_GET, &batch_get_queue, 
+			&producer_channel::batch_get_queue, &batch);
+		if (channel < 0)
+		{
+			return 0;
+		}
+		// The requesting thread owns drs again once the slot is completed
+		size_t n_drs = batch.drs->size();
+		for (size_t i = 0; i < n_drs; i++)
+		{
+			batch_entry* curr = &batch.drs->at(i);
+			batch.out->at(i) = get_any_data_ref(curr->dref, curr->offset);
+			record_val(REC_GET, channel, curr->dref, &batch.out->at(i));
+		}
+		batch.slot->complete();
+		count_req(DRAIN_BATCH_GET, channel, batch.t_queued_ns);
+		return n_drs;
+	}
+
+	void DataBus::collect_set_reqs()
+	{
+		/*
+		* Everything that is in the ring is moved to the pending list first,
+		* so that repeated writes to the same dataref collapse into one.
+		* The number of iterations is bounded in case producers keep pushing.
+		*/
+		int n_channels = std::min(n_producers.load(std::memory_order_acquire), 
+			N_MAX_PRODUCERS) + 1;
+		for (int i = 0; i < N_PRIO_LANES; i++)
+		{
+			set_req tmp;
+			size_t n_max_pop = set_queues[i].capacity();
+			for (size_t j = 0; j < n_max_pop && set_queues[i].pop(&tmp); j++)
+			{
+				tmp.channel = SHARED_CHANNEL;
+				add_pending_set(i, &tmp);
+			}
+			for (int k = 1; k < n_channels; k++)
+			{
+				producer_channel* chan = get_producer(k);
+				if (chan == nullptr)
+				{
+					continue;
+				}
+				n_max_pop = chan->set_queues[i].capacity();
+				for (size_t j = 0; j < n_max_pop && chan->set_queues[i].pop(&tmp); j++)
 				{
-					tmp.offset = -1;
+					tmp.channel = k;
+					add_pending_set(i, &tmp);
 				}
 			}
-			data.prom->set_value(tmp);
-			counter++;
+
+			uint64_t depth = pending_sets[i].size();
+			if (depth > lane_cnt[i].max_depth.load(std::memory_order_relaxed))
+			{
+				lane_cnt[i].max_depth.store(depth, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	size_t DataBus::set_data_ref()
+	{
+		int lane = 0;
+		while (lane < N_PRIO_LANES && pending_sets[lane].empty())
+		{
+			lane++;
+		}
+		if (lane == N_PRIO_LANES)
+		{
+			return 0;
+		}
+
+		set_req* data = &pending_sets[lane].front();
+		if (data->set_cmd)
+		{
+			trigger_cmd_once(data->dref);
+			record_val(REC_CMD, data->channel, data->dref, &data->val);
+		}
+		else if (data->range_i.size())
+		{
+			set_any_range(data->dref, data);
+			record_range(REC_SET, data->channel, data->dref, data->val.offset, xplmType_IntArray, 
+				data->range_i.data(), int(data->range_i.size()));
+		}
+		else if (data->range_f.size())
+		{
+			set_any_range(data->dref, data);
+			record_range(REC_SET, data->channel, data->dref, data->val.offset, xplmType_FloatArray, 
+				data->range_f.data(), int(data->range_f.size()));
+		}
+		else
+		{
+			remove_pending_key(lane, data);
+			set_any_data_ref(data->dref, &data->val);
+			record_val(REC_SET, data->channel, data->dref, &data->val);
+		}
+		cache_frame++;
+
+		count_req(DRAIN_SET, data->channel, data->t_queued_ns);
+		lane_counters* cnt = &lane_cnt[lane];
+		uint64_t latency_ns = uint64_t(std::max(int64_t(0), get_time_ns() - data->t_queued_ns));
+		cnt->n_applied.fetch_add(1, std::memory_order_relaxed);
+		cnt->latency_sum_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+		if (latency_ns > cnt->max_latency_ns.load(std::memory_order_relaxed))
+		{
+			cnt->max_latency_ns.store(latency_ns, std::memory_order_relaxed);
+		}
+
+		pending_sets[lane].pop_front();
+		return 1;
+	}
+
+	size_t DataBus::add_watch_wait()
+	{
+		watch_req data;
+		int channel = pop_next(DRAIN_WATCH, &watch_queue, &producer_channel::watch_queue, &data);
+		if (channel < 0)
+		{
+			return 0;
 		}
+		count_req(DRAIN_WATCH, channel, data.t_queued_ns);
+
+		if (data.watch < 0 || size_t(data.watch) >= watches.size())
+		{
+			data.slot->val.int_val = 0;
+			data.slot->complete();
+			return 1;
+		}
+
+		watch_entry* watch = &watches[size_t(data.watch)];
+		if (update_watch_vals(watch))
+		{
+			data.slot->val.int_val = 1;
+			data.slot->complete();
+		}
+		else
+		{
+			watch_waits.push_back(data);
+		}
+		return watch->drs.size();
 	}
 
-	void DataBus::set_data_refs()
+	size_t DataBus::drain_one(int queue_id)
 	{
-		uint64_t counter = 0;
-		while (set_queue.size() && counter < max_queue_refresh)
+		switch (queue_id)
 		{
-			std::lock_guard<std::mutex> lock(set_queue_mutex);
-			set_req data = set_queue.front();
-			set_queue.pop();
+		case DRAIN_MAG_VAR:
+			return get_xplm_mag_var();
+		case DRAIN_GET:
+			return get_data_ref();
+		case DRAIN_BATCH_GET:
+			return get_data_ref_batch();
+		case DRAIN_SET:
+			return set_data_ref();
+		case DRAIN_WATCH:
+			return add_watch_wait();
+		default:
+			return 0;
+		}
+	}
+
+	void DataBus::drain_queues()
+	{
+		/*
+		* The queues take turns, one request at a time. A queue is skipped once
+		* its estimated cost per item no longer fits in what's left of the budget,
+		* so a queue of expensive requests can't starve the cheap ones. Every 
+		* queue gets at least one request per frame regardless of the budget.
+		* Set requests in the flight lane are exempt from the budget.
+		*/
+		collect_set_reqs();
+
+		auto t_start = std::chrono::steady_clock::now();
+		auto t_prev = t_start;
+		bool is_done[N_DRAIN_QUEUES] = {false};
+		size_t n_done[N_DRAIN_QUEUES] = {0};
+		bool any_left = true;
 
-			if(!data.set_cmd)
+		while (any_left)
+		{
+			any_left = false;
+			for (int i = 0; i < N_DRAIN_QUEUES; i++)
 			{
-				if (set_custom_data_ref(&data.dref, &data.val) == 0)
+				if (is_done[i])
+				{
+					continue;
+				}
+				double elapsed_us = std::chrono::duration<double, std::micro>(
+					t_prev - t_start).count();
+				bool is_exempt = i == DRAIN_SET && 
+					!pending_sets[static_cast<int>(req_priority::PRIO_FLIGHT)].empty();
+				if (n_done[i] && !is_exempt && elapsed_us + item_cost_us[i] > frame_budget_us)
+				{
+					is_done[i] = true;
+					continue;
+				}
+
+				size_t n_items = drain_one(i);
+				if (n_items == 0)
 				{
-					set_data_ref(&data.dref, &data.val);
+					is_done[i] = true;
+					continue;
 				}
+
+				auto t_curr = std::chrono::steady_clock::now();
+				double cost_us = std::chrono::duration<double, std::micro>(
+					t_curr - t_prev).count() / double(n_items);
+				item_cost_us[i] += DRAIN_COST_FILTER_K * (cost_us - item_cost_us[i]);
+				t_prev = t_curr;
+				n_done[i]++;
+				any_left = true;
 			}
-			else
+		}
+
+		for (int i = 0; i < N_PRIO_LANES; i++)
+		{
+			lane_cnt[i].depth.store(pending_sets[i].size(), std::memory_order_relaxed);
+		}
+	}
+
+	void DataBus::update_queue_depths()
+	{
+		uint64_t depths[N_DRAIN_QUEUES] = {0};
+		depths[DRAIN_MAG_VAR] = mag_var_queue.size();
+		depths[DRAIN_GET] = get_queue.size();
+		depths[DRAIN_BATCH_GET] = batch_get_queue.size();
+		depths[DRAIN_WATCH] = watch_queue.size();
+		for (int i = 0; i < N_PRIO_LANES; i++)
+		{
+			depths[DRAIN_SET] += pending_sets[i].size() + set_queues[i].size();
+		}
+
+		int n_channels = std::min(n_producers.load(std::memory_order_acquire), 
+			N_MAX_PRODUCERS) + 1;
+		for (int i = 1; i < n_channels; i++)
+		{
+			producer_channel* chan = get_producer(i);
+			if (chan == nullptr)
+			{
+				continue;
+			}
+			depths[DRAIN_MAG_VAR] += chan->mag_var_queue.size();
+			depths[DRAIN_GET] += chan->get_queue.size();
+			depths[DRAIN_BATCH_GET] += chan->batch_get_queue.size();
+			depths[DRAIN_WATCH] += chan->watch_queue.size();
+			for (int j = 0; j < N_PRIO_LANES; j++)
+			{
+				depths[DRAIN_SET] += chan->set_queues[j].size();
+			}
+		}
+
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			queue_cnt[i].depth.store(depths[i], std::memory_order_relaxed);
+			if (depths[i] > queue_cnt[i].max_depth.load(std::memory_order_relaxed))
+			{
+				queue_cnt[i].max_depth.store(depths[i], std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void DataBus::update_stats(int64_t drain_ns)
+	{
+		uint64_t drain_u = uint64_t(std::max(int64_t(0), drain_ns));
+		drain_cnt.n_frames.fetch_add(1, std::memory_order_relaxed);
+		drain_cnt.last_ns.store(drain_u, std::memory_order_relaxed);
+		drain_cnt.sum_ns.fetch_add(drain_u, std::memory_order_relaxed);
+		if (drain_u > drain_cnt.max_ns.load(std::memory_order_relaxed))
+		{
+			drain_cnt.max_ns.store(drain_u, std::memory_order_relaxed);
+		}
+		drain_cnt.hist[get_hist_bucket(drain_u)].fetch_add(1, std::memory_order_relaxed);
+
+		if (!is_publishing_stats)
+		{
+			return;
+		}
+
+		drain_stats d_st = get_drain_stats();
+		generic_val tmp = { {0}, "", xplmType_Double, 0 };
+		tmp.double_val = d_st.last_us;
+		set_custom_data_ref(get_direct_ptr(stats_hdls.drain_us), &tmp);
+		tmp.double_val = d_st.max_us;
+		set_custom_data_ref(get_direct_ptr(stats_hdls.max_drain_us), &tmp);
+		publish_stats_arr(stats_hdls.drain_hist, d_st.hist, N_LATENCY_BUCKETS);
+
+		uint64_t n_served[N_DRAIN_QUEUES];
+		uint64_t depths[N_DRAIN_QUEUES];
+		for (int i = 0; i < N_DRAIN_QUEUES; i++)
+		{
+			n_served[i] = queue_cnt[i].n_served.load(std::memory_order_relaxed);
+			depths[i] = queue_cnt[i].depth.load(std::memory_order_relaxed);
+		}
+		publish_stats_arr(stats_hdls.n_served, n_served, N_DRAIN_QUEUES);
+		publish_stats_arr(stats_hdls.queue_depth, depths, N_DRAIN_QUEUES);
+
+		queue_stats q_st = get_queue_stats(DRAIN_GET);
+		publish_stats_arr(stats_hdls.get_latency_hist, q_st.latency_hist, N_LATENCY_BUCKETS);
+		q_st = get_queue_stats(DRAIN_SET);
+		publish_stats_arr(stats_hdls.set_latency_hist, q_st.latency_hist, N_LATENCY_BUCKETS);
+
+		int64_t t_now = get_time_ns();
+		if (stats_writer != nullptr && t_now >= t_next_dump_ns)
+		{
+			stats_report report = get_stats_report();
+			{
+				std::lock_guard<std::mutex> lock(stats_mutex);
+				pending_report = std::move(report);
+				is_report_pending = true;
+			}
+			stats_cv.notify_one();
+			t_next_dump_ns = t_now + stats_dump_interval_ns;
+		}
+	}
+
+	void DataBus::publish_stats_arr(dr_handle_t dr, uint64_t* vals, size_t n)
+	{
+		generic_ptr* ptr = get_direct_ptr(dr);
+		if (ptr == nullptr || !(ptr->ptr_type & xplmType_IntArray))
+		{
+			return;
+		}
+		SeqBuf<int>* buf = reinterpret_cast<SeqBuf<int>*>(ptr->ptr);
+		int tmp[N_LATENCY_BUCKETS + N_DRAIN_QUEUES];
+		n = std::min(n, sizeof(tmp) / sizeof(tmp[0]));
+		for (size_t i = 0; i < n; i++)
+		{
+			// Datarefs are 32 bit, so counters saturate
+			tmp[i] = int(std::min(vals[i], uint64_t(INT32_MAX)));
+		}
+		buf->write(tmp, 0, n);
+	}
+
+	void DataBus::stats_writer_main()
+	{
+		std::unique_lock<std::mutex> lock(stats_mutex);
+		while (true)
+		{
+			stats_cv.wait(lock, [this]() { return is_report_pending || is_stats_writer_stopping; });
+			if (!is_report_pending)
 			{
-				trigger_cmd_once(&data.dref);
+				return;
 			}
-			
-			counter++;
+			// File I/O is done without the lock, so the main thread never waits for it
+			stats_report report = std::move(pending_report);
+			is_report_pending = false;
+			lock.unlock();
+			write_stats_report(stats_dump_path, &report);
+			lock.lock();
+		}
+	}
+
+	void DataBus::stop_stats_writer()
+	{
+		if (stats_writer == nullptr)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(stats_mutex);
+			is_stats_writer_stopping = true;
 		}
+		stats_cv.notify_one();
+		stats_writer->join();
+		delete stats_writer;
+		stats_writer = nullptr;
 	}
 
 	XPLMFlightLoopID DataBus::reg_flt_loop()
@@ -662,9 +2487,20 @@ namespace XPDataBus
 									(void)counter;
 
 									DataBus* ptr = reinterpret_cast<DataBus*>(ref);
-									ptr->get_xplm_mag_var();
-									ptr->get_data_refs();
-									ptr->set_data_refs();
+									if (ptr->recorder.is_on())
+									{
+										traffic_rec rec = { 0, REC_FRAME, MAIN_CHANNEL, 
+											INVALID_DR_HANDLE, generic_val{ {0}, "", 0, 0 }, 
+											0, 0, false, 0 };
+										ptr->recorder.add(&rec);
+									}
+									ptr->cache_frame++;
+									int64_t t_start = get_time_ns();
+									ptr->update_queue_depths();
+									ptr->update_snapshot();
+									ptr->check_watches();
+									ptr->drain_queues();
+									ptr->update_stats(get_time_ns() - t_start);
 									return -1;
 								};
 		return XPLMCreateFlightLoop(&loop);
@@ -674,19 +2510,42 @@ namespace XPDataBus
 	{
 		
 		is_operative.store(false, ATOMIC_ORDR);
-		std::lock_guard<std::mutex> lock(get_queue_mutex);
-		while (get_queue.size())
+		get_req data;
+		while (pop_next(DRAIN_GET, &get_queue, &producer_channel::get_queue, &data) >= 0)
+		{
+			data.slot->val = { {0}, "", 0, 0 };
+			data.slot->complete();
+		}
+		batch_get_req batch;
+		while (pop_next(DRAIN_BATCH_GET, &batch_get_queue, &producer_channel::batch_get_queue, 
+			&batch) >= 0)
+		{
+			batch.slot->complete();
+		}
+		mag_var_req mag_var;
+		while (pop_next(DRAIN_MAG_VAR, &mag_var_queue, &producer_channel::mag_var_queue, 
+			&mag_var) >= 0)
+		{
+			mag_var.slot->complete();
+		}
+		watch_req watch;
+		while (pop_next(DRAIN_WATCH, &watch_queue, &producer_channel::watch_queue, &watch) >= 0)
+		{
+			watch_waits.push_back(watch);
+		}
+		for (size_t i = 0; i < watch_waits.size(); i++)
 		{
-			generic_val tmp = { {0}, "", 0, 0 };
-			get_req data = get_queue.front();
-			get_queue.pop();
-			data.prom->set_value(tmp);
+			watch_waits[i].slot->val.int_val = 0;
+			watch_waits[i].slot->complete();
 		}
+		watch_waits.clear();
 	}
 
 	void DataBus::disable()
 	{
 		XPLMDebugString("777_FMS: Disabling databus\n");
+		stop_recording();
+		stop_stats_writer();
 		delete[] path_sep;
 		if (flt_loop_id != nullptr)
 		{
@@ -696,6 +2555,13 @@ namespace XPDataBus
 
 	DataBus::~DataBus()
 	{
-		
+		stop_stats_writer();
+		delete[] direct_ptrs;
+		delete[] snap_bufs;
+		delete[] dr_req_cnt;
+		for (int i = 0; i < N_MAX_PRODUCERS; i++)
+		{
+			delete producers[i].load(ATOMIC_ORDR);
+		}
 	}
 }
\ No newline at end of file
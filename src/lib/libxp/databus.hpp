@@ -21,11 +21,18 @@
 #include <XPLMPlugin.h>
 #include <XPLMScenery.h>
 #include "common.hpp"
+#include "mpsc_ring.hpp"
+#include "spsc_ring.hpp"
+#include "completion_slot.hpp"
+#include "seq_buf.hpp"
+#include "traffic_log.hpp"
+#include "mag_var_grid.hpp"
+#include "mag_model.hpp"
 #include <vector>
-#include <queue>
-#include <future>
+#include <thread>
 #include <unordered_map>
-#include <mutex>
+#include <map>
+#include <deque>
 
 
 namespace XPDataBus
@@ -35,35 +42,374 @@ namespace XPDataBus
 	constexpr int PATH_BUF_SIZE = 256;
 	constexpr std::memory_order ATOMIC_ORDR = std::memory_order_seq_cst;
 
-	struct geo_point
+	// Number of preallocated request slots in each queue
+	constexpr size_t MAG_VAR_QUEUE_SIZE = 256;
+	constexpr size_t GET_QUEUE_SIZE = 1024;
+	constexpr size_t BATCH_GET_QUEUE_SIZE = 256;
+	constexpr size_t SET_QUEUE_SIZE = 4096; // Per priority lane
+	constexpr size_t WATCH_QUEUE_SIZE = 64;
+
+	// Sizes of the queues of a registered producer. Blocking requests are made
+	// one at a time, so only gets and sets need room for more than a few.
+	constexpr int N_MAX_PRODUCERS = 16;
+	constexpr size_t PRODUCER_MAG_VAR_QUEUE_SIZE = 4;
+	constexpr size_t PRODUCER_GET_QUEUE_SIZE = 256;
+	constexpr size_t PRODUCER_BATCH_GET_QUEUE_SIZE = 4;
+	constexpr size_t PRODUCER_SET_QUEUE_SIZE = 1024;
+	constexpr size_t PRODUCER_WATCH_QUEUE_SIZE = 4;
+	constexpr int SHARED_CHANNEL = 0;
+	// Recorded as the channel of requests that the data bus makes itself
+	constexpr int MAIN_CHANNEL = -1;
+
+	// Reads a thread can have in flight through get_data_async. Enough for both VOR/DME radios.
+	constexpr int N_ASYNC_SLOTS = 8;
+
+	// Plugin-owned datarefs with handles below this are accessed without the main thread
+	constexpr size_t N_MAX_DIRECT_DRS = 2048;
+
+	/*
+		Array datarefs up to this length are read as a whole the first time
+		they're read in a frame. Later reads during the same frame are 
+		served from that copy.
+	*/
+	constexpr int N_MAX_CACHED_ARR_LENGTH = 64;
+
+	constexpr size_t N_MAX_SNAPSHOT_DRS = 256;
+
+	/*
+		Histograms have log2 buckets. Bucket i counts values below 2^(i+1) us, 
+		the last bucket counts everything that doesn't fit into the others.
+	*/
+	constexpr int N_LATENCY_BUCKETS = 16;
+	// Requests are counted for each dataref with a handle below this
+	constexpr size_t N_MAX_COUNTED_DRS = 2048;
+	// Number of datarefs with the most requests that are listed in the report
+	constexpr size_t N_STATS_TOP_DRS = 20;
+	constexpr size_t N_SNAPSHOT_BUFS = 2;
+
+	// Initial estimate of the time it takes to process one request
+	constexpr double DRAIN_COST_INIT_US = 1;
+	// Gain of the low-pass filter applied to measured cost per request
+	constexpr double DRAIN_COST_FILTER_K = 0.1;
+
+	typedef int snap_handle_t;
+	constexpr snap_handle_t INVALID_SNAP_HANDLE = -1;
+
+	typedef int watch_handle_t;
+	constexpr watch_handle_t INVALID_WATCH_HANDLE = -1;
+
+	/*
+		Priority class of set requests and commands. Each class has its own lane.
+		Lanes are drained in this order and the flight lane is drained completely
+		every frame, even if that exceeds the frame budget.
+	*/
+
+	enum class req_priority
 	{
-		double lat, lon;
+		PRIO_FLIGHT = 0, // Radio tuning, position outputs
+		PRIO_NORMAL = 1,
+		PRIO_UI = 2 // CDU page contents
 	};
 
-	struct mag_var_req
+	constexpr int N_PRIO_LANES = 3;
+
+	enum drain_queue_id
+	{
+		DRAIN_MAG_VAR = 0,
+		DRAIN_GET = 1,
+		DRAIN_BATCH_GET = 2,
+		DRAIN_SET = 3,
+		DRAIN_WATCH = 4,
+		N_DRAIN_QUEUES = 5
+	};
+
+	struct mag_var_point
 	{
 		geo_point point;
-		std::promise<float>* prom;
+		int node; // Node of the magnetic variation grid or -1 if the point isn't cached
+		float mag_var; // Written by the main thread
+	};
+
+	// Points are computed in one go, so the request never takes more than a frame
+	struct mag_var_req
+	{
+		mag_var_point* points;
+		size_t n_points;
+		CompletionSlot* slot;
+		int64_t t_queued_ns;
+	};
+
+	/*
+		Buffer of the requesting thread that a slice of an array is read into.
+		val_type is either xplmType_IntArray or xplmType_FloatArray.
+	*/
+
+	struct range_buf
+	{
+		void* vals;
+		int val_type;
+		int n_vals;
 	};
 
 	struct get_req
 	{
-		std::string dref;
-		std::promise<generic_val>* prom;
+		dr_handle_t dref;
+		CompletionSlot* slot;
 		int offset;
+		int64_t t_queued_ns;
+		range_buf range; // n_vals is 0 unless a slice is requested
+	};
+
+	struct batch_entry
+	{
+		dr_handle_t dref;
+		int offset;
+	};
+
+	/*
+		A batch of get requests. All of the datarefs in the batch are read
+		during the same frame and the requesting thread is woken up once.
+	*/
+
+	/*
+		A read queued by get_data_async. It has to be passed to get_async_val
+		once, from the thread that queued it.
+	*/
+
+	struct async_get
+	{
+		int slot_idx; // Index into the thread's async_slot_pool, -1 if val is ready
+		uint64_t ticket;
+		generic_val val;
+	};
+
+	// Completion slots of the reads a thread has in flight through get_data_async
+	struct async_slot_pool
+	{
+		CompletionSlot slots[N_ASYNC_SLOTS];
+		bool is_busy[N_ASYNC_SLOTS] = {};
+	};
+
+	struct batch_get_req
+	{
+		std::vector<batch_entry>* drs;
+		std::vector<generic_val>* out;
+		CompletionSlot* slot;
+		int64_t t_queued_ns;
+	};
+
+	/*
+		A thread waiting for a change in one of the datarefs of a watch.
+		The main thread completes slot once something has changed or 
+		the deadline has passed. The result is written to slot->val.int_val.
+	*/
+
+	struct watch_req
+	{
+		watch_handle_t watch;
+		CompletionSlot* slot;
+		int64_t t_deadline_ns; // Steady clock
+		int64_t t_queued_ns;
+	};
+
+	/*
+		A set of datarefs that threads can wait on. last holds the values
+		that were current when the previous waiter was woken up.
+	*/
+
+	struct watch_entry
+	{
+		std::vector<batch_entry> drs;
+		std::vector<generic_val> last;
 	};
 
 	struct set_req
 	{
-		std::string dref;
+		dr_handle_t dref;
 		bool set_cmd;
 		generic_val val;
+		int64_t t_queued_ns; // Time of the set_ call, steady clock
+		int channel; // Set by the main thread when the request is collected
+		// Slices written by set_datavi/set_datavf, starting at val.offset
+		std::vector<int> range_i;
+		std::vector<float> range_f;
+	};
+
+	/*
+		Counters of one set lane. Latency is measured from the set_ call 
+		until the value is written to the dataref.
+	*/
+
+	struct lane_stats
+	{
+		uint64_t n_applied;
+		uint64_t depth; // Requests left over at the end of the last frame
+		uint64_t max_depth; // Largest number of requests waiting at the start of a frame
+		double avg_latency_us;
+		double max_latency_us;
+	};
+
+	struct lane_counters
+	{
+		std::atomic<uint64_t> n_applied;
+		std::atomic<uint64_t> depth;
+		std::atomic<uint64_t> max_depth;
+		std::atomic<uint64_t> latency_sum_ns;
+		std::atomic<uint64_t> max_latency_ns;
+	};
+
+	/*
+		Counters of one request channel. Wait time is measured from the 
+		moment a request is queued until the main thread serves it.
+	*/
+
+	struct channel_stats
+	{
+		std::string name;
+		uint64_t n_reqs;
+		uint64_t n_direct; // Requests that didn't go through the main thread
+		double avg_wait_us;
+		double max_wait_us;
+		double blocked_us; // Time the channel's threads waited for a full queue
+	};
+
+	struct channel_counters
+	{
+		std::atomic<uint64_t> n_reqs;
+		std::atomic<uint64_t> n_direct;
+		std::atomic<uint64_t> wait_sum_ns;
+		std::atomic<uint64_t> max_wait_ns;
+	};
+
+	/*
+		Counters of one type of request queue. Latency is measured from the
+		moment a request is queued until the main thread completes it. Depth
+		is the number of queued requests of all channels at the start of a frame.
+	*/
+
+	struct queue_stats
+	{
+		uint64_t n_served;
+		uint64_t depth;
+		uint64_t max_depth;
+		uint64_t latency_hist[N_LATENCY_BUCKETS];
+	};
+
+	struct queue_counters
+	{
+		std::atomic<uint64_t> n_served;
+		std::atomic<uint64_t> depth;
+		std::atomic<uint64_t> max_depth;
+		std::atomic<uint64_t> latency_hist[N_LATENCY_BUCKETS];
+	};
+
+	// Time that the flight loop of the data bus takes per frame
+	struct drain_stats
+	{
+		uint64_t n_frames;
+		double last_us;
+		double avg_us;
+		double max_us;
+		uint64_t hist[N_LATENCY_BUCKETS];
+	};
+
+	struct drain_counters
+	{
+		std::atomic<uint64_t> n_frames;
+		std::atomic<uint64_t> last_ns;
+		std::atomic<uint64_t> sum_ns;
+		std::atomic<uint64_t> max_ns;
+		std::atomic<uint64_t> hist[N_LATENCY_BUCKETS];
+	};
+
+	// Everything dump_stats writes, copied on the main thread
+	struct stats_report
+	{
+		drain_stats drain;
+		queue_stats queues[N_DRAIN_QUEUES];
+		std::vector<channel_stats> channels;
+		std::vector<std::pair<std::string, uint64_t>> top_drs;
+	};
+
+	/*
+		Handles of the read-only datarefs that statistics are published through.
+		drain_us and max_drain_us are doubles. n_served and queue_depth are
+		int arrays indexed by drain_queue_id, the histograms are int arrays
+		of N_LATENCY_BUCKETS.
+	*/
+
+	struct databus_stats_hdls
+	{
+		dr_handle_t drain_us, max_drain_us, n_served, queue_depth, 
+			get_latency_hist, set_latency_hist, drain_hist;
+	};
+
+	/*
+		Request queues of a registered producer thread. The producer is the
+		only thread that pushes, the main thread is the only one that pops,
+		so producers never contend with each other.
+	*/
+
+	struct producer_channel
+	{
+		std::string name;
+		int channel;
+		SPSCRing<mag_var_req> mag_var_queue;
+		SPSCRing<get_req> get_queue;
+		SPSCRing<batch_get_req> batch_get_queue;
+		SPSCRing<set_req> set_queues[N_PRIO_LANES];
+		SPSCRing<watch_req> watch_queue;
+		channel_counters cnt;
+
+		producer_channel(std::string nm, int ch): name(nm), channel(ch), 
+			mag_var_queue(PRODUCER_MAG_VAR_QUEUE_SIZE), get_queue(PRODUCER_GET_QUEUE_SIZE),
+			batch_get_queue(PRODUCER_BATCH_GET_QUEUE_SIZE), set_queues{PRODUCER_SET_QUEUE_SIZE,
+			PRODUCER_SET_QUEUE_SIZE, PRODUCER_SET_QUEUE_SIZE}, 
+			watch_queue(PRODUCER_WATCH_QUEUE_SIZE)
+		{
+			cnt.n_reqs.store(0, std::memory_order_relaxed);
+			cnt.n_direct.store(0, std::memory_order_relaxed);
+			cnt.wait_sum_ns.store(0, std::memory_order_relaxed);
+			cnt.max_wait_ns.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	/*
+		Numeric part of a generic_val. raw holds the bytes of the value union.
+		Every field is atomic so that readers can copy it while the main 
+		thread writes the other buffer.
+	*/
+
+	struct snap_val
+	{
+		std::atomic<uint64_t> raw;
+		std::atomic<int> val_type;
+	};
+
+	/*
+		One frame of subscribed datarefs. seq is odd while the main thread
+		is writing to the buffer and equals 2 * frame number once it's done.
+	*/
+
+	struct snap_buf
+	{
+		std::atomic<uint64_t> seq;
+		snap_val vals[N_MAX_SNAPSHOT_DRS];
 	};
 
 	struct data_ref_entry
 	{
+		std::string name;
 		XPLMDataRef ref;
 		XPLMDataTypeID dr_type;
+		bool is_custom; // True if the dataref is owned by this plugin
+		generic_ptr custom_val;
+
+		// Copy of an array dataref taken during the frame number cache_frame
+		int arr_length; // -1 until the first read
+		uint64_t cache_frame;
+		std::vector<int> cache_i;
+		std::vector<float> cache_f;
 	};
 
 	struct cmd_entry
@@ -83,13 +429,13 @@ namespace XPDataBus
 	{
 	public:
 		std::atomic<bool> is_operative;
-		std::queue<mag_var_req> mag_var_queue;
-		std::mutex mag_var_queue_mutex;
-		std::queue<get_req> get_queue;
-		std::mutex get_queue_mutex;
-		std::queue<set_req> set_queue;
-		std::mutex set_queue_mutex;
-		uint64_t max_queue_refresh;
+		// Shared channel. Used by threads that haven't called reg_producer.
+		MPSCRing<mag_var_req> mag_var_queue;
+		MPSCRing<get_req> get_queue;
+		MPSCRing<batch_get_req> batch_get_queue;
+		MPSCRing<set_req> set_queues[N_PRIO_LANES];
+		MPSCRing<watch_req> watch_queue;
+		double frame_budget_us; // Time the flight loop may spend processing requests each frame
 
 		int xplane_version;
 		int sdk_version;
@@ -105,42 +451,260 @@ namespace XPDataBus
 
 
 		DataBus(std::vector<XPDataBus::cmd_entry>* cmds, 
-			std::vector<custom_data_ref_entry>* data_refs, uint64_t max_q_refresh, 
+			std::vector<custom_data_ref_entry>* data_refs, double budget_us, 
 			std::string sign);
 
+		// Ran from main thread only, before the returned handle is used:
+
+		/*
+			Returns a handle to a dataref. Datarefs that aren't owned by this plugin
+			are looked up right away, so the flight loop never has to do that.
+			Registering the same name twice returns the same handle.
+		*/
+
+		dr_handle_t reg_data_ref(std::string dr_name);
+
+		std::vector<dr_handle_t> reg_data_refs(std::vector<std::string>* dr_names);
+
+		/*
+			Until end_dr_report is called, datarefs registered by the systems are
+			counted into a single report instead of each missing name being logged
+			on its own. Names that failed are remembered, so later calls to 
+			reg_data_ref with them don't search again.
+		*/
+
+		void begin_dr_report();
+
+		/*
+			Prints the number of datarefs registered since begin_dr_report, the
+			time spent looking them up and the names that couldn't be found.
+			Returns the number of unresolved datarefs.
+		*/
+
+		size_t end_dr_report();
+
+		dr_handle_t reg_cmd(std::string cmd_name);
+
+		std::string get_dr_name(dr_handle_t dr);
+
+		/*
+			Adds a dataref to the per-frame snapshot. The flight loop copies all
+			subscribed datarefs once per frame, so they can be read without a
+			round trip. Only numeric values are copied, strings aren't supported.
+			Subscribing to the same dataref and offset twice returns the same handle.
+		*/
+
+		snap_handle_t subscribe(dr_handle_t dr, int offset=0);
+
+		std::vector<snap_handle_t> subscribe(std::vector<batch_entry>* drs);
+
+		/*
+			Adds a set of datarefs that threads can wait on with wait_for_change.
+			The values at the time of this call are the baseline that the first 
+			wait compares against. Strings are compared as well as numbers.
+		*/
+
+		watch_handle_t add_watch(std::vector<batch_entry>* drs);
+
 		// Ran from any thread:
 
+		/*
+			Gives the calling thread a request channel of its own, so its 
+			requests never contend with those of other threads. The flight loop
+			visits channels round-robin. Call once at the start of a long-lived
+			thread. Returns false if all channels are taken, in which case the 
+			thread keeps using the shared channel.
+		*/
+
+		bool reg_producer(std::string name);
+
+		/*
+			Returns counters of the shared channel followed by those of 
+			every registered producer.
+		*/
+
+		std::vector<channel_stats> get_channel_stats();
+
+		queue_stats get_queue_stats(drain_queue_id queue_id);
+
+		drain_stats get_drain_stats();
+
+		/*
+			Datarefs owned by this plugin are read and written directly by 
+			the calling thread. Everything else goes through the main thread.
+			As a result, a set of a plugin-owned dataref may take effect 
+			before sets of sim datarefs that were queued earlier.
+		*/
+
 		float get_mag_var(double lat, double lon);
 
-		generic_val get_data(std::string dr_name, int offset=0);
+		/*
+			Magnetic variation at points that fall into cached cells of the grid
+			is interpolated by the calling thread. Missing nodes of the grid are
+			requested from the main thread in one batch.
+		*/
+
+		void get_mag_var_batch(std::vector<geo_point>* points, std::vector<float>* out);
+
+		generic_val get_data(dr_handle_t dr, int offset=0);
+
+		int get_datai(dr_handle_t dr, int offset=0);
+
+		float get_dataf(dr_handle_t dr, int offset=0);
+
+		double get_datad(dr_handle_t dr, int offset=0);
+
+		std::string get_data_s(dr_handle_t dr, int offset=0);
+
+		/*
+			Queues a read and returns right away. Up to N_ASYNC_SLOTS reads can 
+			be issued before collecting them with get_async_val, so reads issued 
+			together get served within the same frame. Nothing is allocated: 
+			the reads complete into slots that the thread reuses. If all of them
+			are taken, the read is done before returning.
+		*/
+
+		async_get get_data_async(dr_handle_t dr, int offset=0);
+
+		// Waits for a read queued by get_data_async and returns its value
+		generic_val get_async_val(async_get* req);
+
+		/*
+			Read n elements of an array dataref starting at offset in a single
+			request. out gets resized to the number of elements read, which is 
+			also returned.
+		*/
+
+		int get_datavi(dr_handle_t dr, std::vector<int>* out, int offset, int n);
+
+		int get_datavf(dr_handle_t dr, std::vector<float>* out, int offset, int n);
+
+		/*
+			Reads all of the datarefs in drs within a single frame.
+			out gets resized to the size of drs. The i-th value of out
+			corresponds to the i-th entry of drs.
+		*/
+
+		void get_data_batch(std::vector<batch_entry>* drs, std::vector<generic_val>* out);
+
+		/*
+			Reads subscribed datarefs from the latest snapshot without blocking.
+			All of the values come from the same frame. out gets resized to the 
+			size of hdls. Returns the frame number of the snapshot, 0 if no 
+			snapshot has been taken yet. out is all zeros in that case, so
+			callers should skip it rather than treat it as the sim's state.
+		*/
+
+		uint64_t get_snapshot(std::vector<snap_handle_t>* hdls, std::vector<generic_val>* out);
+
+		/*
+			Blocks until any dataref of the watch differs from the values the 
+			previous wait on it returned with, or until timeout_ms has passed.
+			The main thread compares the values once per frame, so the waiting 
+			thread makes no requests while nothing changes. Returns true if 
+			something has changed. Only one thread may wait on a watch at a time.
+		*/
+
+		bool wait_for_change(watch_handle_t watch, int timeout_ms);
+
+		/*
+			Returns the number of set requests that were overwritten by a newer
+			request to the same dataref and offset before being applied.
+		*/
 
-		int get_datai(std::string dr_name, int offset=0);
+		uint64_t get_n_sets_dropped();
 
-		float get_dataf(std::string dr_name, int offset=0);
+		lane_stats get_lane_stats(req_priority prio);
 
-		double get_datad(std::string dr_name, int offset=0);
+		void cmd_once(dr_handle_t cmd, req_priority prio=req_priority::PRIO_NORMAL);
 
-		std::string get_data_s(std::string dr_name, int offset=0);
+		void set_data(dr_handle_t dr, generic_val value, req_priority prio=req_priority::PRIO_NORMAL);
 
-		void cmd_once(std::string cmd_name);
+		void set_datai(dr_handle_t dr, int value, int offset=-1, 
+			req_priority prio=req_priority::PRIO_NORMAL);
 
-		void set_data(std::string dr_name, generic_val value);
+		void set_dataf(dr_handle_t dr, float value, int offset=-1, 
+			req_priority prio=req_priority::PRIO_NORMAL);
 
-		void set_datai(std::string dr_name, int value, int offset=-1);
+		// Scalar writes with a priority other than PRIO_NORMAL:
 
-		void set_dataf(std::string dr_name, float value, int offset=-1);
+		void set_datai(dr_handle_t dr, int value, req_priority prio);
 
-		void set_datad(std::string dr_name, double value);
+		void set_dataf(dr_handle_t dr, float value, req_priority prio);
 
-		void set_data_s(std::string dr_name, std::string in, int offset=0);
+		void set_datad(dr_handle_t dr, double value, req_priority prio=req_priority::PRIO_NORMAL);
+
+		void set_data_s(dr_handle_t dr, std::string in, int offset=0, 
+			req_priority prio=req_priority::PRIO_NORMAL);
+
+		/*
+			Write all elements of in to an array dataref starting at offset.
+			The slice is written with a single call. Slices are never merged
+			with other set requests.
+		*/
+
+		void set_datavi(dr_handle_t dr, std::vector<int> in, int offset=0, 
+			req_priority prio=req_priority::PRIO_NORMAL);
+
+		void set_datavf(dr_handle_t dr, std::vector<float> in, int offset=0, 
+			req_priority prio=req_priority::PRIO_NORMAL);
 
 		// Ran from main thread only:
 
-		void get_xplm_mag_var();
+		/*
+			Loads coefficients of the World Magnetic Model from a WMM.COF file.
+			After that, magnetic variation is computed by the calling thread
+			instead of being requested from X-plane. The model is evaluated for
+			the date of the system clock at load time, not the sim date.
+		*/
 
-		void get_data_refs();
-		
-		void set_data_refs();
+		bool load_mag_model(std::string path);
+
+		/*
+			Starts writing every get, set, command and magnetic variation request
+			that the data bus serves to a binary log at path. Values are recorded 
+			as they were read or written. See traffic_log.hpp for the format.
+			Returns false if the log couldn't be opened.
+		*/
+
+		bool start_recording(std::string path);
+
+		void stop_recording();
+
+		// Number of records that didn't fit into the queue of the log writer
+		uint64_t get_n_recs_dropped();
+
+		/*
+			Publishes statistics through the datarefs in hdls every frame. The 
+			datarefs have to be owned by this plugin. If dump_path isn't empty,
+			a text report is written there every dump_interval_sec. The report
+			is written by a background thread, so the flight loop only copies
+			the counters.
+		*/
+
+		void publish_stats(databus_stats_hdls* hdls, std::string dump_path, 
+			double dump_interval_sec);
+
+		/*
+			Returns names and request counts of the n most requested datarefs.
+			Only requests of other threads count, not the reads that the main
+			thread makes every frame to refresh snapshots and watches.
+		*/
+		std::vector<std::pair<std::string, uint64_t>> get_top_drs(size_t n);
+
+		bool dump_stats(std::string path);
+
+		void update_snapshot();
+
+		// Wakes up waiters whose watches have changed or whose deadlines have passed
+		void check_watches();
+
+		/*
+			Processes queued requests until the frame budget runs out
+			or all of the queues are empty.
+		*/
+
+		void drain_queues();
 
 		XPLMFlightLoopID reg_flt_loop();
 
@@ -155,9 +719,88 @@ namespace XPDataBus
 		XPLMFlightLoopID flt_loop_id;
 
 		std::unordered_map<std::string, XPLMCommandRef> all_cmds;
-		std::unordered_map<std::string, data_ref_entry> data_refs; // Datarefs not owned by this plugin
 		std::unordered_map<std::string, generic_ptr> custom_data_refs; // Datarefs owned by this plugin
 
+		// Name to handle maps. These are only used during registration.
+		std::unordered_map<std::string, dr_handle_t> dr_handles;
+		std::unordered_map<std::string, dr_handle_t> cmd_handles;
+
+		// Registration report, see begin_dr_report
+		bool is_dr_report_open;
+		size_t n_report_drs;
+		int64_t report_lookup_ns;
+		std::vector<std::string> report_unresolved;
+
+		// Flat tables indexed by handles:
+		std::vector<data_ref_entry> dr_entries;
+		std::vector<XPLMCommandRef> cmd_entries;
+		/*
+			Copies of custom_val of plugin-owned datarefs, indexed by handles.
+			Unlike dr_entries, this never reallocates, so other threads can 
+			read it while datarefs are being registered.
+		*/
+		generic_ptr* direct_ptrs;
+		/*
+			Incremented every frame and whenever a set or a command is applied, 
+			since either of them may change any dataref. Array copies taken 
+			during an older frame are stale.
+		*/
+		uint64_t cache_frame;
+
+		// Subscribed datarefs. Snapshot handles index into this vector.
+		std::vector<batch_entry> snap_drs;
+		std::map<std::pair<dr_handle_t, int>, snap_handle_t> snap_handles;
+
+		snap_buf* snap_bufs;
+		std::atomic<uint64_t> snap_frame;
+
+		// Watches are indexed by watch handles
+		std::vector<watch_entry> watches;
+		std::vector<watch_req> watch_waits; // Threads that are waiting for a change
+
+		/*
+			Set requests that haven't been applied yet, one list per lane. Only the
+			latest value for each dataref and offset is kept within a lane. 
+			Commands are never merged. pending_set_keys holds the writes that a 
+			new write may still be merged into, by dataref and offset.
+		*/
+		std::deque<set_req> pending_sets[N_PRIO_LANES];
+		std::unordered_map<dr_handle_t, std::unordered_map<int, set_req*>> 
+			pending_set_keys[N_PRIO_LANES];
+		std::atomic<uint64_t> n_sets_dropped;
+		lane_counters lane_cnt[N_PRIO_LANES];
+
+		/*
+			Producer channels. Slots are filled by reg_producer from any thread,
+			so the flight loop skips slots that are still null.
+		*/
+		std::atomic<producer_channel*> producers[N_MAX_PRODUCERS];
+		std::atomic<int> n_producers;
+		channel_counters shared_cnt;
+		// Channel that each of the request types gets popped from next
+		int rr_next[N_DRAIN_QUEUES];
+
+		TrafficRecorder recorder;
+		MagVarGrid mag_var_grid;
+		MagModel mag_model;
+		double mag_model_year; // Decimal year that the model is evaluated for
+
+		queue_counters queue_cnt[N_DRAIN_QUEUES];
+		drain_counters drain_cnt;
+		std::atomic<uint64_t>* dr_req_cnt; // Indexed by handles
+		bool is_publishing_stats;
+		databus_stats_hdls stats_hdls;
+		std::string stats_dump_path;
+		int64_t stats_dump_interval_ns;
+		int64_t t_next_dump_ns;
+		// Writes stats_dump_path, see publish_stats
+		std::thread* stats_writer;
+		std::mutex stats_mutex;
+		std::condition_variable stats_cv;
+		stats_report pending_report; // Guarded by stats_mutex
+		bool is_report_pending; // Guarded by stats_mutex
+		bool is_stats_writer_stopping; // Guarded by stats_mutex
+
 		std::string get_xplane_path();
 
 		std::string get_prefs_path();
@@ -168,30 +811,182 @@ namespace XPDataBus
 
 		std::string get_plugin_data_path();
 
-		void add_to_mag_var_queue(geo_point point, std::promise<float>* prom);
+		// Returns the completion slot of the calling thread
+		CompletionSlot* get_thread_slot();
+
+		async_slot_pool* get_thread_async_pool();
 
-		void add_to_get_queue(std::string dr_name, std::promise<generic_val>* prom, int offset);
+		// Returns the channel of the calling thread, nullptr if it hasn't registered
+		producer_channel* get_thread_channel();
 
-		XPLMDataRef add_data_ref_entry(std::string* dr_name);
+		int get_thread_channel_id();
+
+		/*
+			The following functions add a record to the traffic log if it's being
+			recorded. Slices are recorded one element at a time. They also count
+			the request for dr, slices are counted once.
+		*/
+
+		void record_val(int kind, int channel, dr_handle_t dr, generic_val* val);
+
+		void record_range(int kind, int channel, dr_handle_t dr, int offset, 
+			int val_type, void* vals, int n);
+
+		void record_channel(int channel, std::string name);
+
+		// Ran from main thread only
+		void record_dr_name(dr_handle_t dr);
+
+		// Ran from main thread only:
+
+		// Sums up the depth of every type of queue over all channels
+		void update_queue_depths();
+
+		// Updates frame counters, publishes statistics and hands the report to the writer when it's due
+		void update_stats(int64_t drain_ns);
+
+		void publish_stats_arr(dr_handle_t dr, uint64_t* vals, size_t n);
+
+		stats_report get_stats_report();
+
+		static bool write_stats_report(std::string path, stats_report* report);
+
+		void stats_writer_main();
+
+		void stop_stats_writer();
+
+		// Index 0 is the shared channel, producers start at 1
+		producer_channel* get_producer(int channel);
+
+		channel_counters* get_channel_counters(int channel);
+
+		/*
+			Returns the time producers have waited for the queues in q to have a free
+			slot. q is either a producer_channel or the data bus for the shared queues.
+		*/
+
+		template <class Q>
+		static uint64_t get_full_wait_ns(Q* q);
+
+		// Counts a request that has been completed by the main thread
+		void count_req(int queue_id, int channel, int64_t t_queued_ns);
+
+		// Counts a request that has been served by the requesting thread
+		void count_direct(int channel);
+
+		/*
+			Pops a request from the next channel in round-robin order that has one.
+			Returns the index of that channel or -1 if all of them are empty.
+		*/
+
+		template <class T>
+		int pop_next(int queue_id, MPSCRing<T>* shared_queue, 
+			SPSCRing<T> producer_channel::* queue, T* out);
+
+		void add_to_mag_var_queue(mag_var_point* points, size_t n_points, CompletionSlot* slot);
+
+		void get_mag_vars(geo_point* points, float* out, size_t n);
+
+		void add_to_get_queue(dr_handle_t dr, CompletionSlot* slot, int offset, 
+			range_buf range={nullptr, 0, 0});
+
+		void add_to_batch_get_queue(std::vector<batch_entry>* drs, std::vector<generic_val>* out, 
+			CompletionSlot* slot);
+
+		void add_to_set_queue(set_req* req, req_priority prio);
+
+		void add_to_watch_queue(watch_handle_t watch, CompletionSlot* slot, int timeout_ms);
+
+		data_ref_entry* get_dr_entry(dr_handle_t dr);
+
+		/*
+			Returns storage of dr if it's owned by this plugin, nullptr otherwise.
+			Can be called from any thread.
+		*/
+
+		generic_ptr* get_direct_ptr(dr_handle_t dr);
+
+		generic_val get_direct_val(generic_ptr* ptr, int offset);
+
+		// Reads a slice from any thread. Returns the number of elements read.
+		int get_range(dr_handle_t dr, int offset, range_buf* range);
 
 		// The get_ functions below return number of data items returned
 
-		int get_data_ref_value(std::string* dr_name, generic_val* out);
+		int get_data_ref_value(data_ref_entry* entry, generic_val* out);
+
+		int get_custom_data_ref_value(generic_ptr* val_ptr, generic_val* out);
+
+		generic_val get_any_data_ref(dr_handle_t dr, int offset);
+
+		/*
+			Reads n elements of an array that isn't owned by this plugin.
+			Goes through the copy of the array taken during this frame.
+		*/
+
+		template <class T>
+		int read_array(data_ref_entry* entry, std::vector<T>* cache, int offset, int n, T* out);
+
+		int get_custom_range(generic_ptr* ptr, int offset, range_buf* range);
+
+		int get_any_range(dr_handle_t dr, int offset, range_buf* range);
+
+		int set_custom_range(generic_ptr* ptr, set_req* req);
+
+		int set_any_range(dr_handle_t dr, set_req* req);
+
+		void trigger_cmd_once(dr_handle_t cmd);
+
+		void set_data_ref_value(data_ref_entry* entry, generic_val* in);
+
+		void set_custom_data_ref_value(generic_ptr* val_ptr, generic_val* in);
 
-		int get_custom_data_ref_value(std::string* dr_name, generic_val* out);
+		int set_data_ref(data_ref_entry* entry, generic_val* in);
 
-		int get_data_ref(std::string* dr_name, generic_val* out);
+		int set_custom_data_ref(generic_ptr* ptr, generic_val* in);
 
-		int get_custom_data_ref(std::string* dr_name, generic_val* out);
+		int set_any_data_ref(dr_handle_t dr, generic_val* in);
 
-		void trigger_cmd_once(std::string* cmd_name);
+		void add_pending_set(int lane, set_req* req);
+
+		// Called before req is applied. Later writes to its key can't be merged into it.
+		void remove_pending_key(int lane, set_req* req);
+
+		// Reads the datarefs of a watch. Returns true and updates last if any of them changed.
+		bool update_watch_vals(watch_entry* watch);
+
+		// Filtered cost of a single request in each of the queues
+		double item_cost_us[N_DRAIN_QUEUES];
+
+		// The functions below process one request and return the number
+		// of datarefs/items it contained. 0 means the queue is empty.
+
+		size_t get_xplm_mag_var();
+
+		size_t get_data_ref();
+
+		size_t get_data_ref_batch();
+
+		void collect_set_reqs();
+
+		// Applies one request from the highest priority lane that isn't empty
+		size_t set_data_ref();
+
+		// Wakes the waiter right away if its watch has already changed, parks it otherwise
+		size_t add_watch_wait();
+
+		// Ran from main thread only:
 
-		void set_data_ref_value(std::string* dr_name, generic_val* in);
+		/*
+			Looks up a dataref without logging anything. is_new is set to
+			true if the name hasn't been registered before.
+		*/
 
-		void set_custom_data_ref_value(std::string* dr_name, generic_val* in);
+		dr_handle_t add_data_ref_entry(std::string dr_name, bool* is_new);
 
-		int set_data_ref(std::string* dr_name, generic_val* in);
+		// Returns false if the dataref wasn't found in the sim
+		bool is_resolved(dr_handle_t dr);
 
-		int set_custom_data_ref(std::string* dr_name, generic_val* in);
+		size_t drain_one(int queue_id);
 	};
 }
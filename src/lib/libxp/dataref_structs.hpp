@@ -15,7 +15,12 @@
 #include <XPLMDataAccess.h>
 #include <XPLMPlugin.h>
 #include <XPLMUtilities.h>
+#include "seq_buf.hpp"
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #define MSG_ADD_DATAREF 0x01000000
 
@@ -29,9 +34,79 @@ enum dr_access
 namespace DRUtil
 {
 	constexpr char DEFAULT_STR_FILL_CHAR = ' ';
+	constexpr char DRE_SIGN[] = "xplanesdk.examples.DataRefEditor";
+	// Datarefs are announced to DataRefEditor this long after the first one has been created
+	constexpr float DRE_ANNOUNCE_DELAY_SEC = 1;
 
 
-	float regDRInDRE(float elapsedMe, float elapsedSim, int counter, void* ref);
+	class DREManager
+	{
+		/*
+			Tells DataRefEditor about the datarefs created by this plugin.
+			Names are collected as the datarefs are created and all of them
+			are sent from a single flight loop callback once the delay has
+			passed. Names aren't copied, so they have to outlive the
+			announcement or be removed before they are freed.
+		*/
+	public:
+		// Ran from main thread only:
+
+		static void add(const char* name)
+		{
+			pending.push_back(name);
+			if (!is_registered)
+			{
+				XPLMRegisterFlightLoopCallback(announce, DRE_ANNOUNCE_DELAY_SEC, nullptr);
+				is_registered = true;
+			}
+			else if (pending.size() == 1)
+			{
+				XPLMSetFlightLoopCallbackInterval(announce, DRE_ANNOUNCE_DELAY_SEC, 1, nullptr);
+			}
+		}
+
+		// Drops name if it hasn't been announced yet
+		static void remove(const char* name)
+		{
+			pending.erase(std::remove(pending.begin(), pending.end(), name), pending.end());
+		}
+
+		// Unregisters the callback. Ran at shutdown, after all datarefs have been unregistered.
+		static void cleanup()
+		{
+			if (is_registered)
+			{
+				XPLMUnregisterFlightLoopCallback(announce, nullptr);
+				is_registered = false;
+			}
+			pending.clear();
+		}
+
+	private:
+		static inline std::vector<const char*> pending;
+		static inline bool is_registered = false;
+
+
+		static float announce(float elapsedMe, float elapsedSim, int counter, void* ref)
+		{
+			(void)elapsedMe;
+			(void)elapsedSim;
+			(void)counter;
+			(void)ref;
+
+			XPLMPluginID dre_id = XPLMFindPluginBySignature(DRE_SIGN);
+			if (dre_id != XPLM_NO_PLUGIN_ID)
+			{
+				for (size_t i = 0; i < pending.size(); i++)
+				{
+					XPLMSendMessageToPlugin(dre_id, MSG_ADD_DATAREF, (void*)pending[i]);
+				}
+			}
+			pending.clear();
+			// Stays registered, but isn't called until add() schedules it again
+			return 0;
+		}
+	};
 
 
 	struct cmd_t
@@ -56,7 +131,7 @@ namespace DRUtil
 	};
 	
 
-	struct dref
+	struct dref_base
 	{
 		/*
 		Generic dataref structure. DO NOT USE!. This one has no type/value.
@@ -70,267 +145,223 @@ namespace DRUtil
 			/*
 			"Tells" dataref editor that the dataref has been created.
 			*/
-			XPLMRegisterFlightLoopCallback(regDRInDRE, 1, this);
+			DREManager::add(name);
 		}
 		void unReg()
 		{
 			if (xpdr != nullptr)
 			{
 				XPLMUnregisterDataAccessor(xpdr);
-				XPLMUnregisterFlightLoopCallback(regDRInDRE, this);
+				DREManager::remove(name);
 			}
 		}
 	};
 
-	struct dref_i
+
+	enum dr_shape
 	{
-		/*
-		Integer dataref structure.
-		*/
-		dref dr;
-		int val;
+		DR_SCALAR,
+		DR_ARRAY // Strings are arrays of char
+	};
+
+
+	/*
+		XPLM calls for every element type. buf_t is the type of the buffers
+		that XPLM passes to array accessors.
+	*/
 
-		int get()
+	template <class T>
+	struct dr_type_traits;
+
+	template <>
+	struct dr_type_traits<int>
+	{
+		typedef int buf_t;
+		static constexpr XPLMDataTypeID SCALAR_TYPE = xplmType_Int;
+		static constexpr XPLMDataTypeID ARRAY_TYPE = xplmType_IntArray;
+		static constexpr int FILL_VAL = 0;
+
+		static int get(XPLMDataRef dr)
 		{
-			if (dr.xpdr != nullptr)
-			{
-				return XPLMGetDatai(dr.xpdr);
-			}
-			return -1;
+			return XPLMGetDatai(dr);
 		}
 
-		void set(int v)
+		static void set(XPLMDataRef dr, int v)
 		{
-			if (dr.xpdr != nullptr)
-			{
-				XPLMSetDatai(dr.xpdr, v);
-			}
+			XPLMSetDatai(dr, v);
 		}
 
-		int init()
+		static int get_v(XPLMDataRef dr, int* out, int offset, int n)
 		{
-			/*
-			Initializes the dataref inside the sim.
-			Also notifies the dataref editor about the new dataref.
-			If the dataref already exists, just gives a handle to it
-			*/
+			return XPLMGetDatavi(dr, out, offset, n);
+		}
 
-			XPLMDataRef test_dr = XPLMFindDataRef(dr.name);
-			if (test_dr == nullptr)
-			{
-				dr.xpdr = XPLMRegisterDataAccessor(dr.name, xplmType_Int, dr.is_writable,
-						[](void* ref) {
-							dref_i* ptr = reinterpret_cast<dref_i*>(ref);
-							return ptr->val;
-						},
-						[](void* ref, int newVal) {
-							dref_i* ptr = reinterpret_cast<dref_i*>(ref);
-							ptr->val = newVal;
-						},
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						this, this);
-				dr.xpdr = XPLMFindDataRef(dr.name);
-				dr.regInDRE();
-			}
-			else
-			{
-				//Set variable to dataref's value if dataref already exists
-				dr.xpdr = test_dr;
-				val = XPLMGetDatai(dr.xpdr);
-			}
-			if (dr.xpdr == nullptr)
-			{
-				return 0;
-			}
-			return 1;
+		static void set_v(XPLMDataRef dr, int* in, int offset, int n)
+		{
+			XPLMSetDatavi(dr, in, offset, n);
 		}
 
-		void unReg()
+		static XPLMDataRef reg(const char* name, bool is_writable, XPLMGetDatai_f get_cb,
+			XPLMSetDatai_f set_cb, void* ref)
 		{
-			dr.unReg();
+			return XPLMRegisterDataAccessor(name, SCALAR_TYPE, is_writable, get_cb, set_cb,
+				nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+				nullptr, nullptr, ref, ref);
+		}
+
+		static XPLMDataRef reg_v(const char* name, bool is_writable, XPLMGetDatavi_f get_cb,
+			XPLMSetDatavi_f set_cb, void* ref)
+		{
+			return XPLMRegisterDataAccessor(name, ARRAY_TYPE, is_writable, nullptr, nullptr,
+				nullptr, nullptr, nullptr, nullptr, get_cb, set_cb, nullptr, nullptr,
+				nullptr, nullptr, ref, ref);
 		}
 	};
 
-	struct dref_f
+	template <>
+	struct dr_type_traits<float>
 	{
-		/*
-		Double dataref structure.
-		*/
-		dref dr;
-		float val;
+		typedef float buf_t;
+		static constexpr XPLMDataTypeID SCALAR_TYPE = xplmType_Float;
+		static constexpr XPLMDataTypeID ARRAY_TYPE = xplmType_FloatArray;
+		static constexpr float FILL_VAL = 0;
 
-		float get()
+		static float get(XPLMDataRef dr)
 		{
-			if (dr.xpdr != nullptr)
-			{
-				return XPLMGetDataf(dr.xpdr);
-			}
-			return -1;
+			return XPLMGetDataf(dr);
 		}
 
-		void set(float v)
+		static void set(XPLMDataRef dr, float v)
 		{
-			if (dr.xpdr != nullptr)
-			{
-				XPLMSetDataf(dr.xpdr, v);
-			}
+			XPLMSetDataf(dr, v);
 		}
 
-		int init()
+		static int get_v(XPLMDataRef dr, float* out, int offset, int n)
 		{
-			/*
-			Initializes the dataref inside the sim.
-			Also notifies the dataref editor about the new dataref.
-			If the dataref already exists, just gives a handle to it
-			*/
+			return XPLMGetDatavf(dr, out, offset, n);
+		}
 
-			XPLMDataRef test_dr = XPLMFindDataRef(dr.name);
-			if (test_dr == nullptr)
-			{
-				dr.xpdr = XPLMRegisterDataAccessor(dr.name, xplmType_Float, dr.is_writable,
-						nullptr, nullptr,
-						[](void* ref) -> float {
-							dref_f* ptr = reinterpret_cast<dref_f*>(ref);
-							return ptr->val;
-						},
-						[](void* ref, float newVal) {
-							dref_f* ptr = reinterpret_cast<dref_f*>(ref);
-							ptr->val = newVal;
-						},
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						this, this);
-				dr.xpdr = XPLMFindDataRef(dr.name);
-				dr.regInDRE();
-			}
-			else
-			{
-				//Set variable to dataref's value if dataref already exists
-				dr.xpdr = test_dr;
-				val = XPLMGetDataf(dr.xpdr);
-			}
-			if (dr.xpdr == nullptr)
-			{
-				return 0;
-			}
-			return 1;
+		static void set_v(XPLMDataRef dr, float* in, int offset, int n)
+		{
+			XPLMSetDatavf(dr, in, offset, n);
 		}
 
-		void unReg()
+		static XPLMDataRef reg(const char* name, bool is_writable, XPLMGetDataf_f get_cb,
+			XPLMSetDataf_f set_cb, void* ref)
 		{
-			dr.unReg();
+			return XPLMRegisterDataAccessor(name, SCALAR_TYPE, is_writable, nullptr, nullptr,
+				get_cb, set_cb, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+				nullptr, nullptr, ref, ref);
+		}
+
+		static XPLMDataRef reg_v(const char* name, bool is_writable, XPLMGetDatavf_f get_cb,
+			XPLMSetDatavf_f set_cb, void* ref)
+		{
+			return XPLMRegisterDataAccessor(name, ARRAY_TYPE, is_writable, nullptr, nullptr,
+				nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, get_cb, set_cb,
+				nullptr, nullptr, ref, ref);
 		}
 	};
 
-	struct dref_d
+	// Doubles can only be scalars
+	template <>
+	struct dr_type_traits<double>
 	{
-		/*
-		Double dataref structure.
-		*/
-		dref dr;
-		double val;
+		static constexpr XPLMDataTypeID SCALAR_TYPE = xplmType_Double;
 
-		double get()
+		static double get(XPLMDataRef dr)
 		{
-			if (dr.xpdr != nullptr)
-			{
-				val = XPLMGetDatad(dr.xpdr);
-				return val;
-			}
-			return -1;
+			return XPLMGetDatad(dr);
 		}
 
-		void set(double v)
+		static void set(XPLMDataRef dr, double v)
 		{
-			if (dr.xpdr != nullptr)
-			{
-				XPLMSetDatad(dr.xpdr, v);
-			}
+			XPLMSetDatad(dr, v);
 		}
 
-		int init()
+		static XPLMDataRef reg(const char* name, bool is_writable, XPLMGetDatad_f get_cb,
+			XPLMSetDatad_f set_cb, void* ref)
 		{
-			/*
-			Initializes the dataref inside the sim.
-			Also notifies the dataref editor about the new dataref.
-			If the dataref already exists, just gives a handle to it
-			*/
+			return XPLMRegisterDataAccessor(name, SCALAR_TYPE, is_writable, nullptr, nullptr,
+				nullptr, nullptr, get_cb, set_cb, nullptr, nullptr, nullptr, nullptr,
+				nullptr, nullptr, ref, ref);
+		}
+	};
 
-			XPLMDataRef test_dr = XPLMFindDataRef(dr.name);
-			if (test_dr == nullptr)
-			{
-				dr.xpdr = XPLMRegisterDataAccessor(dr.name, xplmType_Double, dr.is_writable,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						[](void* ref) -> double {
-							dref_d* ptr = reinterpret_cast<dref_d*>(ref);
-							return ptr->val;
-						},
-						[](void* ref, double newVal) {
-							dref_d* ptr = reinterpret_cast<dref_d*>(ref);
-							ptr->val = newVal;
-						},
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						this, this);
-				dr.xpdr = XPLMFindDataRef(dr.name);
-				dr.regInDRE();
-			}
-			else
-			{
-				//Set variable to dataref's value if dataref already exists
-				dr.xpdr = test_dr;
-				val = XPLMGetDatad(dr.xpdr);
-			}
-			if (dr.xpdr == nullptr)
-			{
-				return 0;
-			}
-			return 1;
+	// Strings can only be arrays
+	template <>
+	struct dr_type_traits<char>
+	{
+		typedef void buf_t;
+		static constexpr XPLMDataTypeID ARRAY_TYPE = xplmType_Data;
+		static constexpr char FILL_VAL = DEFAULT_STR_FILL_CHAR;
+
+		static int get_v(XPLMDataRef dr, char* out, int offset, int n)
+		{
+			return XPLMGetDatab(dr, out, offset, n);
 		}
 
-		void unReg()
+		static void set_v(XPLMDataRef dr, char* in, int offset, int n)
 		{
-			dr.unReg();
+			XPLMSetDatab(dr, in, offset, n);
+		}
+
+		static XPLMDataRef reg_v(const char* name, bool is_writable, XPLMGetDatab_f get_cb,
+			XPLMSetDatab_f set_cb, void* ref)
+		{
+			return XPLMRegisterDataAccessor(name, ARRAY_TYPE, is_writable, nullptr, nullptr,
+				nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+				get_cb, set_cb, ref, ref);
 		}
 	};
 
-	struct dref_ia
+
+	template <class T, dr_shape S>
+	struct dref;
+
+	template <class T>
+	struct dref<T, DR_SCALAR>
 	{
 		/*
-		Integer array dataref structure.
+		Scalar dataref structure. val is atomic, so it can be
+		accessed directly from any thread.
 		*/
-		dref dr;
-		int* array;
-		int n_length;
+		dref_base dr;
+		std::atomic<T> val;
+
+		dref(): dr{}, val(0) {}
+
+		dref(dref_base d, T v): dr(d), val(v) {}
 
-		int get(int pos)
+		dref(const dref& other): dr(other.dr), val(other.val.load()) {}
+
+		dref& operator=(const dref& other)
+		{
+			dr = other.dr;
+			val.store(other.val.load());
+			return *this;
+		}
+
+		T get()
 		{
 			if (dr.xpdr != nullptr)
 			{
-				int n_dr_length = XPLMGetDatavi(dr.xpdr, nullptr, 0, 0);
-				int retval;
-				if (pos < n_dr_length)
+				T v = dr_type_traits<T>::get(dr.xpdr);
+				// Doubles keep the value that was read, as dref_d always did
+				if constexpr (std::is_same<T, double>::value)
 				{
-					XPLMGetDatavi(dr.xpdr, &retval, pos, 1);
-					return retval;
+					val.store(v);
 				}
+				return v;
 			}
 			return -1;
 		}
 
-		void set(int pos)
+		void set(T v)
 		{
-			if (dr.xpdr != nullptr && pos < n_length)
+			if (dr.xpdr != nullptr)
 			{
-				XPLMSetDatavi(dr.xpdr, &array[pos], pos, 1);
+				dr_type_traits<T>::set(dr.xpdr, v);
 			}
 		}
 
@@ -342,148 +373,121 @@ namespace DRUtil
 			If the dataref already exists, just gives a handle to it
 			*/
 
-			if (array == nullptr)
-			{
-				dr.is_allocated = true;
-				array = new int[n_length];
-				for (int i = 0; i < n_length; i++)
-				{
-					array[i] = 0;
-				}
-			}
-
-			if (array == nullptr)
-			{
-				// If we've failed to allocate memory for the dataref,
-				// return.
-				return 0;
-			}
-
 			XPLMDataRef test_dr = XPLMFindDataRef(dr.name);
 			if (test_dr == nullptr)
 			{
-				dr.xpdr = XPLMRegisterDataAccessor(dr.name, xplmType_IntArray, dr.is_writable,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						[](void* ref, int* out_values, int in_offset, int in_max) {
-							dref_ia* ptr = reinterpret_cast<dref_ia*>(ref);
-							int arr_length = ptr->n_length;
-							if (out_values == nullptr || in_offset >= arr_length)
-							{
-								return arr_length;
-							}
-							int r = arr_length - in_offset;
-							if (r > in_max)
-							{
-								r = in_max;
-							}
-							for (int i = 0; i < r; i++)
-							{
-								out_values[i] = ptr->array[i + in_offset];
-							}
-							return r;
-						},
-						[](void* ref, int* in_values, int in_offset, int in_max) {
-							if (in_values != nullptr)
-							{
-								dref_ia* ptr = reinterpret_cast<dref_ia*>(ref);
-								int arr_length = ptr->n_length;
-								int r = arr_length - in_offset;
-								if (r > in_max)
-									r = in_max;
-								for (int i = 0; i < r; i++)
-								{
-									ptr->array[i + in_offset] = in_values[i];
-								}
-							}
-						},
-						nullptr, nullptr,
-						nullptr, nullptr,
-						this, this);
-				dr.xpdr = XPLMFindDataRef(dr.name);
-				XPLMSetDatavi(dr.xpdr, array, 0, n_length);
+				dr.xpdr = dr_type_traits<T>::reg(dr.name, dr.is_writable, get_cb, set_cb, 
+					this);
 				dr.regInDRE();
 			}
 			else
 			{
 				//Set variable to dataref's value if dataref already exists
 				dr.xpdr = test_dr;
-				int n_dr_length = XPLMGetDatavi(dr.xpdr, nullptr, 0, 0);
-				int n_val_get = n_length;
-				if (n_dr_length < n_val_get)
-				{
-					n_val_get = n_dr_length;
-				}
-				XPLMGetDatavi(dr.xpdr, array, 0, n_val_get);
+				val.store(dr_type_traits<T>::get(dr.xpdr));
 			}
 			if (dr.xpdr == nullptr)
 			{
 				return 0;
 			}
-			
 			return 1;
 		}
 
 		void unReg()
 		{
 			dr.unReg();
-			if (dr.is_allocated)
-			{
-				delete[] array;
-				array = nullptr;
-			}
+		}
+
+	private:
+		static T get_cb(void* ref)
+		{
+			dref* ptr = reinterpret_cast<dref*>(ref);
+			return ptr->val.load(std::memory_order_relaxed);
+		}
+
+		static void set_cb(void* ref, T new_val)
+		{
+			dref* ptr = reinterpret_cast<dref*>(ref);
+			ptr->val.store(new_val, std::memory_order_relaxed);
 		}
 	};
 
-	struct dref_fa
+	template <class T>
+	struct dref<T, DR_ARRAY>
 	{
 		/*
-			Float array dataref structure.
+		Array dataref structure. The length of datarefs that aren't
+		owned by this plugin is read once in init(), so accessors don't
+		have to ask the sim for it.
 		*/
-		dref dr;
-		float* array;
+		typedef typename dr_type_traits<T>::buf_t buf_t;
+
+		dref_base dr;
+		XPDataBus::SeqBuf<T>* array;
 		int n_length;
+		int n_dr_length; // Length of the dataref in the sim. Valid after init().
+
+		dref(): dr{}, array(nullptr), n_length(0), n_dr_length(0) {}
 
-		float get(int pos)
+		dref(dref_base d, XPDataBus::SeqBuf<T>* arr, int n): dr(d), array(arr), 
+			n_length(n), n_dr_length(0) {}
+
+		// Returns -1 if pos is out of bounds
+		T get(int pos)
 		{
-			if (dr.xpdr != nullptr)
+			T retval = -1;
+			get_range(&retval, pos, 1);
+			return retval;
+		}
+
+		// Writes the element of array at pos to the sim
+		void set(int pos)
+		{
+			if (array != nullptr && pos >= 0 && pos < n_length)
 			{
-				int n_dr_length = XPLMGetDatavf(dr.xpdr, nullptr, 0, 0);
-				float retval;
-				if (pos < n_dr_length)
-				{
-					XPLMGetDatavf(dr.xpdr, &retval, pos, 1);
-					return retval;
-				}
+				T v = array->get(size_t(pos));
+				set_range(&v, pos, 1);
 			}
-			return -1;
 		}
 
-		void set(int pos)
+		/*
+			Read/write up to n elements starting at offset with one call to
+			the sim. Return the number of elements copied.
+		*/
+
+		int get_range(T* out, int offset, int n)
 		{
-			if (dr.xpdr != nullptr && pos < n_length)
+			n = clamp_n(offset, n);
+			if (n > 0)
 			{
-				XPLMSetDatavf(dr.xpdr, &array[pos], pos, 1);
+				return dr_type_traits<T>::get_v(dr.xpdr, out, offset, n);
 			}
+			return 0;
+		}
+
+		int set_range(const T* in, int offset, int n)
+		{
+			n = clamp_n(offset, n);
+			if (n > 0)
+			{
+				dr_type_traits<T>::set_v(dr.xpdr, const_cast<T*>(in), offset, n);
+				return n;
+			}
+			return 0;
 		}
 
 		int init()
 		{
 			/*
-				Initializes the dataref inside the sim.
-				Also notifies the dataref editor about the new dataref.
-				If the dataref already exists, just gives a handle to it
+			Initializes the dataref inside the sim.
+			Also notifies the dataref editor about the new dataref.
+			If the dataref already exists, just gives a handle to it
 			*/
 
 			if (array == nullptr)
 			{
 				dr.is_allocated = true;
-				array = new float[n_length];
-				for (int i = 0; i < n_length; i++)
-				{
-					array[i] = 0;
-				}
+				array = new XPDataBus::SeqBuf<T>(size_t(n_length), dr_type_traits<T>::FILL_VAL);
 			}
 
 			if (array == nullptr)
@@ -496,62 +500,20 @@ namespace DRUtil
 			XPLMDataRef test_dr = XPLMFindDataRef(dr.name);
 			if (test_dr == nullptr)
 			{
-				dr.xpdr = XPLMRegisterDataAccessor(dr.name, xplmType_FloatArray, dr.is_writable,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						nullptr, nullptr,
-						[](void* ref, float* out_values, int in_offset, int in_max) {
-							dref_fa* ptr = reinterpret_cast<dref_fa*>(ref);
-							int arr_length = ptr->n_length;
-							if (out_values == nullptr || in_offset >= arr_length)
-							{
-								return arr_length;
-							}
-							int r = arr_length - in_offset;
-							if (r > in_max)
-							{
-								r = in_max;
-							}
-							for (int i = 0; i < r; i++)
-							{
-								out_values[i] = ptr->array[i + in_offset];
-							}
-							return r;
-						},
-						[](void* ref, float* in_values, int in_offset, int in_max) {
-							if (in_values != nullptr)
-							{
-								dref_fa* ptr = reinterpret_cast<dref_fa*>(ref);
-								int arr_length = ptr->n_length;
-								int r = arr_length - in_offset;
-								if (r > in_max)
-									r = in_max;
-								for (int i = 0; i < r; i++)
-								{
-									ptr->array[i + in_offset] = in_values[i];
-								}
-							}
-						},
-						nullptr, nullptr,
-						this, this);
-				dr.xpdr = XPLMFindDataRef(dr.name);
-				XPLMSetDatavf(dr.xpdr, array, 0, n_length);
+				dr.xpdr = dr_type_traits<T>::reg_v(dr.name, dr.is_writable, get_cb, set_cb, 
+					this);
+				n_dr_length = n_length;
 				dr.regInDRE();
 			}
 			else
 			{
 				//Set variable to dataref's value if dataref already exists
 				dr.xpdr = test_dr;
-				int n_dr_length = XPLMGetDatavf(dr.xpdr, nullptr, 0, 0);
-				int n_val_get = n_length;
-				if (n_dr_length < n_val_get)
-				{
-					n_val_get = n_dr_length;
-				}
-				XPLMGetDatavf(dr.xpdr, array, 0, n_val_get);
+				n_dr_length = dr_type_traits<T>::get_v(dr.xpdr, nullptr, 0, 0);
+				std::vector<T> tmp(size_t(n_length), dr_type_traits<T>::FILL_VAL);
+				int n_val_get = get_range(tmp.data(), 0, n_length);
+				array->write(tmp.data(), 0, size_t(n_val_get));
 			}
-			
 			if (dr.xpdr == nullptr)
 			{
 				return 0;
@@ -565,138 +527,101 @@ namespace DRUtil
 			dr.unReg();
 			if (dr.is_allocated)
 			{
-				delete[] array;
+				delete array;
 				array = nullptr;
 			}
 		}
-	};
-
-	struct dref_s
-	{
-		/*
-		String array dataref structure.
-		*/
-		dref dr;
-		char* str;
-		int n_length;
-
-		//TODO: add get() and set()
 
-		int init()
+	private:
+		// Returns the number of elements of [offset, offset+n) that are in the dataref
+		int clamp_n(int offset, int n)
 		{
-			/*
-			Initializes the dataref inside the sim.
-			Also notifies the dataref editor about the new dataref.
-			*/
-
-			if (str == nullptr)
+			if (dr.xpdr == nullptr || offset < 0 || offset >= n_dr_length || n <= 0)
 			{
-				dr.is_allocated = true;
-				str = new char[n_length];
-				for (int i = 0; i < n_length; i++)
-				{
-					str[i] = DEFAULT_STR_FILL_CHAR;
-				}
-			}
-
-			if (str == nullptr)
-			{
-				// If we've failed to allocate memory for the dataref,
-				// return.
 				return 0;
 			}
-
-			XPLMDataRef test_dr = XPLMFindDataRef(dr.name);
-			if (test_dr == nullptr)
+			if (n > n_dr_length - offset)
 			{
-				dr.xpdr = XPLMRegisterDataAccessor(dr.name, xplmType_Data, dr.is_writable,
-					nullptr, nullptr,
-					nullptr, nullptr,
-					nullptr, nullptr,
-					nullptr, nullptr,
-					nullptr, nullptr,
-					[](void* ref, void* out_values, int in_offset, int in_max) {
-						//This stuff is really janky
-						dref_s* ptr = reinterpret_cast<dref_s*>(ref);
-						char* out_ptr = reinterpret_cast<char*>(out_values);
-						int str_length = ptr->n_length;
-						if (out_values == nullptr || in_offset >= str_length)
-						{
-							return str_length;
-						}
-						int r = str_length - in_offset;
-						if (r > in_max)
-						{
-							r = in_max;
-						}
-						for (int i = 0; i < r; i++)
-						{
-							out_ptr[i] = ptr->str[i + in_offset];
-						}
-						return str_length;
-					},
-					[](void* ref, void* in_values, int in_offset, int in_max) {
-						//This is janky as well
-						if (in_values != nullptr)
-						{
-							dref_s* ptr = reinterpret_cast<dref_s*>(ref);
-							char* in_ptr = reinterpret_cast<char*>(in_values);
-							int str_length = ptr->n_length;
-							int r = str_length - in_offset;
-							if (r > in_max)
-								r = in_max;
-							for (int i = 0; i < r; i++)
-							{
-								ptr->str[i + in_offset] = in_ptr[i];
-							}
-						}
-					},
-						this, this);
-				dr.xpdr = XPLMFindDataRef(dr.name);
-				XPLMSetDatab(dr.xpdr, str, 0, n_length);
-				dr.regInDRE();
+				return n_dr_length - offset;
 			}
-			else
+			return n;
+		}
+
+		/*
+			Called by the sim for datarefs owned by this plugin. Strings are
+			copied through array one character at a time instead of with memcpy:
+			its elements are std::atomic<T>, so that other threads can read them
+			while the sim writes, and memcpy can't be used on atomics. Relaxed
+			loads and stores of single characters compile to plain moves, so a
+			24 character line costs a few ns more than memcpy (see dref_bench).
+			get_str and set_str copy with memcpy on the caller's side.
+		*/
+
+		static int get_cb(void* ref, buf_t* out_values, int in_offset, int in_max)
+		{
+			dref* ptr = reinterpret_cast<dref*>(ref);
+			int arr_length = ptr->n_length;
+			if (out_values == nullptr || in_offset >= arr_length)
 			{
-				dr.xpdr = test_dr;
+				return arr_length;
 			}
-			
-			if (dr.xpdr == nullptr)
+			int r = arr_length - in_offset;
+			if (r > in_max)
 			{
-				return 0;
+				r = in_max;
 			}
-			
-			return 1;
+			ptr->array->read(reinterpret_cast<T*>(out_values), size_t(in_offset), size_t(r));
+			return r;
 		}
 
-		void unReg()
+		static void set_cb(void* ref, buf_t* in_values, int in_offset, int in_max)
 		{
-			dr.unReg();
-			if (dr.is_allocated)
-			{
-				delete[] str;
-				str = nullptr;
+			if (in_values != nullptr)
+			{
+				dref* ptr = reinterpret_cast<dref*>(ref);
+				int arr_length = ptr->n_length;
+				int r = arr_length - in_offset;
+				if (r > in_max)
+					r = in_max;
+				if (r > 0)
+				{
+					ptr->array->write(reinterpret_cast<T*>(in_values), size_t(in_offset), 
+						size_t(r));
+				}
 			}
 		}
 	};
 
-	float regDRInDRE(float elapsedMe, float elapsedSim, int counter, void* ref)
+
+	typedef dref<int, DR_SCALAR> dref_i;
+	typedef dref<float, DR_SCALAR> dref_f;
+	typedef dref<double, DR_SCALAR> dref_d;
+	typedef dref<int, DR_ARRAY> dref_ia;
+	typedef dref<float, DR_ARRAY> dref_fa;
+	typedef dref<char, DR_ARRAY> dref_s;
+
+
+	/*
+		Copies the value of a string dataref to out with one call to the sim.
+		Trailing fill characters aren't removed.
+	*/
+
+	inline void get_str(dref_s* dr, std::string* out)
 	{
-		/*
-		* Do NOT use this function in any of your own code. This function is intended
-		* to be used only within this library.
-		*/
+		out->resize(size_t(std::max(dr->n_dr_length, 0)));
+		int n_read = dr->get_range(&(*out)[0], 0, int(out->size()));
+		out->resize(size_t(std::max(n_read, 0)));
+	}
 
-		(void)elapsedMe;
-		(void)elapsedSim;
-		(void)counter;
+	/*
+		Writes in to a string dataref with one call to the sim. The rest
+		of the dataref is filled with DEFAULT_STR_FILL_CHAR.
+	*/
 
-		XPLMPluginID PluginID = XPLMFindPluginBySignature("xplanesdk.examples.DataRefEditor");
-		if (PluginID != XPLM_NO_PLUGIN_ID)
-		{
-			dref* ptr = reinterpret_cast<dref*>(ref);
-			XPLMSendMessageToPlugin(PluginID, MSG_ADD_DATAREF, (void*)ptr->name);
-		}
-		return 0;
+	inline void set_str(dref_s* dr, const std::string& in)
+	{
+		std::vector<char> tmp(size_t(std::max(dr->n_dr_length, 0)), DEFAULT_STR_FILL_CHAR);
+		std::memcpy(tmp.data(), in.data(), std::min(in.size(), tmp.size()));
+		dr->set_range(tmp.data(), 0, int(tmp.size()));
 	}
 };
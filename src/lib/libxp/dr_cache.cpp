@@ -11,67 +11,303 @@
 
 
 #include "dr_cache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 
 namespace XPDataBus
 {
 	DataRefCache::DataRefCache()
 	{
-		cache = {};
+		for (size_t i = 0; i < N_DR_CACHE_CHUNKS; i++)
+		{
+			chunks[i].store(nullptr, std::memory_order_relaxed);
+		}
 	}
 
-	generic_val DataRefCache::get_val(std::string dr_name)
+	generic_val DataRefCache::get_val(dr_handle_t dr)
 	{
-		std::lock_guard<std::mutex> lock(dr_cache_mutex);
 		generic_val tmp = { {0}, "", xplmType_Unknown, 0 };
-		if (cache.find(dr_name) != cache.end())
+		dr_cache_entry* entry = get_entry(dr);
+		if (entry == nullptr)
+		{
+			return tmp;
+		}
+
+		uint64_t raw = 0;
+		char str[DR_CACHE_STR_CAP];
+		size_t str_len = read_entry(entry, &tmp.val_type, &raw, str);
+		std::memcpy(&tmp.double_val, &raw, sizeof(raw));
+		if (str_len > DR_CACHE_STR_CAP)
+		{
+			std::lock_guard<std::mutex> lock(long_str_mutex);
+			tmp.str = long_strs[dr];
+		}
+		else
 		{
-			tmp = cache.at(dr_name);
+			tmp.str.assign(str, str_len);
 		}
 		return tmp;
 	}
 
-	int DataRefCache::get_val_i(std::string dr_name)
+	int DataRefCache::get_val_i(dr_handle_t dr)
 	{
-		generic_val tmp = get_val(dr_name);
-		
-		if (tmp.val_type == xplmType_Int)
-		{
-			return tmp.int_val;
-		}
-		return 0;
+		generic_val tmp = { {0}, "", xplmType_Unknown, 0 };
+		read_num(dr, &tmp);
+		return get_gen_val_i(&tmp);
+	}
+
+	float DataRefCache::get_val_f(dr_handle_t dr)
+	{
+		generic_val tmp = { {0}, "", xplmType_Unknown, 0 };
+		read_num(dr, &tmp);
+		return get_gen_val_f(&tmp);
 	}
 
-	std::string DataRefCache::get_val_s(std::string dr_name)
+	double DataRefCache::get_val_d(dr_handle_t dr)
 	{
-		generic_val tmp = get_val(dr_name);
-		return tmp.str;
+		generic_val tmp = { {0}, "", xplmType_Unknown, 0 };
+		read_num(dr, &tmp);
+		return get_gen_val_d(&tmp);
 	}
 
-	void DataRefCache::set_val(std::string dr_name, generic_val val)
+	std::string DataRefCache::get_val_s(dr_handle_t dr)
 	{
-		std::lock_guard<std::mutex> lock(dr_cache_mutex);
-		if (cache.find(dr_name) != cache.end())
+		dr_cache_entry* entry = get_entry(dr);
+		if (entry == nullptr)
 		{
-			cache[dr_name] = val;
+			return "";
 		}
-		else
+		int val_type = 0;
+		uint64_t raw = 0;
+		char str[DR_CACHE_STR_CAP];
+		size_t str_len = read_entry(entry, &val_type, &raw, str);
+		if (str_len > DR_CACHE_STR_CAP)
+		{
+			std::lock_guard<std::mutex> lock(long_str_mutex);
+			return long_strs[dr];
+		}
+		return std::string(str, str_len);
+	}
+
+	bool DataRefCache::is_equal_s(dr_handle_t dr, const std::string& in)
+	{
+		dr_cache_entry* entry = get_entry(dr);
+		if (entry == nullptr)
+		{
+			return in.length() == 0;
+		}
+		int val_type = 0;
+		uint64_t raw = 0;
+		char str[DR_CACHE_STR_CAP];
+		size_t str_len = read_entry(entry, &val_type, &raw, str);
+		if (str_len != in.length())
 		{
-			std::pair<std::string, generic_val> tmp = std::make_pair(dr_name, val);
-			cache.insert(tmp);
+			return false;
 		}
+		if (str_len > DR_CACHE_STR_CAP)
+		{
+			std::lock_guard<std::mutex> lock(long_str_mutex);
+			return long_strs[dr] == in;
+		}
+		return std::memcmp(str, in.data(), str_len) == 0;
+	}
+
+	void DataRefCache::set_val(dr_handle_t dr, generic_val* val)
+	{
+		uint64_t raw = 0;
+		std::memcpy(&raw, &val->double_val, sizeof(raw));
+		write_entry(dr, val->val_type, raw, val->str.c_str(), val->str.length());
 	}
 
-	void DataRefCache::set_val_i(std::string dr_name, int in)
+	void DataRefCache::set_val_i(dr_handle_t dr, int in)
 	{
 		generic_val v = { {0}, "", xplmType_Int, 0 };
 		v.int_val = in;
-		set_val(dr_name, v);
+		set_val(dr, &v);
+	}
+
+	void DataRefCache::set_val_f(dr_handle_t dr, float in)
+	{
+		generic_val v = { {0}, "", xplmType_Float, 0 };
+		v.float_val = in;
+		set_val(dr, &v);
+	}
+
+	void DataRefCache::set_val_d(dr_handle_t dr, double in)
+	{
+		generic_val v = { {0}, "", xplmType_Double, 0 };
+		v.double_val = in;
+		set_val(dr, &v);
+	}
+
+	void DataRefCache::set_val_s(dr_handle_t dr, const std::string& in)
+	{
+		write_entry(dr, xplmType_Data, 0, in.data(), in.length());
+	}
+
+	bool DataRefCache::update_i(dr_handle_t dr, int in)
+	{
+		if (get_val_i(dr) == in)
+		{
+			return false;
+		}
+		set_val_i(dr, in);
+		return true;
+	}
+
+	bool DataRefCache::update_s(dr_handle_t dr, const std::string& in)
+	{
+		if (is_equal_s(dr, in))
+		{
+			return false;
+		}
+		set_val_s(dr, in);
+		return true;
 	}
 
-	void DataRefCache::set_val_s(std::string dr_name, std::string in)
+	DataRefCache::~DataRefCache()
 	{
-		generic_val v = { {0}, in, xplmType_Data, 0 };
-		set_val(dr_name, v);
+		for (size_t i = 0; i < N_DR_CACHE_CHUNKS; i++)
+		{
+			delete[] chunks[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	dr_cache_entry* DataRefCache::get_entry(dr_handle_t dr)
+	{
+		if (dr < 0 || size_t(dr) >= N_DR_CACHE_CHUNKS * DR_CACHE_CHUNK_SIZE)
+		{
+			return nullptr;
+		}
+		dr_cache_entry* chunk = chunks[size_t(dr) / DR_CACHE_CHUNK_SIZE].load(
+			std::memory_order_acquire);
+		if (chunk == nullptr)
+		{
+			return nullptr;
+		}
+		return &chunk[size_t(dr) % DR_CACHE_CHUNK_SIZE];
+	}
+
+	dr_cache_entry* DataRefCache::get_entry_for_write(dr_handle_t dr)
+	{
+		if (dr < 0 || size_t(dr) >= N_DR_CACHE_CHUNKS * DR_CACHE_CHUNK_SIZE)
+		{
+			return nullptr;
+		}
+		std::atomic<dr_cache_entry*>* chunk_ptr = &chunks[size_t(dr) / DR_CACHE_CHUNK_SIZE];
+		dr_cache_entry* chunk = chunk_ptr->load(std::memory_order_acquire);
+		if (chunk == nullptr)
+		{
+			dr_cache_entry* tmp = new dr_cache_entry[DR_CACHE_CHUNK_SIZE];
+			for (size_t i = 0; i < DR_CACHE_CHUNK_SIZE; i++)
+			{
+				tmp[i].seq.store(0, std::memory_order_relaxed);
+				tmp[i].val_type.store(xplmType_Unknown, std::memory_order_relaxed);
+				tmp[i].raw.store(0, std::memory_order_relaxed);
+				tmp[i].str_len.store(0, std::memory_order_relaxed);
+			}
+			// Another writer may have been first
+			if (chunk_ptr->compare_exchange_strong(chunk, tmp, std::memory_order_acq_rel))
+			{
+				chunk = tmp;
+			}
+			else
+			{
+				delete[] tmp;
+			}
+		}
+		return &chunk[size_t(dr) % DR_CACHE_CHUNK_SIZE];
+	}
+
+	uint64_t DataRefCache::lock_entry(dr_cache_entry* entry)
+	{
+		while (true)
+		{
+			uint64_t seq = entry->seq.load(std::memory_order_relaxed);
+			if (!(seq & 1) && entry->seq.compare_exchange_weak(seq, seq + 1,
+				std::memory_order_acquire))
+			{
+				std::atomic_thread_fence(std::memory_order_release);
+				return seq + 1;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	void DataRefCache::unlock_entry(dr_cache_entry* entry, uint64_t seq)
+	{
+		entry->seq.store(seq + 1, std::memory_order_release);
+	}
+
+	void DataRefCache::read_num(dr_handle_t dr, generic_val* out)
+	{
+		dr_cache_entry* entry = get_entry(dr);
+		if (entry == nullptr)
+		{
+			return;
+		}
+		uint64_t raw = 0;
+		char str[DR_CACHE_STR_CAP];
+		read_entry(entry, &out->val_type, &raw, str);
+		std::memcpy(&out->double_val, &raw, sizeof(raw));
+	}
+
+	size_t DataRefCache::read_entry(dr_cache_entry* entry, int* val_type, uint64_t* raw,
+		char* str)
+	{
+		while (true)
+		{
+			uint64_t seq_start = entry->seq.load(std::memory_order_acquire);
+			if (seq_start & 1)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			*val_type = entry->val_type.load(std::memory_order_relaxed);
+			*raw = entry->raw.load(std::memory_order_relaxed);
+			size_t str_len = entry->str_len.load(std::memory_order_relaxed);
+			size_t n_inline = std::min(str_len, DR_CACHE_STR_CAP);
+			for (size_t i = 0; i < n_inline; i++)
+			{
+				str[i] = entry->str[i].load(std::memory_order_relaxed);
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (entry->seq.load(std::memory_order_relaxed) == seq_start)
+			{
+				return str_len;
+			}
+		}
+	}
+
+	void DataRefCache::write_entry(dr_handle_t dr, int val_type, uint64_t raw,
+		const char* str, size_t str_len)
+	{
+		dr_cache_entry* entry = get_entry_for_write(dr);
+		if (entry == nullptr)
+		{
+			return;
+		}
+
+		uint64_t seq = lock_entry(entry);
+		entry->val_type.store(val_type, std::memory_order_relaxed);
+		entry->raw.store(raw, std::memory_order_relaxed);
+		entry->str_len.store(str_len, std::memory_order_relaxed);
+		if (str_len > DR_CACHE_STR_CAP)
+		{
+			std::lock_guard<std::mutex> lock(long_str_mutex);
+			long_strs[dr].assign(str, str_len);
+		}
+		else
+		{
+			for (size_t i = 0; i < str_len; i++)
+			{
+				entry->str[i].store(str[i], std::memory_order_relaxed);
+			}
+		}
+		unlock_entry(entry, seq);
 	}
 }
@@ -4,7 +4,12 @@
 
 	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
 
-	This header file provides declarations of member functions of DataRefCache class
+	This header file provides declarations of member functions of DataRefCache class.
+	Entries are indexed by data bus handles, which are already interned names,
+	so a lookup is an array access. Every entry is guarded by its own sequence
+	lock: readers never block and retry if a write overlaps them, writers of
+	different entries don't contend. Entries are allocated in chunks the first
+	time one of them is written and are never freed before the cache is.
 	Author: discord/bruh4096#4512(Tim G.)
 */
 
@@ -12,31 +17,103 @@
 #pragma once
 
 #include "common.hpp"
-#include <unordered_map>
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 
 
 namespace XPDataBus
 {
+	constexpr size_t DR_CACHE_CHUNK_SIZE = 64;
+	constexpr size_t N_DR_CACHE_CHUNKS = 32; // Handles beyond these chunks aren't cached
+	// Longer strings are kept in a map guarded by a mutex
+	constexpr size_t DR_CACHE_STR_CAP = SMALL_STR_CAP;
+
+
+	struct dr_cache_entry
+	{
+		std::atomic<uint64_t> seq; // Odd while a write is in progress
+		std::atomic<int> val_type;
+		std::atomic<uint64_t> raw; // Bits of int_val/float_val/double_val
+		std::atomic<size_t> str_len;
+		std::atomic<char> str[DR_CACHE_STR_CAP];
+	};
+
+
 	class DataRefCache
 	{
 	public:
 		DataRefCache();
 
-		generic_val get_val(std::string dr_name);
+		DataRefCache(const DataRefCache&) = delete;
+
+		DataRefCache& operator=(const DataRefCache&) = delete;
+
+		// Returns a value with val_type of xplmType_Unknown if dr hasn't been cached
+		generic_val get_val(dr_handle_t dr);
+
+		/*
+			The following getters convert numbers the way get_gen_val_* do.
+			They return 0 if dr hasn't been cached.
+		*/
+
+		int get_val_i(dr_handle_t dr);
+
+		float get_val_f(dr_handle_t dr);
+
+		double get_val_d(dr_handle_t dr);
+
+		std::string get_val_s(dr_handle_t dr);
 
-		int get_val_i(std::string dr_name);
+		// Compares without copying the cached string
+		bool is_equal_s(dr_handle_t dr, const std::string& in);
 
-		std::string get_val_s(std::string dr_name);
+		void set_val(dr_handle_t dr, generic_val* val);
 
-		void set_val(std::string dr_name, generic_val val);
+		void set_val_i(dr_handle_t dr, int in);
 
-		void set_val_i(std::string dr_name, int in);
+		void set_val_f(dr_handle_t dr, float in);
+
+		void set_val_d(dr_handle_t dr, double in);
+
+		void set_val_s(dr_handle_t dr, const std::string& in);
+
+		/*
+			Store the value if it differs from the cached one.
+			Return true if it did.
+		*/
+
+		bool update_i(dr_handle_t dr, int in);
+
+		bool update_s(dr_handle_t dr, const std::string& in);
+
+		~DataRefCache();
 
-		void set_val_s(std::string dr_name, std::string in);
 	private:
-		std::unordered_map<std::string, generic_val> cache;
+		std::atomic<dr_cache_entry*> chunks[N_DR_CACHE_CHUNKS];
+
+		std::unordered_map<dr_handle_t, std::string> long_strs;
+		std::mutex long_str_mutex;
+
+
+		// Returns nullptr if dr is out of range or its chunk hasn't been allocated
+		dr_cache_entry* get_entry(dr_handle_t dr);
+
+		// Allocates the chunk of dr if needed
+		dr_cache_entry* get_entry_for_write(dr_handle_t dr);
+
+		uint64_t lock_entry(dr_cache_entry* entry);
+
+		void unlock_entry(dr_cache_entry* entry, uint64_t seq);
+
+		// Reads the type and numeric value. out is left as it is if dr hasn't been cached.
+		void read_num(dr_handle_t dr, generic_val* out);
+
+		// Reads everything but long strings. Returns the length of the string.
+		size_t read_entry(dr_cache_entry* entry, int* val_type, uint64_t* raw,
+			char* str);
 
-		std::mutex dr_cache_mutex;
+		void write_entry(dr_handle_t dr, int val_type, uint64_t raw, const char* str,
+			size_t str_len);
 	};
 }
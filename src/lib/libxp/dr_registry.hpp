@@ -0,0 +1,355 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file provides a registry of custom datarefs that is generated
+	from a constexpr table of declarations. Every dataref is declared once
+	with its type, length and access mode. The number of datarefs of each
+	type and the storage slot of every declaration are computed at compile time,
+	so the registry keeps its datarefs in fixed size arrays. Declarations are
+	checked at compile time as well, so a duplicate name or an unsupported type
+	fails to compile.
+	Datarefs are accessed through their declarations:
+		reg.get<&AP_ON>() returns the storage of AP_ON,
+		reg.get_hdl<&AP_ON>() returns its data bus handle.
+	The index of the declaration is found at compile time, so neither of them
+	looks anything up by name at run time. Handles of all datarefs are
+	resolved in one pass by bind() once the data bus has been created.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "dataref_structs.hpp"
+#include "databus.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+
+namespace DRUtil
+{
+	struct dr_decl
+	{
+		const char* name;
+		// xplmType_Int, xplmType_Float, xplmType_Double, xplmType_IntArray, xplmType_FloatArray or xplmType_Data
+		XPLMDataTypeID type;
+		bool is_writable;
+		int n_length; // Number of elements of arrays and strings. 1 for everything else.
+		double init_val; // Initial value of scalars
+	};
+
+
+	constexpr bool is_str_equal(const char* a, const char* b)
+	{
+		while (*a != '\0' && *a == *b)
+		{
+			a++;
+			b++;
+		}
+		return *a == *b;
+	}
+
+	// Returns the index of the dataref called name in decls or n if there is none
+	constexpr size_t find_decl(const dr_decl* decls, size_t n, const char* name)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			if (is_str_equal(decls[i].name, name))
+			{
+				return i;
+			}
+		}
+		return n;
+	}
+
+	// Returns the number of datarefs of the given type among the first n declarations
+	constexpr size_t count_decls(const dr_decl* decls, size_t n, XPLMDataTypeID type)
+	{
+		size_t out = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			if (decls[i].type == type)
+			{
+				out++;
+			}
+		}
+		return out;
+	}
+
+	// Returns the index of every declaration among the declarations of its type
+	template <size_t N>
+	constexpr std::array<size_t, N> get_decl_slots(const dr_decl* decls)
+	{
+		std::array<size_t, N> out{};
+		for (size_t i = 0; i < N; i++)
+		{
+			out[i] = count_decls(decls, i, decls[i].type);
+		}
+		return out;
+	}
+
+	// Returns indices of the M declarations of the given type
+	template <size_t M>
+	constexpr std::array<size_t, M> get_decl_idxs(const dr_decl* decls, size_t n, 
+		XPLMDataTypeID type)
+	{
+		std::array<size_t, M> out{};
+		size_t j = 0;
+		for (size_t i = 0; i < n && j < M; i++)
+		{
+			if (decls[i].type == type)
+			{
+				out[j++] = i;
+			}
+		}
+		return out;
+	}
+
+	// Returns true if no dataref is declared twice and all of the types are supported
+	constexpr bool are_decls_valid(const dr_decl* decls, size_t n)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			XPLMDataTypeID tp = decls[i].type;
+			if (tp != xplmType_Int && tp != xplmType_Float && tp != xplmType_Double &&
+				tp != xplmType_IntArray && tp != xplmType_FloatArray && tp != xplmType_Data)
+			{
+				return false;
+			}
+			if (decls[i].n_length < 1 || find_decl(decls, i, decls[i].name) != i)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/*
+		D has to be a constexpr array of N declarations. Storage of every
+		dataref lives in the registry, so it mustn't be moved once reg()
+		has been called.
+	*/
+
+	template <const dr_decl* D, size_t N>
+	class DRRegistry
+	{
+	public:
+		static_assert(are_decls_valid(D, N), "Invalid or duplicate dataref declaration");
+
+		static constexpr size_t N_INT = count_decls(D, N, xplmType_Int);
+		static constexpr size_t N_FLOAT = count_decls(D, N, xplmType_Float);
+		static constexpr size_t N_DOUBLE = count_decls(D, N, xplmType_Double);
+		static constexpr size_t N_INT_ARR = count_decls(D, N, xplmType_IntArray);
+		static constexpr size_t N_FLOAT_ARR = count_decls(D, N, xplmType_FloatArray);
+		static constexpr size_t N_STR = count_decls(D, N, xplmType_Data);
+		// Index of every dataref in the storage array of its type
+		static constexpr std::array<size_t, N> SLOTS = get_decl_slots<N>(D);
+
+
+		DRRegistry()
+		{
+			init_arr(&ints, &INT_IDXS);
+			init_arr(&floats, &FLOAT_IDXS);
+			init_arr(&doubles, &DOUBLE_IDXS);
+			init_arr(&int_arrs, &INT_ARR_IDXS);
+			init_arr(&float_arrs, &FLOAT_ARR_IDXS);
+			init_arr(&strs, &STR_IDXS);
+			for (size_t i = 0; i < N; i++)
+			{
+				hdls[i] = -1;
+			}
+		}
+
+		DRRegistry(const DRRegistry&) = delete;
+
+		DRRegistry& operator=(const DRRegistry&) = delete;
+
+		// Ran from main thread only:
+
+		/*
+			Creates all of the datarefs and appends them to out, so that
+			the data bus can access them directly. Returns 0 on failure.
+		*/
+
+		int reg(std::vector<XPDataBus::custom_data_ref_entry>* out)
+		{
+			out->reserve(out->size() + N);
+			return reg_arr(&ints, &INT_IDXS, out) && reg_arr(&floats, &FLOAT_IDXS, out) &&
+				reg_arr(&doubles, &DOUBLE_IDXS, out) && reg_arr(&int_arrs, &INT_ARR_IDXS, out) &&
+				reg_arr(&float_arrs, &FLOAT_ARR_IDXS, out) && reg_arr(&strs, &STR_IDXS, out);
+		}
+
+		void unreg()
+		{
+			unreg_arr(&ints);
+			unreg_arr(&floats);
+			unreg_arr(&doubles);
+			unreg_arr(&int_arrs);
+			unreg_arr(&float_arrs);
+			unreg_arr(&strs);
+		}
+
+		/*
+			Gets data bus handles of all datarefs. Ran once, right after the data
+			bus has been created, so that systems which register the same datarefs
+			later get the handles that already exist.
+		*/
+
+		void bind(XPDataBus::DataBus* db)
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				hdls[i] = db->reg_data_ref(D[i].name);
+			}
+		}
+
+		// Ran from any thread:
+
+		template <const dr_decl* P>
+		XPDataBus::dr_handle_t get_hdl()
+		{
+			return hdls[get_idx<P>()];
+		}
+
+		/*
+			Returns the storage of a dataref: dref_i, dref_f, dref_d, dref_ia,
+			dref_fa or dref_s depending on its declared type.
+		*/
+
+		template <const dr_decl* P>
+		auto& get()
+		{
+			constexpr size_t idx = get_idx<P>();
+			constexpr XPLMDataTypeID tp = D[idx].type;
+			constexpr size_t slot = SLOTS[idx];
+			if constexpr (tp == xplmType_Int)
+			{
+				return ints[slot];
+			}
+			else if constexpr (tp == xplmType_Float)
+			{
+				return floats[slot];
+			}
+			else if constexpr (tp == xplmType_Double)
+			{
+				return doubles[slot];
+			}
+			else if constexpr (tp == xplmType_IntArray)
+			{
+				return int_arrs[slot];
+			}
+			else if constexpr (tp == xplmType_FloatArray)
+			{
+				return float_arrs[slot];
+			}
+			else
+			{
+				return strs[slot];
+			}
+		}
+
+	private:
+		// Declarations of the datarefs in each storage array
+		static constexpr std::array<size_t, N_INT> INT_IDXS = 
+			get_decl_idxs<N_INT>(D, N, xplmType_Int);
+		static constexpr std::array<size_t, N_FLOAT> FLOAT_IDXS = 
+			get_decl_idxs<N_FLOAT>(D, N, xplmType_Float);
+		static constexpr std::array<size_t, N_DOUBLE> DOUBLE_IDXS = 
+			get_decl_idxs<N_DOUBLE>(D, N, xplmType_Double);
+		static constexpr std::array<size_t, N_INT_ARR> INT_ARR_IDXS = 
+			get_decl_idxs<N_INT_ARR>(D, N, xplmType_IntArray);
+		static constexpr std::array<size_t, N_FLOAT_ARR> FLOAT_ARR_IDXS = 
+			get_decl_idxs<N_FLOAT_ARR>(D, N, xplmType_FloatArray);
+		static constexpr std::array<size_t, N_STR> STR_IDXS = 
+			get_decl_idxs<N_STR>(D, N, xplmType_Data);
+
+		std::array<dref_i, N_INT> ints;
+		std::array<dref_f, N_FLOAT> floats;
+		std::array<dref_d, N_DOUBLE> doubles;
+		std::array<dref_ia, N_INT_ARR> int_arrs;
+		std::array<dref_fa, N_FLOAT_ARR> float_arrs;
+		std::array<dref_s, N_STR> strs;
+		XPDataBus::dr_handle_t hdls[N];
+
+
+		template <const dr_decl* P>
+		static constexpr size_t get_idx()
+		{
+			constexpr size_t idx = find_decl(D, N, P->name);
+			static_assert(idx < N, "Dataref isn't declared");
+			return idx;
+		}
+
+
+		static dref_base get_dref(const dr_decl* decl)
+		{
+			return { decl->name, decl->is_writable, false, nullptr };
+		}
+
+		template <class T>
+		static void init_dr(dref<T, DR_SCALAR>* out, const dr_decl* decl)
+		{
+			*out = dref<T, DR_SCALAR>(get_dref(decl), T(decl->init_val));
+		}
+
+		template <class T>
+		static void init_dr(dref<T, DR_ARRAY>* out, const dr_decl* decl)
+		{
+			*out = dref<T, DR_ARRAY>(get_dref(decl), nullptr, decl->n_length);
+		}
+
+		// Pointers to the values that the data bus reads directly:
+
+		template <class T>
+		static void* get_val_ptr(dref<T, DR_SCALAR>* dr)
+		{
+			return (void*)&dr->val;
+		}
+
+		template <class T>
+		static void* get_val_ptr(dref<T, DR_ARRAY>* dr)
+		{
+			return (void*)dr->array;
+		}
+
+		template <class S, size_t M>
+		static void init_arr(std::array<S, M>* arr, const std::array<size_t, M>* idxs)
+		{
+			for (size_t i = 0; i < M; i++)
+			{
+				init_dr(&arr->at(i), &D[idxs->at(i)]);
+			}
+		}
+
+		template <class S, size_t M>
+		static int reg_arr(std::array<S, M>* arr, const std::array<size_t, M>* idxs, 
+			std::vector<XPDataBus::custom_data_ref_entry>* out)
+		{
+			for (size_t i = 0; i < M; i++)
+			{
+				S* curr = &arr->at(i);
+				if (!curr->init())
+				{
+					return 0;
+				}
+				const dr_decl* decl = &D[idxs->at(i)];
+				out->push_back({ decl->name, { get_val_ptr(curr), decl->type, decl->n_length } });
+			}
+			return 1;
+		}
+
+		template <class S, size_t M>
+		static void unreg_arr(std::array<S, M>* arr)
+		{
+			for (size_t i = 0; i < M; i++)
+			{
+				arr->at(i).unReg();
+			}
+		}
+	};
+}
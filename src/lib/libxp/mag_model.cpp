@@ -0,0 +1,309 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file contains definitions of member functions of MagModel class.
+	The evaluation follows the algorithm of the WMM technical report: geodetic
+	coordinates are converted to spherical ones, the field is summed up in
+	spherical coordinates and then rotated back.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "mag_model.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+
+namespace XPDataBus
+{
+	constexpr double MAG_MODEL_DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+	constexpr int MAG_MODEL_LINE_BUF_SIZE = 256;
+
+
+	MagModel::MagModel()
+	{
+		loaded.store(false, std::memory_order_relaxed);
+		epoch = 0;
+		n_max = 0;
+		std::memset(g, 0, sizeof(g));
+		std::memset(h, 0, sizeof(h));
+		std::memset(dg, 0, sizeof(dg));
+		std::memset(dh, 0, sizeof(dh));
+		std::memset(k, 0, sizeof(k));
+	}
+
+	bool MagModel::load(std::string path, double year)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "r");
+		if (file == nullptr)
+		{
+			return false;
+		}
+
+		char line[MAG_MODEL_LINE_BUF_SIZE];
+		char model_name[MAG_MODEL_LINE_BUF_SIZE];
+		if (std::fgets(line, MAG_MODEL_LINE_BUF_SIZE, file) == nullptr ||
+			std::sscanf(line, "%lf %255s", &epoch, model_name) != 2)
+		{
+			epoch = 0;
+			std::fclose(file);
+			return false;
+		}
+		name = model_name;
+		if (year - epoch > MAG_MODEL_MAX_AGE_YEARS)
+		{
+			std::fclose(file);
+			return false;
+		}
+
+		n_max = 0;
+		while (std::fgets(line, MAG_MODEL_LINE_BUF_SIZE, file) != nullptr)
+		{
+			int n, m;
+			double g_nm, h_nm, dg_nm, dh_nm;
+			// The file ends with a line of 9s
+			if (std::sscanf(line, "%d %d %lf %lf %lf %lf", &n, &m, &g_nm, &h_nm,
+				&dg_nm, &dh_nm) != 6)
+			{
+				break;
+			}
+			if (n < 1 || n > MAG_MODEL_MAX_DEG || m < 0 || m > n)
+			{
+				continue;
+			}
+			g[n][m] = g_nm;
+			h[n][m] = h_nm;
+			dg[n][m] = dg_nm;
+			dh[n][m] = dh_nm;
+			n_max = std::max(n_max, n);
+		}
+		std::fclose(file);
+		if (n_max == 0)
+		{
+			return false;
+		}
+
+		/*
+		* The recurrences below produce Gauss normalized Legendre functions,
+		* so the Schmidt normalization is moved into the coefficients.
+		*/
+		double snorm[N_DEG][N_DEG];
+		snorm[0][0] = 1;
+		for (int n = 1; n <= n_max; n++)
+		{
+			snorm[n][0] = snorm[n - 1][0] * double(2 * n - 1) / double(n);
+			for (int m = 1; m <= n; m++)
+			{
+				double j = m == 1 ? 2 : 1;
+				snorm[n][m] = snorm[n][m - 1] * std::sqrt(double(n - m + 1) * j / double(n + m));
+			}
+			for (int m = 0; m <= n; m++)
+			{
+				g[n][m] *= snorm[n][m];
+				h[n][m] *= snorm[n][m];
+				dg[n][m] *= snorm[n][m];
+				dh[n][m] *= snorm[n][m];
+				if (n > 1)
+				{
+					k[n][m] = double((n - 1) * (n - 1) - m * m) /
+						double((2 * n - 1) * (2 * n - 3));
+				}
+			}
+		}
+
+		loaded.store(true, std::memory_order_release);
+		return true;
+	}
+
+	bool MagModel::is_loaded()
+	{
+		return loaded.load(std::memory_order_acquire);
+	}
+
+	std::string MagModel::get_name()
+	{
+		return name;
+	}
+
+	double MagModel::get_epoch()
+	{
+		return epoch;
+	}
+
+	float MagModel::get_mag_var(double lat, double lon, double alt_km, double year)
+	{
+		if (!is_loaded())
+		{
+			return 0;
+		}
+		geo_point point = { lat, lon };
+		float out = 0;
+		eval_block<1>(&point, &out, 1, alt_km, year - epoch);
+		return out;
+	}
+
+	void MagModel::get_mag_var_batch(const geo_point* points, float* out, size_t n,
+		double alt_km, double year)
+	{
+		if (!is_loaded())
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				out[i] = 0;
+			}
+			return;
+		}
+
+		for (size_t i = 0; i < n; i += MAG_MODEL_BLOCK_SIZE)
+		{
+			size_t n_block = std::min(n - i, size_t(MAG_MODEL_BLOCK_SIZE));
+			eval_block<MAG_MODEL_BLOCK_SIZE>(points + i, out + i, n_block, alt_km, year - epoch);
+		}
+	}
+
+	template <int B>
+	void MagModel::eval_block(const geo_point* points, float* out, size_t n, double alt_km,
+		double dt)
+	{
+		constexpr double A2 = MAG_MODEL_WGS84_A_KM * MAG_MODEL_WGS84_A_KM;
+		constexpr double B2 = MAG_MODEL_WGS84_B_KM * MAG_MODEL_WGS84_B_KM;
+		constexpr double C2 = A2 - B2;
+		constexpr double A4 = A2 * A2;
+		constexpr double C4 = A4 - B2 * B2;
+
+		// Cosine/sine of colatitude, rotation from spherical to geodetic
+		double ct[B], st[B], ca[B], sa[B];
+		// Sines and cosines of multiples of longitude
+		double sp[N_DEG][B], cp[N_DEG][B];
+		double aor[B], ar[B];
+
+		/*
+		* Unused lanes repeat the last point, so that every loop below can
+		* run over the whole block.
+		*/
+		for (int l = 0; l < B; l++)
+		{
+			const geo_point* curr = &points[std::min(size_t(l), n - 1)];
+			double lat = std::max(-MAG_MODEL_POLE_LAT_DEG,
+				std::min(curr->lat, MAG_MODEL_POLE_LAT_DEG)) * MAG_MODEL_DEG_TO_RAD;
+			double lon = curr->lon * MAG_MODEL_DEG_TO_RAD;
+			double srlat = std::sin(lat);
+			double crlat = std::cos(lat);
+			double srlat2 = srlat * srlat;
+			double crlat2 = crlat * crlat;
+
+			double q = std::sqrt(A2 - C2 * srlat2);
+			double q1 = alt_km * q;
+			double q2 = ((q1 + A2) / (q1 + B2)) * ((q1 + A2) / (q1 + B2));
+			ct[l] = srlat / std::sqrt(q2 * crlat2 + srlat2);
+			st[l] = std::sqrt(1 - ct[l] * ct[l]);
+			double r = std::sqrt(alt_km * alt_km + 2 * q1 + (A4 - C4 * srlat2) / (q * q));
+			double d = std::sqrt(A2 * crlat2 + B2 * srlat2);
+			ca[l] = (alt_km + d) / r;
+			sa[l] = C2 * crlat * srlat / (r * d);
+
+			aor[l] = MAG_MODEL_RE_KM / r;
+			ar[l] = aor[l] * aor[l];
+			sp[0][l] = 0;
+			cp[0][l] = 1;
+			sp[1][l] = std::sin(lon);
+			cp[1][l] = std::cos(lon);
+		}
+		for (int m = 2; m <= n_max; m++)
+		{
+			for (int l = 0; l < B; l++)
+			{
+				sp[m][l] = sp[1][l] * cp[m - 1][l] + cp[1][l] * sp[m - 1][l];
+				cp[m][l] = cp[1][l] * cp[m - 1][l] - sp[1][l] * sp[m - 1][l];
+			}
+		}
+
+		// Associated Legendre functions and their derivatives by colatitude
+		double p[N_DEG][N_DEG][B];
+		double dp[N_DEG][N_DEG][B];
+		double bt[B], bp[B], br[B];
+		for (int l = 0; l < B; l++)
+		{
+			p[0][0][l] = 1;
+			dp[0][0][l] = 0;
+			bt[l] = 0;
+			bp[l] = 0;
+			br[l] = 0;
+		}
+
+		for (int i = 1; i <= n_max; i++)
+		{
+			for (int l = 0; l < B; l++)
+			{
+				ar[l] *= aor[l];
+			}
+			for (int m = 0; m <= i; m++)
+			{
+				if (i == m)
+				{
+					for (int l = 0; l < B; l++)
+					{
+						p[i][m][l] = st[l] * p[i - 1][m - 1][l];
+						dp[i][m][l] = st[l] * dp[i - 1][m - 1][l] + ct[l] * p[i - 1][m - 1][l];
+					}
+				}
+				else if (m > i - 2)
+				{
+					// P(i-2, m) is 0 here
+					for (int l = 0; l < B; l++)
+					{
+						p[i][m][l] = ct[l] * p[i - 1][m][l];
+						dp[i][m][l] = ct[l] * dp[i - 1][m][l] - st[l] * p[i - 1][m][l];
+					}
+				}
+				else
+				{
+					double k_im = k[i][m];
+					for (int l = 0; l < B; l++)
+					{
+						p[i][m][l] = ct[l] * p[i - 1][m][l] - k_im * p[i - 2][m][l];
+						dp[i][m][l] = ct[l] * dp[i - 1][m][l] - st[l] * p[i - 1][m][l] -
+							k_im * dp[i - 2][m][l];
+					}
+				}
+
+				double g_t = g[i][m] + dt * dg[i][m];
+				double h_t = h[i][m] + dt * dh[i][m];
+				double fm = double(m);
+				double fn = double(i + 1);
+				for (int l = 0; l < B; l++)
+				{
+					double par = ar[l] * p[i][m][l];
+					double temp1 = g_t * cp[m][l] + h_t * sp[m][l];
+					double temp2 = g_t * sp[m][l] - h_t * cp[m][l];
+					bt[l] -= ar[l] * temp1 * dp[i][m][l];
+					bp[l] += fm * temp2 * par;
+					br[l] += fn * temp1 * par;
+				}
+			}
+		}
+
+		for (size_t l = 0; l < n; l++)
+		{
+			double bx = -bt[l] * ca[l] - br[l] * sa[l];
+			double by = bp[l] / st[l];
+			out[l] = float(std::atan2(by, bx) / MAG_MODEL_DEG_TO_RAD);
+		}
+	}
+
+	double get_decimal_year()
+	{
+		std::time_t t_now = std::time(nullptr);
+		std::tm* t_utc = std::gmtime(&t_now);
+		int year = t_utc->tm_year + 1900;
+		bool is_leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		double n_days = is_leap ? 366 : 365;
+		return double(year) + double(t_utc->tm_yday) / n_days;
+	}
+}
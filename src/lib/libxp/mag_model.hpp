@@ -0,0 +1,112 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file provides declarations of member functions of MagModel class.
+	MagModel evaluates the World Magnetic Model, so that worker threads can compute
+	magnetic variation without asking X-plane for it. Coefficients are loaded from
+	a WMM.COF file as published by NOAA. Associated Legendre functions are computed
+	with recurrences whose factors are precomputed when the model is loaded.
+	Points are evaluated in blocks of MAG_MODEL_BLOCK_SIZE. Every step of the
+	evaluation loops over the points of a block, so the compiler can vectorize it.
+
+	Magnetic variation differs from XPLMGetMagneticVariation by less than
+	MAG_MODEL_TOLERANCE_DEG below MAG_MODEL_MAX_LAT_DEG of latitude,
+	as long as the model is current, which load() enforces. src/bench/mag_bench checks this
+	against values recorded in a data bus traffic log and against the test
+	values published by NOAA with the model.
+	The data bus evaluates the model for the date of the system clock at the
+	time WMM.COF is loaded, not for the date set in the sim. If the user
+	moves the sim date by years, variation won't follow it.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "common.hpp"
+#include <atomic>
+#include <string>
+
+
+namespace XPDataBus
+{
+	constexpr int MAG_MODEL_MAX_DEG = 12; // Higher degrees in the file are ignored
+	constexpr int MAG_MODEL_BLOCK_SIZE = 8;
+	constexpr double MAG_MODEL_TOLERANCE_DEG = 0.5;
+	constexpr double MAG_MODEL_MAX_LAT_DEG = 80;
+	// A new model is published every 5 years. Older ones drift too far from X-plane.
+	constexpr double MAG_MODEL_MAX_AGE_YEARS = 5;
+	// Points closer to the poles than this are moved away from them
+	constexpr double MAG_MODEL_POLE_LAT_DEG = 89.9999;
+
+	// WGS84 ellipsoid and the reference radius of the model in km
+	constexpr double MAG_MODEL_WGS84_A_KM = 6378.137;
+	constexpr double MAG_MODEL_WGS84_B_KM = 6356.7523142;
+	constexpr double MAG_MODEL_RE_KM = 6371.2;
+
+
+	class MagModel
+	{
+	public:
+		MagModel();
+
+		// Ran from main thread only:
+
+		/*
+			Reads coefficients in the format of WMM.COF. Returns false if the
+			file couldn't be read or year is more than MAG_MODEL_MAX_AGE_YEARS
+			past the epoch of the model. The name and epoch of such a model
+			are still set, so that the caller can report them.
+		*/
+
+		bool load(std::string path, double year);
+
+		// Ran from any thread:
+
+		bool is_loaded();
+
+		std::string get_name();
+
+		double get_epoch();
+
+		/*
+			Returns magnetic variation in degrees, positive east. alt_km is
+			height above the WGS84 ellipsoid, year is a decimal year.
+		*/
+
+		float get_mag_var(double lat, double lon, double alt_km, double year);
+
+		void get_mag_var_batch(const geo_point* points, float* out, size_t n,
+			double alt_km, double year);
+
+	private:
+		static constexpr int N_DEG = MAG_MODEL_MAX_DEG + 1;
+
+		std::atomic<bool> loaded;
+		std::string name;
+		double epoch;
+		int n_max;
+
+		// Coefficients converted from Schmidt semi-normalized to Gauss normalized
+		double g[N_DEG][N_DEG], h[N_DEG][N_DEG];
+		double dg[N_DEG][N_DEG], dh[N_DEG][N_DEG]; // Change per year
+		// Factors of the recurrence of associated Legendre functions
+		double k[N_DEG][N_DEG];
+
+
+		/*
+			Evaluates up to B points. Single points use a block of 1,
+			so they don't pay for the unused lanes.
+		*/
+
+		template <int B>
+		void eval_block(const geo_point* points, float* out, size_t n, double alt_km,
+			double dt);
+	};
+
+	// Returns the current UTC date of the system clock as a decimal year. This isn't the sim date.
+	double get_decimal_year();
+}
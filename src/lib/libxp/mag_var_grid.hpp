@@ -0,0 +1,159 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains a cache of magnetic variation on a regular
+	lat/lon grid. Magnetic variation changes slowly, so a value between the
+	nodes is interpolated bilinearly from the 4 nodes around it. Nodes are
+	filled in by the main thread as they are requested and are never evicted.
+	Any thread can read the grid without locking. Close to the poles variation
+	changes too quickly to be interpolated, so these points aren't cached.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+
+namespace XPDataBus
+{
+	constexpr double MAG_VAR_GRID_STEP_DEG = 1;
+	constexpr double MAG_VAR_GRID_MAX_LAT_DEG = 80;
+	constexpr int N_MAG_VAR_GRID_ROWS = int(180 / MAG_VAR_GRID_STEP_DEG) + 1;
+	constexpr int N_MAG_VAR_GRID_COLS = int(360 / MAG_VAR_GRID_STEP_DEG);
+	constexpr int N_MAG_VAR_CELL_NODES = 4;
+
+
+	/*
+		Nodes around a point and their weights. Nodes are ordered
+		south-west, south-east, north-west, north-east.
+	*/
+
+	struct mag_var_cell
+	{
+		int nodes[N_MAG_VAR_CELL_NODES];
+		double weights[N_MAG_VAR_CELL_NODES];
+	};
+
+
+	class MagVarGrid
+	{
+	public:
+		MagVarGrid()
+		{
+			vals = new std::atomic<float>[N_NODES];
+			clear();
+		}
+
+		MagVarGrid(const MagVarGrid&) = delete;
+
+		MagVarGrid& operator=(const MagVarGrid&) = delete;
+
+		// Ran from any thread:
+
+		/*
+			Finds the nodes around a point.
+			Returns false if the point is too close to a pole to be cached.
+		*/
+
+		static bool get_cell(double lat, double lon, mag_var_cell* out)
+		{
+			if (!(std::fabs(lat) <= MAG_VAR_GRID_MAX_LAT_DEG) || !std::isfinite(lon))
+			{
+				return false;
+			}
+
+			double lon_norm = std::fmod(lon + 180, 360);
+			if (lon_norm < 0)
+			{
+				lon_norm += 360;
+			}
+			double row_f = (lat + 90) / MAG_VAR_GRID_STEP_DEG;
+			double col_f = lon_norm / MAG_VAR_GRID_STEP_DEG;
+			int row = std::min(int(row_f), N_MAG_VAR_GRID_ROWS - 2);
+			int col = std::min(int(col_f), N_MAG_VAR_GRID_COLS - 1);
+			int col_next = (col + 1) % N_MAG_VAR_GRID_COLS;
+			double t_lat = row_f - double(row);
+			double t_lon = col_f - double(col);
+
+			out->nodes[0] = row * N_MAG_VAR_GRID_COLS + col;
+			out->nodes[1] = row * N_MAG_VAR_GRID_COLS + col_next;
+			out->nodes[2] = (row + 1) * N_MAG_VAR_GRID_COLS + col;
+			out->nodes[3] = (row + 1) * N_MAG_VAR_GRID_COLS + col_next;
+			out->weights[0] = (1 - t_lat) * (1 - t_lon);
+			out->weights[1] = (1 - t_lat) * t_lon;
+			out->weights[2] = t_lat * (1 - t_lon);
+			out->weights[3] = t_lat * t_lon;
+			return true;
+		}
+
+		static double get_node_lat(int node)
+		{
+			return double(node / N_MAG_VAR_GRID_COLS) * MAG_VAR_GRID_STEP_DEG - 90;
+		}
+
+		static double get_node_lon(int node)
+		{
+			return double(node % N_MAG_VAR_GRID_COLS) * MAG_VAR_GRID_STEP_DEG - 180;
+		}
+
+		bool has_node(int node)
+		{
+			return !std::isnan(vals[node].load(std::memory_order_acquire));
+		}
+
+		/*
+			Interpolates magnetic variation inside a cell.
+			Returns false if any of its nodes hasn't been filled in yet.
+		*/
+
+		bool interpolate(mag_var_cell* cell, float* out)
+		{
+			double sum = 0;
+			for (int i = 0; i < N_MAG_VAR_CELL_NODES; i++)
+			{
+				float node_val = vals[cell->nodes[i]].load(std::memory_order_acquire);
+				if (std::isnan(node_val))
+				{
+					return false;
+				}
+				sum += cell->weights[i] * double(node_val);
+			}
+			*out = float(sum);
+			return true;
+		}
+
+		// Ran from main thread only:
+
+		void set_node(int node, float val)
+		{
+			vals[node].store(val, std::memory_order_release);
+		}
+
+		void clear()
+		{
+			for (int i = 0; i < N_NODES; i++)
+			{
+				vals[i].store(std::numeric_limits<float>::quiet_NaN(), std::memory_order_relaxed);
+			}
+		}
+
+		~MagVarGrid()
+		{
+			delete[] vals;
+		}
+
+	private:
+		static constexpr int N_NODES = N_MAG_VAR_GRID_ROWS * N_MAG_VAR_GRID_COLS;
+
+		std::atomic<float>* vals; // NaN until the node is filled in
+	};
+}
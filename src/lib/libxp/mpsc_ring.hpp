@@ -0,0 +1,208 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains a bounded lock-free multi-producer/single-consumer
+	ring buffer. It is used for the request queues of the data bus: any thread
+	can push a request, only the main thread pops them.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+
+namespace XPDataBus
+{
+	constexpr size_t RING_CACHE_LINE_SIZE = 64;
+
+
+	/*
+		Counts the time that producers spend waiting for a full ring.
+		Shared by MPSCRing and SPSCRing.
+	*/
+
+	struct ring_wait_counter
+	{
+		std::atomic<uint64_t> n_waits;
+		std::atomic<uint64_t> wait_ns;
+
+		ring_wait_counter()
+		{
+			n_waits.store(0, std::memory_order_relaxed);
+			wait_ns.store(0, std::memory_order_relaxed);
+		}
+
+		template <class R, class T>
+		void push(R* ring, T& val)
+		{
+			if (ring->try_push(val))
+			{
+				return;
+			}
+			auto t_start = std::chrono::steady_clock::now();
+			while (!ring->try_push(val))
+			{
+				std::this_thread::yield();
+			}
+			uint64_t t_ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - t_start).count());
+			n_waits.fetch_add(1, std::memory_order_relaxed);
+			wait_ns.fetch_add(t_ns, std::memory_order_relaxed);
+		}
+	};
+
+
+	template <class T>
+	class MPSCRing
+	{
+	public:
+		/*
+			Capacity gets rounded up to the next power of 2.
+			All of the slots are allocated up front.
+		*/
+
+		MPSCRing(size_t cap)
+		{
+			size_t n_slots = 2;
+			while (n_slots < cap)
+			{
+				n_slots <<= 1;
+			}
+			mask = n_slots - 1;
+			slots = new ring_slot[n_slots];
+			for (size_t i = 0; i < n_slots; i++)
+			{
+				slots[i].seq.store(i, std::memory_order_relaxed);
+			}
+			tail.store(0, std::memory_order_relaxed);
+			head = 0;
+		}
+
+		MPSCRing(const MPSCRing&) = delete;
+
+		MPSCRing& operator=(const MPSCRing&) = delete;
+
+		size_t capacity()
+		{
+			return mask + 1;
+		}
+
+		// Ran from any thread:
+
+		/*
+			Returns false if the ring is full. val is only moved from on success.
+		*/
+
+		bool try_push(T& val)
+		{
+			size_t pos = tail.load(std::memory_order_relaxed);
+			ring_slot* slot;
+			while (true)
+			{
+				slot = &slots[pos & mask];
+				size_t seq = slot->seq.load(std::memory_order_acquire);
+				intptr_t diff = intptr_t(seq) - intptr_t(pos);
+				if (diff == 0)
+				{
+					if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = tail.load(std::memory_order_relaxed);
+				}
+			}
+			slot->val = std::move(val);
+			slot->seq.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/*
+			Blocks until there is a free slot. The consumer only pops as many
+			requests per frame as its time budget allows, so a burst can keep
+			the ring full for several frames. The wait isn't bounded, because
+			a dropped request would leave its sender waiting forever. Instead, 
+			the time spent waiting is counted, see get_full_wait_ns.
+		*/
+
+		void push(T val)
+		{
+			full_wait.push(this, val);
+		}
+
+		// Number of pushes that found the ring full
+		uint64_t get_n_full_waits()
+		{
+			return full_wait.n_waits.load(std::memory_order_relaxed);
+		}
+
+		// Total time that pushes have waited for a free slot
+		uint64_t get_full_wait_ns()
+		{
+			return full_wait.wait_ns.load(std::memory_order_relaxed);
+		}
+
+		// Ran from consumer thread only:
+
+		/*
+			Returns false if there is nothing to pop. A slot that has been
+			claimed by a producer but not yet written counts as empty.
+		*/
+
+		bool pop(T* out)
+		{
+			ring_slot* slot = &slots[head & mask];
+			size_t seq = slot->seq.load(std::memory_order_acquire);
+			if (seq != head + 1)
+			{
+				return false;
+			}
+			*out = std::move(slot->val);
+			slot->seq.store(head + mask + 1, std::memory_order_release);
+			head++;
+			return true;
+		}
+
+		// Includes slots that have been claimed but not yet written
+		size_t size()
+		{
+			return tail.load(std::memory_order_relaxed) - head;
+		}
+
+		~MPSCRing()
+		{
+			delete[] slots;
+		}
+
+	private:
+		struct alignas(RING_CACHE_LINE_SIZE) ring_slot
+		{
+			std::atomic<size_t> seq;
+			T val;
+		};
+
+		ring_slot* slots;
+		size_t mask;
+
+		// Producers and the consumer work on separate cache lines
+		alignas(RING_CACHE_LINE_SIZE) std::atomic<size_t> tail;
+		ring_wait_counter full_wait;
+		alignas(RING_CACHE_LINE_SIZE) size_t head;
+	};
+}
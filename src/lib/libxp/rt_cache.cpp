@@ -0,0 +1,227 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file provides definitions of member functions of ReadThroughCache class,
+	which is declared in rt_cache.hpp
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "rt_cache.hpp"
+#include <algorithm>
+#include <chrono>
+
+
+namespace XPDataBus
+{
+	inline int64_t get_rt_time_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+
+	ReadThroughCache::ReadThroughCache(std::shared_ptr<DataBus> db)
+	{
+		data_bus = db;
+
+		entries = new rt_cache_entry[N_RT_CACHE_ENTRIES];
+		for (size_t i = 0; i < N_RT_CACHE_ENTRIES; i++)
+		{
+			entries[i].max_age_ns.store(0, std::memory_order_relaxed);
+			entries[i].t_refreshed_ns.store(0, std::memory_order_relaxed);
+			entries[i].gen.store(0, std::memory_order_relaxed);
+			entries[i].offset = 0;
+		}
+
+		n_reads.store(0, std::memory_order_relaxed);
+		n_refreshes.store(0, std::memory_order_relaxed);
+		n_drs_refreshed.store(0, std::memory_order_relaxed);
+	}
+
+	bool ReadThroughCache::bind(dr_handle_t dr, double max_age_sec, int offset)
+	{
+		if (dr < 0 || size_t(dr) >= N_RT_CACHE_ENTRIES)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(refresh_mutex);
+		rt_cache_entry* entry = &entries[dr];
+		if (entry->max_age_ns.load(std::memory_order_relaxed) == 0)
+		{
+			bound.push_back(dr);
+		}
+		entry->offset = offset;
+		entry->t_refreshed_ns.store(0, std::memory_order_relaxed);
+		// Bound datarefs are always read at least once
+		entry->max_age_ns.store(std::max(int64_t(max_age_sec * 1e9), int64_t(1)),
+			std::memory_order_release);
+		return true;
+	}
+
+	generic_val ReadThroughCache::get_val(dr_handle_t dr)
+	{
+		if (!read_through(dr))
+		{
+			return data_bus->get_data(dr);
+		}
+		return vals.get_val(dr);
+	}
+
+	int ReadThroughCache::get_val_i(dr_handle_t dr)
+	{
+		if (!read_through(dr))
+		{
+			return data_bus->get_datai(dr);
+		}
+		return vals.get_val_i(dr);
+	}
+
+	float ReadThroughCache::get_val_f(dr_handle_t dr)
+	{
+		if (!read_through(dr))
+		{
+			return data_bus->get_dataf(dr);
+		}
+		return vals.get_val_f(dr);
+	}
+
+	double ReadThroughCache::get_val_d(dr_handle_t dr)
+	{
+		if (!read_through(dr))
+		{
+			return data_bus->get_datad(dr);
+		}
+		return vals.get_val_d(dr);
+	}
+
+	std::string ReadThroughCache::get_val_s(dr_handle_t dr)
+	{
+		if (!read_through(dr))
+		{
+			return data_bus->get_data_s(dr);
+		}
+		return vals.get_val_s(dr);
+	}
+
+	void ReadThroughCache::invalidate(dr_handle_t dr)
+	{
+		rt_cache_entry* entry = get_entry(dr);
+		if (entry != nullptr)
+		{
+			entry->gen.fetch_add(1);
+			entry->t_refreshed_ns.store(0);
+		}
+	}
+
+	void ReadThroughCache::invalidate_all()
+	{
+		std::lock_guard<std::mutex> lock(refresh_mutex);
+		for (size_t i = 0; i < bound.size(); i++)
+		{
+			rt_cache_entry* entry = &entries[bound[i]];
+			entry->gen.fetch_add(1);
+			entry->t_refreshed_ns.store(0);
+		}
+	}
+
+	void ReadThroughCache::refresh()
+	{
+		std::lock_guard<std::mutex> lock(refresh_mutex);
+		/*
+		* Another thread may have refreshed everything while this one was
+		* waiting for the lock, in which case there is nothing left to read.
+		*/
+		int64_t t_now = get_rt_time_ns();
+		refresh_drs.clear();
+		refresh_gens.clear();
+		for (size_t i = 0; i < bound.size(); i++)
+		{
+			rt_cache_entry* entry = &entries[bound[i]];
+			int64_t t_refreshed = entry->t_refreshed_ns.load(std::memory_order_acquire);
+			if (t_refreshed == 0 || t_now - t_refreshed >=
+				entry->max_age_ns.load(std::memory_order_relaxed))
+			{
+				refresh_drs.push_back({ bound[i], entry->offset });
+				refresh_gens.push_back(entry->gen.load());
+			}
+		}
+		if (refresh_drs.size() == 0)
+		{
+			return;
+		}
+
+		data_bus->get_data_batch(&refresh_drs, &refresh_vals);
+		for (size_t i = 0; i < refresh_drs.size(); i++)
+		{
+			dr_handle_t dr = refresh_drs[i].dref;
+			vals.set_val(dr, &refresh_vals[i]);
+			/*
+			* The age is counted from before the read. If the entry was
+			* invalidated while the batch was in flight, the value read
+			* may be older than the change, so the entry stays stale.
+			*/
+			rt_cache_entry* entry = &entries[dr];
+			if (entry->gen.load() == refresh_gens[i])
+			{
+				entry->t_refreshed_ns.store(t_now);
+				if (entry->gen.load() != refresh_gens[i])
+				{
+					entry->t_refreshed_ns.store(0);
+				}
+			}
+		}
+		n_refreshes.fetch_add(1, std::memory_order_relaxed);
+		n_drs_refreshed.fetch_add(refresh_drs.size(), std::memory_order_relaxed);
+	}
+
+	rt_cache_stats ReadThroughCache::get_stats()
+	{
+		rt_cache_stats out;
+		out.n_reads = n_reads.load(std::memory_order_relaxed);
+		out.n_refreshes = n_refreshes.load(std::memory_order_relaxed);
+		out.n_drs_refreshed = n_drs_refreshed.load(std::memory_order_relaxed);
+		return out;
+	}
+
+	ReadThroughCache::~ReadThroughCache()
+	{
+		delete[] entries;
+	}
+
+	rt_cache_entry* ReadThroughCache::get_entry(dr_handle_t dr)
+	{
+		if (dr < 0 || size_t(dr) >= N_RT_CACHE_ENTRIES)
+		{
+			return nullptr;
+		}
+		rt_cache_entry* entry = &entries[dr];
+		if (entry->max_age_ns.load(std::memory_order_acquire) == 0)
+		{
+			return nullptr;
+		}
+		return entry;
+	}
+
+	bool ReadThroughCache::read_through(dr_handle_t dr)
+	{
+		rt_cache_entry* entry = get_entry(dr);
+		if (entry == nullptr)
+		{
+			return false;
+		}
+		n_reads.fetch_add(1, std::memory_order_relaxed);
+
+		int64_t t_refreshed = entry->t_refreshed_ns.load(std::memory_order_acquire);
+		if (t_refreshed == 0 || get_rt_time_ns() - t_refreshed >=
+			entry->max_age_ns.load(std::memory_order_relaxed))
+		{
+			refresh();
+		}
+		return true;
+	}
+}
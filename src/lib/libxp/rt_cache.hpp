@@ -0,0 +1,123 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file provides declarations of member functions of ReadThroughCache class.
+	Every dataref bound to the cache has a maximum age. Reads return the cached
+	value while it's younger than that. The first read of a stale dataref
+	refreshes every stale dataref of the cache with a single get_data_batch,
+	so a dataref is read from the sim at most once per its maximum age no matter
+	how often it's read. Fresh reads don't lock anything.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "databus.hpp"
+#include "dr_cache.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace XPDataBus
+{
+	constexpr size_t N_RT_CACHE_ENTRIES = N_DR_CACHE_CHUNKS * DR_CACHE_CHUNK_SIZE;
+
+
+	struct rt_cache_entry
+	{
+		std::atomic<int64_t> max_age_ns; // 0 if the dataref isn't bound
+		std::atomic<int64_t> t_refreshed_ns; // Steady clock. 0 if the value has to be read.
+		std::atomic<uint64_t> gen; // Incremented by invalidate
+		int offset;
+	};
+
+	struct rt_cache_stats
+	{
+		uint64_t n_reads;
+		uint64_t n_refreshes; // Batches sent to the data bus
+		uint64_t n_drs_refreshed;
+	};
+
+
+	class ReadThroughCache
+	{
+	public:
+		ReadThroughCache(std::shared_ptr<DataBus> db);
+
+		ReadThroughCache(const ReadThroughCache&) = delete;
+
+		ReadThroughCache& operator=(const ReadThroughCache&) = delete;
+
+		// Ran from any thread:
+
+		/*
+			Binds dr to the cache. Only one element of an array can be bound,
+			since entries are indexed by dataref. Returns false if dr is out
+			of range of the cache.
+		*/
+
+		bool bind(dr_handle_t dr, double max_age_sec, int offset=0);
+
+		/*
+			Reads of datarefs that aren't bound go straight to the data bus.
+			A read may block for a frame if the dataref is stale.
+		*/
+
+		generic_val get_val(dr_handle_t dr);
+
+		int get_val_i(dr_handle_t dr);
+
+		float get_val_f(dr_handle_t dr);
+
+		double get_val_d(dr_handle_t dr);
+
+		std::string get_val_s(dr_handle_t dr);
+
+		/*
+			Makes the next read of dr refresh it. Should be called after the
+			caller has written to dr or has been told that it has changed.
+		*/
+
+		void invalidate(dr_handle_t dr);
+
+		void invalidate_all();
+
+		// Refreshes every stale dataref right away
+		void refresh();
+
+		rt_cache_stats get_stats();
+
+		~ReadThroughCache();
+
+	private:
+		std::shared_ptr<DataBus> data_bus;
+		DataRefCache vals;
+		rt_cache_entry* entries;
+
+		std::mutex refresh_mutex; // Guards everything below
+		std::vector<dr_handle_t> bound;
+		std::vector<batch_entry> refresh_drs;
+		std::vector<uint64_t> refresh_gens;
+		std::vector<generic_val> refresh_vals;
+
+		std::atomic<uint64_t> n_reads;
+		std::atomic<uint64_t> n_refreshes;
+		std::atomic<uint64_t> n_drs_refreshed;
+
+
+		// Returns nullptr if dr isn't bound
+		rt_cache_entry* get_entry(dr_handle_t dr);
+
+		/*
+			Refreshes the cache if dr is stale. Returns false if dr isn't bound.
+		*/
+
+		bool read_through(dr_handle_t dr);
+	};
+}
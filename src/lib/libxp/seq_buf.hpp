@@ -0,0 +1,163 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains a fixed size buffer guarded by a sequence lock.
+	It backs array and string datarefs owned by this plugin, so that any thread
+	can access them without going through the main thread. Single elements
+	are atomic on their own. Reads of several elements are retried if a write
+	overlaps them, so they never see half of a write. Writers are serialized.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+
+namespace XPDataBus
+{
+	template <class T>
+	class SeqBuf
+	{
+	public:
+		SeqBuf(size_t n, T fill_val)
+		{
+			n_vals = n;
+			vals = new std::atomic<T>[n];
+			for (size_t i = 0; i < n; i++)
+			{
+				vals[i].store(fill_val, std::memory_order_relaxed);
+			}
+			seq.store(0, std::memory_order_relaxed);
+			write_lock.clear();
+		}
+
+		SeqBuf(const SeqBuf&) = delete;
+
+		SeqBuf& operator=(const SeqBuf&) = delete;
+
+		size_t size()
+		{
+			return n_vals;
+		}
+
+		// Returns T() if idx is out of bounds
+		T get(size_t idx)
+		{
+			if (idx < n_vals)
+			{
+				return vals[idx].load(std::memory_order_relaxed);
+			}
+			return T();
+		}
+
+		/*
+			Copies up to n elements starting at offset to out.
+			Returns the number of elements copied.
+		*/
+
+		size_t read(T* out, size_t offset, size_t n)
+		{
+			n = clamp_n(offset, n);
+			while (true)
+			{
+				uint64_t seq_start = seq.load(std::memory_order_acquire);
+				if (seq_start & 1)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				for (size_t i = 0; i < n; i++)
+				{
+					out[i] = vals[offset + i].load(std::memory_order_relaxed);
+				}
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (seq.load(std::memory_order_relaxed) == seq_start)
+				{
+					return n;
+				}
+			}
+		}
+
+		void set(size_t idx, T val)
+		{
+			write(&val, idx, 1);
+		}
+
+		/*
+			Copies up to n elements from in, starting at offset.
+			Returns the number of elements copied.
+		*/
+
+		size_t write(const T* in, size_t offset, size_t n)
+		{
+			n = clamp_n(offset, n);
+			lock();
+			for (size_t i = 0; i < n; i++)
+			{
+				vals[offset + i].store(in[i], std::memory_order_relaxed);
+			}
+			unlock();
+			return n;
+		}
+
+		void fill(T val)
+		{
+			lock();
+			for (size_t i = 0; i < n_vals; i++)
+			{
+				vals[i].store(val, std::memory_order_relaxed);
+			}
+			unlock();
+		}
+
+		~SeqBuf()
+		{
+			delete[] vals;
+		}
+
+	private:
+		std::atomic<T>* vals;
+		size_t n_vals;
+		std::atomic<uint64_t> seq; // Odd while a write is in progress
+		std::atomic_flag write_lock;
+
+		size_t clamp_n(size_t offset, size_t n)
+		{
+			if (offset >= n_vals)
+			{
+				return 0;
+			}
+			if (n > n_vals - offset)
+			{
+				return n_vals - offset;
+			}
+			return n;
+		}
+
+		void lock()
+		{
+			while (write_lock.test_and_set(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+			seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		void unlock()
+		{
+			seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			write_lock.clear(std::memory_order_release);
+		}
+	};
+}
@@ -0,0 +1,216 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains a string with a fixed-size inline buffer.
+	Strings that fit into the buffer never touch the heap, longer strings
+	are moved to a heap buffer. It is used to store string values of datarefs.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+
+namespace XPDataBus
+{
+	// Longest string that is stored inline. Covers FMC screen lines and navaid ids.
+	constexpr size_t SMALL_STR_CAP = 31;
+
+
+	class SmallStr
+	{
+	public:
+		SmallStr()
+		{
+			init();
+		}
+
+		SmallStr(const char* s)
+		{
+			init();
+			assign(s, strlen(s));
+		}
+
+		SmallStr(const std::string& s)
+		{
+			init();
+			assign(s.data(), s.length());
+		}
+
+		SmallStr(const SmallStr& other)
+		{
+			init();
+			assign(other.c_str(), other.len);
+		}
+
+		SmallStr(SmallStr&& other) noexcept
+		{
+			init();
+			steal(&other);
+		}
+
+		SmallStr& operator=(const SmallStr& other)
+		{
+			if (this != &other)
+			{
+				assign(other.c_str(), other.len);
+			}
+			return *this;
+		}
+
+		SmallStr& operator=(SmallStr&& other) noexcept
+		{
+			if (this != &other)
+			{
+				delete[] heap;
+				init();
+				steal(&other);
+			}
+			return *this;
+		}
+
+		size_t length() const
+		{
+			return len;
+		}
+
+		bool empty() const
+		{
+			return len == 0;
+		}
+
+		// True if the string doesn't use any heap memory
+		bool is_inline() const
+		{
+			return heap == nullptr;
+		}
+
+		const char* c_str() const
+		{
+			return heap != nullptr ? heap : buf;
+		}
+
+		char at(size_t i) const
+		{
+			if (i >= len)
+			{
+				throw std::out_of_range("SmallStr::at");
+			}
+			return c_str()[i];
+		}
+
+		std::string to_string() const
+		{
+			return std::string(c_str(), len);
+		}
+
+		void assign(const char* s, size_t n)
+		{
+			char* dst = prepare(n);
+			memmove(dst, s, n);
+			set_length(n);
+		}
+
+		void push_back(char c)
+		{
+			if (len + 1 > cap)
+			{
+				// Grow geometrically so that pushing characters one by one stays cheap
+				reserve(2 * cap + 1);
+			}
+			get_buf()[len] = c;
+			set_length(len + 1);
+		}
+
+		void clear()
+		{
+			set_length(0);
+		}
+
+		/*
+			Makes room for n characters and returns a pointer to the buffer.
+			The previous contents are kept. Call set_length once the buffer
+			has been written to.
+		*/
+
+		char* prepare(size_t n)
+		{
+			if (n > cap)
+			{
+				reserve(n);
+			}
+			return get_buf();
+		}
+
+		void set_length(size_t n)
+		{
+			len = n;
+			get_buf()[len] = 0;
+		}
+
+		bool operator==(const char* s) const
+		{
+			return strlen(s) == len && memcmp(c_str(), s, len) == 0;
+		}
+
+		bool operator==(const std::string& s) const
+		{
+			return s.length() == len && memcmp(c_str(), s.data(), len) == 0;
+		}
+
+		~SmallStr()
+		{
+			delete[] heap;
+		}
+
+	private:
+		char buf[SMALL_STR_CAP + 1];
+		char* heap;
+		size_t cap; // Number of characters that fit into the current buffer
+		size_t len;
+
+		void init()
+		{
+			buf[0] = 0;
+			heap = nullptr;
+			cap = SMALL_STR_CAP;
+			len = 0;
+		}
+
+		char* get_buf()
+		{
+			return heap != nullptr ? heap : buf;
+		}
+
+		void reserve(size_t n)
+		{
+			char* tmp = new char[n + 1];
+			memcpy(tmp, get_buf(), len + 1);
+			delete[] heap;
+			heap = tmp;
+			cap = n;
+		}
+
+		void steal(SmallStr* other)
+		{
+			if (other->heap != nullptr)
+			{
+				heap = other->heap;
+				cap = other->cap;
+				len = other->len;
+				other->init();
+			}
+			else
+			{
+				assign(other->buf, other->len);
+			}
+		}
+	};
+}
@@ -0,0 +1,134 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file contains a bounded lock-free single-producer/single-consumer
+	ring buffer. It has the same interface as MPSCRing, but the producer never
+	competes with other threads for a slot: each side only writes its own index
+	and keeps a cached copy of the other one.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "mpsc_ring.hpp"
+
+
+namespace XPDataBus
+{
+	template <class T>
+	class SPSCRing
+	{
+	public:
+		/*
+			Capacity gets rounded up to the next power of 2.
+			All of the slots are allocated up front.
+		*/
+
+		SPSCRing(size_t cap)
+		{
+			size_t n_slots = 2;
+			while (n_slots < cap)
+			{
+				n_slots <<= 1;
+			}
+			mask = n_slots - 1;
+			slots = new T[n_slots];
+			tail.store(0, std::memory_order_relaxed);
+			head.store(0, std::memory_order_relaxed);
+			head_cache = 0;
+			tail_cache = 0;
+		}
+
+		SPSCRing(const SPSCRing&) = delete;
+
+		SPSCRing& operator=(const SPSCRing&) = delete;
+
+		size_t capacity()
+		{
+			return mask + 1;
+		}
+
+		// Ran from producer thread only:
+
+		/*
+			Returns false if the ring is full. val is only moved from on success.
+		*/
+
+		bool try_push(T& val)
+		{
+			size_t pos = tail.load(std::memory_order_relaxed);
+			if (pos - head_cache > mask)
+			{
+				head_cache = head.load(std::memory_order_acquire);
+				if (pos - head_cache > mask)
+				{
+					return false;
+				}
+			}
+			slots[pos & mask] = std::move(val);
+			tail.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Blocks until there is a free slot, see MPSCRing::push
+		void push(T val)
+		{
+			full_wait.push(this, val);
+		}
+
+		uint64_t get_n_full_waits()
+		{
+			return full_wait.n_waits.load(std::memory_order_relaxed);
+		}
+
+		uint64_t get_full_wait_ns()
+		{
+			return full_wait.wait_ns.load(std::memory_order_relaxed);
+		}
+
+		// Ran from consumer thread only:
+
+		bool pop(T* out)
+		{
+			size_t pos = head.load(std::memory_order_relaxed);
+			if (pos == tail_cache)
+			{
+				tail_cache = tail.load(std::memory_order_acquire);
+				if (pos == tail_cache)
+				{
+					return false;
+				}
+			}
+			*out = std::move(slots[pos & mask]);
+			head.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		size_t size()
+		{
+			return tail.load(std::memory_order_acquire) - head.load(std::memory_order_relaxed);
+		}
+
+		~SPSCRing()
+		{
+			delete[] slots;
+		}
+
+	private:
+		T* slots;
+		size_t mask;
+
+		// Written by the producer
+		alignas(RING_CACHE_LINE_SIZE) std::atomic<size_t> tail;
+		size_t head_cache;
+		ring_wait_counter full_wait;
+
+		// Written by the consumer
+		alignas(RING_CACHE_LINE_SIZE) std::atomic<size_t> head;
+		size_t tail_cache;
+	};
+}
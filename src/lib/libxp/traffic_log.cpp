@@ -0,0 +1,439 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This source file provides definitions of member functions of TrafficRecorder
+	and TrafficReader classes, which are declared in traffic_log.hpp
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#include "traffic_log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+
+namespace XPDataBus
+{
+	inline int64_t get_rec_time_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	inline void put_uvarint(std::vector<uint8_t>* buf, uint64_t val)
+	{
+		while (val >= 0x80)
+		{
+			buf->push_back(uint8_t(val | 0x80));
+			val >>= 7;
+		}
+		buf->push_back(uint8_t(val));
+	}
+
+	inline void put_svarint(std::vector<uint8_t>* buf, int64_t val)
+	{
+		put_uvarint(buf, (uint64_t(val) << 1) ^ uint64_t(val >> 63));
+	}
+
+	inline void put_bytes(std::vector<uint8_t>* buf, const void* src, size_t n)
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+		buf->insert(buf->end(), bytes, bytes + n);
+	}
+
+	inline void put_str(std::vector<uint8_t>* buf, SmallStr* str)
+	{
+		put_uvarint(buf, str->length());
+		put_bytes(buf, str->c_str(), str->length());
+	}
+
+	// TrafficRecorder definitions:
+	// Public member functions:
+
+	TrafficRecorder::TrafficRecorder()
+	{
+		queue = nullptr;
+		on.store(false, std::memory_order_relaxed);
+		n_dropped.store(0, std::memory_order_relaxed);
+		t_start_ns.store(0, std::memory_order_relaxed);
+		writer = nullptr;
+		file = nullptr;
+		t_prev_ns = 0;
+	}
+
+	bool TrafficRecorder::start(std::string path)
+	{
+		if (on.load(std::memory_order_relaxed))
+		{
+			return true;
+		}
+
+		file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			return false;
+		}
+		std::fwrite(TRAFFIC_LOG_MAGIC, 1, TRAFFIC_LOG_MAGIC_LENGTH, file);
+
+		if (queue == nullptr)
+		{
+			queue = new MPSCRing<traffic_rec>(TRAFFIC_QUEUE_SIZE);
+		}
+		// Records that were made while the previous log was being closed
+		traffic_rec tmp;
+		while (queue->pop(&tmp));
+
+		write_buf.clear();
+		write_buf.reserve(TRAFFIC_WRITE_BUF_SIZE);
+		t_prev_ns = 0;
+		n_dropped.store(0, std::memory_order_relaxed);
+		t_start_ns.store(get_rec_time_ns(), std::memory_order_relaxed);
+		on.store(true, std::memory_order_release);
+		writer = new std::thread([this]() { writer_main(); });
+		return true;
+	}
+
+	void TrafficRecorder::stop()
+	{
+		if (!on.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		on.store(false, std::memory_order_release);
+		writer->join();
+		delete writer;
+		writer = nullptr;
+		std::fclose(file);
+		file = nullptr;
+	}
+
+	bool TrafficRecorder::is_on()
+	{
+		return on.load(std::memory_order_relaxed);
+	}
+
+	void TrafficRecorder::add(traffic_rec* rec)
+	{
+		rec->t_ns = get_rec_time_ns() - t_start_ns.load(std::memory_order_relaxed);
+		if (!queue->try_push(*rec))
+		{
+			n_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	uint64_t TrafficRecorder::get_n_dropped()
+	{
+		return n_dropped.load(std::memory_order_relaxed);
+	}
+
+	TrafficRecorder::~TrafficRecorder()
+	{
+		stop();
+		delete queue;
+	}
+
+	// Private member functions:
+
+	void TrafficRecorder::write_rec(traffic_rec* rec)
+	{
+		/*
+		* Records from different threads can be queued slightly out of order,
+		* so the time delta is signed.
+		*/
+		write_buf.push_back(uint8_t(rec->kind));
+		put_svarint(&write_buf, rec->t_ns - t_prev_ns);
+		put_svarint(&write_buf, rec->channel);
+		t_prev_ns = rec->t_ns;
+
+		if (rec->kind == REC_CHANNEL)
+		{
+			put_str(&write_buf, &rec->val.str);
+			return;
+		}
+		else if (rec->kind == REC_FRAME)
+		{
+			return;
+		}
+		else if (rec->kind == REC_MAG_VAR)
+		{
+			put_bytes(&write_buf, &rec->lat, sizeof(double));
+			put_bytes(&write_buf, &rec->lon, sizeof(double));
+			put_bytes(&write_buf, &rec->val.float_val, sizeof(float));
+			return;
+		}
+
+		put_svarint(&write_buf, rec->dref);
+		if (rec->kind == REC_DR_NAME)
+		{
+			put_uvarint(&write_buf, uint64_t(rec->val.val_type));
+			write_buf.push_back(uint8_t(rec->is_custom));
+			put_uvarint(&write_buf, uint64_t(std::max(rec->n_length, 0)));
+			put_str(&write_buf, &rec->val.str);
+			return;
+		}
+		else if (rec->kind == REC_CMD)
+		{
+			return;
+		}
+
+		// The numeric type goes first, the data flag is in the lowest bit
+		put_svarint(&write_buf, rec->val.offset);
+		int val_type = rec->val.val_type;
+		uint64_t hdr = 0;
+		if (xplmType_Double & val_type)
+		{
+			hdr = xplmType_Double;
+		}
+		else if ((xplmType_Float | xplmType_FloatArray) & val_type)
+		{
+			hdr = xplmType_Float;
+		}
+		else if ((xplmType_Int | xplmType_IntArray) & val_type)
+		{
+			hdr = xplmType_Int;
+		}
+		hdr = (hdr << 1) | uint64_t((xplmType_Data & val_type) != 0);
+		put_uvarint(&write_buf, hdr);
+
+		if ((hdr >> 1) == xplmType_Double)
+		{
+			put_bytes(&write_buf, &rec->val.double_val, sizeof(double));
+		}
+		else if ((hdr >> 1) == xplmType_Float)
+		{
+			put_bytes(&write_buf, &rec->val.float_val, sizeof(float));
+		}
+		else if ((hdr >> 1) == xplmType_Int)
+		{
+			put_svarint(&write_buf, rec->val.int_val);
+		}
+		if (hdr & 1)
+		{
+			put_str(&write_buf, &rec->val.str);
+		}
+	}
+
+	void TrafficRecorder::flush()
+	{
+		if (write_buf.size())
+		{
+			std::fwrite(write_buf.data(), 1, write_buf.size(), file);
+			write_buf.clear();
+		}
+	}
+
+	void TrafficRecorder::writer_main()
+	{
+		while (true)
+		{
+			// Checked before draining, so records queued before stop() still get written
+			bool is_stopping = !on.load(std::memory_order_acquire);
+			size_t n_written = 0;
+			traffic_rec rec;
+			while (queue->pop(&rec))
+			{
+				write_rec(&rec);
+				n_written++;
+				if (write_buf.size() >= TRAFFIC_WRITE_BUF_SIZE)
+				{
+					flush();
+				}
+			}
+			if (is_stopping)
+			{
+				break;
+			}
+			if (n_written == 0)
+			{
+				flush();
+				std::this_thread::sleep_for(std::chrono::milliseconds(TRAFFIC_WRITER_PAUSE_MS));
+			}
+		}
+		flush();
+	}
+
+	// TrafficReader definitions:
+	// Public member functions:
+
+	TrafficReader::TrafficReader(std::string path)
+	{
+		t_prev_ns = 0;
+		file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr)
+		{
+			return;
+		}
+
+		char magic[TRAFFIC_LOG_MAGIC_LENGTH];
+		if (!read_bytes(magic, TRAFFIC_LOG_MAGIC_LENGTH) ||
+			std::memcmp(magic, TRAFFIC_LOG_MAGIC, TRAFFIC_LOG_MAGIC_LENGTH) != 0)
+		{
+			std::fclose(file);
+			file = nullptr;
+		}
+	}
+
+	bool TrafficReader::is_open()
+	{
+		return file != nullptr;
+	}
+
+	bool TrafficReader::next(traffic_rec* out)
+	{
+		if (file == nullptr)
+		{
+			return false;
+		}
+
+		int kind = std::fgetc(file);
+		int64_t dt_ns = 0;
+		int64_t channel = 0;
+		if (kind == EOF || kind > REC_MAG_VAR || !read_svarint(&dt_ns) || !read_svarint(&channel))
+		{
+			return false;
+		}
+		t_prev_ns += dt_ns;
+		out->t_ns = t_prev_ns;
+		out->kind = kind;
+		out->channel = int(channel);
+		out->dref = INVALID_DR_HANDLE;
+		out->val = generic_val{ {0}, "", 0, 0 };
+		out->lat = 0;
+		out->lon = 0;
+		out->is_custom = false;
+		out->n_length = 0;
+
+		uint64_t tmp_u = 0;
+		int64_t tmp_s = 0;
+		if (kind == REC_FRAME)
+		{
+			return true;
+		}
+		else if (kind == REC_CHANNEL)
+		{
+			return read_str(&out->val.str, TRAFFIC_MAX_NAME_LENGTH);
+		}
+		else if (kind == REC_MAG_VAR)
+		{
+			out->val.val_type = xplmType_Float;
+			return read_bytes(&out->lat, sizeof(double)) && read_bytes(&out->lon, sizeof(double)) &&
+				read_bytes(&out->val.float_val, sizeof(float));
+		}
+
+		if (!read_svarint(&tmp_s))
+		{
+			return false;
+		}
+		out->dref = dr_handle_t(tmp_s);
+		if (kind == REC_DR_NAME)
+		{
+			int is_custom = 0;
+			uint64_t n_length = 0;
+			if (!read_uvarint(&tmp_u) || (is_custom = std::fgetc(file)) == EOF ||
+				!read_uvarint(&n_length))
+			{
+				return false;
+			}
+			out->val.val_type = int(tmp_u);
+			out->is_custom = is_custom != 0;
+			out->n_length = int(n_length);
+			return read_str(&out->val.str, TRAFFIC_MAX_NAME_LENGTH);
+		}
+		else if (kind == REC_CMD)
+		{
+			return true;
+		}
+
+		uint64_t hdr = 0;
+		if (!read_svarint(&tmp_s) || !read_uvarint(&hdr))
+		{
+			return false;
+		}
+		out->val.offset = int(tmp_s);
+		int num_type = int(hdr >> 1);
+		out->val.val_type = num_type;
+		bool is_read = true;
+		if (num_type == xplmType_Double)
+		{
+			is_read = read_bytes(&out->val.double_val, sizeof(double));
+		}
+		else if (num_type == xplmType_Float)
+		{
+			is_read = read_bytes(&out->val.float_val, sizeof(float));
+		}
+		else if (num_type == xplmType_Int)
+		{
+			is_read = read_svarint(&tmp_s);
+			out->val.int_val = int(tmp_s);
+		}
+		if (is_read && (hdr & 1))
+		{
+			out->val.val_type |= xplmType_Data;
+			is_read = read_str(&out->val.str, TRAFFIC_MAX_STR_LENGTH);
+		}
+		return is_read;
+	}
+
+	TrafficReader::~TrafficReader()
+	{
+		if (file != nullptr)
+		{
+			std::fclose(file);
+		}
+	}
+
+	// Private member functions:
+
+	bool TrafficReader::read_uvarint(uint64_t* out)
+	{
+		*out = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			int byte = std::fgetc(file);
+			if (byte == EOF)
+			{
+				return false;
+			}
+			*out |= uint64_t(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool TrafficReader::read_svarint(int64_t* out)
+	{
+		uint64_t tmp = 0;
+		if (!read_uvarint(&tmp))
+		{
+			return false;
+		}
+		*out = int64_t(tmp >> 1) ^ -int64_t(tmp & 1);
+		return true;
+	}
+
+	bool TrafficReader::read_bytes(void* out, size_t n)
+	{
+		return n == 0 || std::fread(out, 1, n, file) == n;
+	}
+
+	bool TrafficReader::read_str(SmallStr* out, size_t max_length)
+	{
+		uint64_t length = 0;
+		if (!read_uvarint(&length) || length > max_length)
+		{
+			return false;
+		}
+		std::string tmp(size_t(length), '\0');
+		bool is_read = read_bytes(&tmp[0], tmp.size());
+		*out = tmp;
+		return is_read;
+	}
+}
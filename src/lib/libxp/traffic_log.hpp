@@ -0,0 +1,151 @@
+/*
+	This project is licensed under
+	Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International Public License (CC BY-NC-SA 4.0).
+
+	A SUMMARY OF THIS LICENSE CAN BE FOUND HERE: https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+	This header file provides declarations of member functions of TrafficRecorder
+	and TrafficReader classes. The recorder writes every request served by the
+	data bus to a binary log. Records are queued by the thread that makes them
+	and written to the file by a background thread. Records are dropped rather
+	than waited for if the queue is full. The reader parses the log back, so that
+	recorded flights can be replayed offline.
+
+	Log format: 8 byte magic, then records. Every record starts with its kind (1 byte),
+	time since the previous record in ns and the channel. Integers are LEB128 varints,
+	signed ones are zigzag encoded. Floats and doubles are stored as raw bytes.
+	Author: discord/bruh4096#4512(Tim G.)
+*/
+
+
+#pragma once
+
+#include "common.hpp"
+#include "mpsc_ring.hpp"
+#include <cstdio>
+#include <vector>
+
+
+namespace XPDataBus
+{
+	constexpr char TRAFFIC_LOG_MAGIC[] = "XPDBLOG1";
+	constexpr size_t TRAFFIC_LOG_MAGIC_LENGTH = 8;
+	constexpr size_t TRAFFIC_QUEUE_SIZE = 16384;
+	constexpr size_t TRAFFIC_WRITE_BUF_SIZE = 65536;
+	constexpr int TRAFFIC_WRITER_PAUSE_MS = 5;
+	// Longer strings are treated as corruption by TrafficReader
+	constexpr size_t TRAFFIC_MAX_NAME_LENGTH = 1024; // Dataref and channel names
+	constexpr size_t TRAFFIC_MAX_STR_LENGTH = 2048; // Same as CHAR_BUF_SIZE in databus.hpp
+
+
+	enum traffic_rec_kind
+	{
+		REC_DR_NAME = 0, // Written once per dataref, before any of its values
+		REC_CHANNEL = 1, // Written when a producer channel is registered
+		REC_FRAME = 2, // Start of a data bus flight loop
+		REC_GET = 3,
+		REC_SET = 4,
+		REC_CMD = 5,
+		REC_MAG_VAR = 6
+	};
+
+	struct traffic_rec
+	{
+		int64_t t_ns; // Since the start of the recording
+		int kind;
+		int channel; // Channel of the thread that made the request
+		dr_handle_t dref; // Command handle for REC_CMD
+
+		/*
+			Value that was read or written. Numbers are stored as the widest type
+			they hold, so val_type has at most one numeric bit after reading.
+			REC_DR_NAME and REC_CHANNEL keep the name in val.str, REC_DR_NAME keeps
+			the dataref type in val.val_type. REC_MAG_VAR keeps the result in val.float_val.
+		*/
+
+		generic_val val;
+		double lat, lon; // REC_MAG_VAR only
+		bool is_custom; // REC_DR_NAME only
+		int n_length; // REC_DR_NAME only. Array length in elements or bytes
+	};
+
+
+	class TrafficRecorder
+	{
+	public:
+		TrafficRecorder();
+
+		// Ran from main thread only:
+
+		/*
+			Opens the log at path and starts the writer thread.
+			Returns false if the file couldn't be opened.
+		*/
+
+		bool start(std::string path);
+
+		// Writes everything that is still queued and closes the log
+		void stop();
+
+		// Ran from any thread:
+
+		bool is_on();
+
+		/*
+			Timestamps the record and queues it for writing.
+			rec is moved from.
+		*/
+
+		void add(traffic_rec* rec);
+
+		uint64_t get_n_dropped();
+
+		~TrafficRecorder();
+
+	private:
+		MPSCRing<traffic_rec>* queue;
+		std::atomic<bool> on;
+		std::atomic<uint64_t> n_dropped;
+		std::atomic<int64_t> t_start_ns;
+
+		// Only used by the writer thread
+		std::thread* writer;
+		std::FILE* file;
+		std::vector<uint8_t> write_buf;
+		int64_t t_prev_ns;
+
+
+		void write_rec(traffic_rec* rec);
+
+		void flush();
+
+		void writer_main();
+	};
+
+	class TrafficReader
+	{
+	public:
+		TrafficReader(std::string path);
+
+		// Returns false if the file couldn't be opened or isn't a traffic log
+		bool is_open();
+
+		// Returns false at the end of the log or if the rest of it is corrupt
+		bool next(traffic_rec* out);
+
+		~TrafficReader();
+
+	private:
+		std::FILE* file;
+		int64_t t_prev_ns;
+
+		bool read_uvarint(uint64_t* out);
+
+		bool read_svarint(int64_t* out);
+
+		bool read_bytes(void* out, size_t n);
+
+		// Reads a length-prefixed string. Fails if it's longer than max_length
+		bool read_str(SmallStr* out, size_t max_length);
+	};
+}